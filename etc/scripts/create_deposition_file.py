@@ -6,6 +6,7 @@ import os
 import random
 import numpy as np
 import argparse
+import struct
 
 from array import array
 
@@ -68,6 +69,18 @@ class depositedCharge:
             parent_idArr[0] = self.parent_id
 
 
+    # Required for binary output
+    def getDepositionBinary(self, omit_time, omit_mcparticle):
+
+        time = 0. if omit_time else self.time
+        track_id = 0 if omit_mcparticle else self.track_id
+        parent_id = 0 if omit_mcparticle else self.parent_id
+
+        # All deposits are assigned to the first and only detector name stored in the file
+        return struct.pack("<dddddiiiI", time, self.energy, self.positionx, self.positiony, self.positionz,
+                           self.pdg_code, track_id, parent_id, 0)
+
+
     # Required for CSV output
     def getDepositionText(self, omit_time, omit_mcparticle):
 
@@ -164,7 +177,7 @@ if __name__ == '__main__':
 
     # Check if we have command line control:
     parser = argparse.ArgumentParser()
-    parser.add_argument("--type", help="File type to generate, (a) TTree, (b) CSV, (c) both")
+    parser.add_argument("--type", help="File type to generate, (a) TTree, (b) CSV, (c) both, (d) binary")
     parser.add_argument("--detector", help="Name of the detector")
     parser.add_argument("--outputpath", help="Path to write output files to")
     parser.add_argument("--events", help="Number of events to generate", type=int)
@@ -191,7 +204,12 @@ if __name__ == '__main__':
 
 
     # Ask whether to use TTrees or CSV files
-    if rootAvailable:
+    writeBinary = False
+    if args.type == "d":
+        writeBinary = True
+        writeROOT = False
+        writeCSV = False
+    elif rootAvailable:
         if args.type is None:
             writeOption = user_input("Generate TTrees (a), a CSV file (b) or both (c)? ")
         else:
@@ -221,6 +239,7 @@ if __name__ == '__main__':
 
     rootfilename = filenamePrefix + ".root"
     csvFilename = filenamePrefix + ".csv"
+    binaryFilename = filenamePrefix + ".bin"
 
     # Define detector name
     if args.detector is None:
@@ -267,6 +286,15 @@ if __name__ == '__main__':
     if writeCSV:
         fout = open(csvFilename,'w')
 
+    if writeBinary:
+        # Reserve space for the header, which is written once the location of the event index is known
+        fbin = open(binaryFilename,'wb')
+        fbin.write(b"\0" * struct.calcsize("<8sIIQQ"))
+        detectorBytes = detectorName.encode()
+        fbin.write(struct.pack("<I", len(detectorBytes)))
+        fbin.write(detectorBytes)
+        binaryIndex = []
+
 
     for eventNr in range(0,events):
         print("Processing event " + str(eventNr))
@@ -283,6 +311,10 @@ if __name__ == '__main__':
             text = "\nEvent: " + str(eventNr) + "\n"
             fout.write(text)
 
+        if writeBinary:
+            # Store the location of the deposits of this event in the index
+            binaryIndex.append((eventNr, fbin.tell(), len(deposits)))
+
         for deposit in deposits:
             # Add information to the depositions
             deposit.setEventNr(eventNr)
@@ -298,6 +330,9 @@ if __name__ == '__main__':
                 text = deposit.getDepositionText(args.omit_time, args.omit_mcparticle)
                 fout.write(text)
 
+            if writeBinary:
+                fbin.write(deposit.getDepositionBinary(args.omit_time, args.omit_mcparticle))
+
 
     if writeROOT:
         # Inspect tree and write ROOT file
@@ -310,3 +345,12 @@ if __name__ == '__main__':
         # End the file with a line break to prevent from the last line being ignored due to the EOF
         fout.write("\n")
         fout.close()
+
+    if writeBinary:
+        # Append the event index and write the header
+        indexOffset = fbin.tell()
+        for entry in binaryIndex:
+            fbin.write(struct.pack("<QQQ", *entry))
+        fbin.seek(0)
+        fbin.write(struct.pack("<8sIIQQ", b"APSQDEP1", 1, 1, len(binaryIndex), indexOffset))
+        fbin.close()
@@ -119,6 +119,15 @@ namespace allpix {
          * @return Vector of the field at the queried point
          */
         ROOT::Math::XYZVector getElectricField(const ROOT::Math::XYZPoint& local_pos) const;
+        /**
+         * @brief Derive a new field from the electric field map, evaluated once per cell of the electric field grid
+         * @param function Function calculating the derived value from the electric field and the local position of a cell
+         * @return Derived field sharing the binning and mapping of the electric field
+         * @throws std::invalid_argument If the electric field is not defined on a grid
+         */
+        template <typename T, size_t N, typename F> DetectorField<T, N> deriveFromElectricField(const F& function) const {
+            return electric_field_.template derive<T, N>(function);
+        }
 
         /**
          * @brief Set the electric field in a single pixel in the detector using a grid
@@ -14,6 +14,7 @@
 
 #include <array>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include <Math/Point2D.h>
@@ -88,6 +89,30 @@ namespace allpix {
      */
     template <> inline void flip_vector_components<double>(double&, bool, bool) {}
 
+    /**
+     * @brief Helper function to append the components of a field value to a flat field vector
+     * @param data  Flat field vector
+     * @param field Field value, templated to support vector fields and scalar fields
+     */
+    template <typename T> void append_field_components(std::vector<double>& data, const T& field);
+
+    /*
+     * Vector field template specialization of helper function for appending field components
+     */
+    template <>
+    inline void append_field_components<ROOT::Math::XYZVector>(std::vector<double>& data, const ROOT::Math::XYZVector& vec) {
+        data.push_back(vec.x());
+        data.push_back(vec.y());
+        data.push_back(vec.z());
+    }
+
+    /*
+     * Scalar field template specialization of helper function for appending field components
+     */
+    template <> inline void append_field_components<double>(std::vector<double>& data, const double& value) {
+        data.push_back(value);
+    }
+
     /**
      * @brief Field instance of a detector
      *
@@ -96,6 +121,7 @@ namespace allpix {
      */
     template <typename T, size_t N = 3> class DetectorField {
         friend class Detector;
+        template <typename U, size_t M> friend class DetectorField;
 
     public:
         /**
@@ -162,6 +188,20 @@ namespace allpix {
                          std::pair<double, double> thickness_domain,
                          FieldType type = FieldType::CUSTOM);
 
+        /**
+         * @brief Derive a new field on the grid of this field
+         * @param function Function calculating the derived value from the field value and the position of each grid cell
+         * @return Derived field sharing the binning, mapping and thickness domain of this field
+         * @tparam U Type of the derived field value
+         * @tparam M Number of components of the derived field value
+         *
+         * The function is evaluated once per grid cell with the field value of the cell and the center of the cell in local
+         * coordinates, taken in the pixel the field is mapped to at the local coordinate origin. Lookups of the derived
+         * field apply the same mapping and flipping as for this field, so the derived field needs to follow the same
+         * symmetry.
+         */
+        template <typename U, size_t M, typename F> DetectorField<U, M> derive(const F& function) const;
+
     private:
         /**
          * @brief Set the detector model this field is used for
@@ -244,6 +244,84 @@ namespace allpix {
         type_ = FieldType::GRID;
     }
 
+    /**
+     * The local position of each grid cell is obtained by inverting the mapping applied in get() and getRelativeTo() for
+     * the unflipped part of the field, using the pixel at the local coordinate origin as reference.
+     * @throws std::invalid_argument If the field is not defined on a grid
+     */
+    template <typename T, size_t N>
+    template <typename U, size_t M, typename F>
+    DetectorField<U, M> DetectorField<T, N>::derive(const F& function) const {
+        if(type_ != FieldType::GRID) {
+            throw std::invalid_argument("field is not defined on a grid");
+        }
+
+        // Reference point of the field, fields mapped to the full sensor start at the edge of the first pixel
+        auto pitch = model_->getPixelSize();
+        auto reference = (mapping_ == FieldMapping::SENSOR
+                              ? ROOT::Math::XYPoint(-0.5 * pitch.x(), -0.5 * pitch.y())
+                              : static_cast<ROOT::Math::XYPoint>(model_->getPixelCenter(0, 0)));
+
+        // Shift of the field origin in units of the field size depending on the mapping, inverting getRelativeTo()
+        auto shift_x = [&](double px) {
+            if(mapping_ == FieldMapping::PIXEL_QUADRANT_II || mapping_ == FieldMapping::PIXEL_QUADRANT_III ||
+               mapping_ == FieldMapping::PIXEL_HALF_LEFT) {
+                return 1.0;
+            } else if(mapping_ == FieldMapping::PIXEL_FULL || mapping_ == FieldMapping::PIXEL_HALF_TOP ||
+                      mapping_ == FieldMapping::PIXEL_HALF_BOTTOM) {
+                return 0.5;
+            } else if(mapping_ == FieldMapping::PIXEL_FULL_INVERSE) {
+                return (px < 0.5 ? 0. : 1.0);
+            }
+            return 0.;
+        };
+        auto shift_y = [&](double py) {
+            if(mapping_ == FieldMapping::PIXEL_QUADRANT_III || mapping_ == FieldMapping::PIXEL_QUADRANT_IV ||
+               mapping_ == FieldMapping::PIXEL_HALF_BOTTOM) {
+                return 1.0;
+            } else if(mapping_ == FieldMapping::PIXEL_FULL || mapping_ == FieldMapping::PIXEL_HALF_LEFT ||
+                      mapping_ == FieldMapping::PIXEL_HALF_RIGHT) {
+                return 0.5;
+            } else if(mapping_ == FieldMapping::PIXEL_FULL_INVERSE) {
+                return (py < 0.5 ? 0. : 1.0);
+            }
+            return 0.;
+        };
+
+        auto data = std::make_shared<std::vector<double>>();
+        data->reserve(bins_[0] * bins_[1] * bins_[2] * M);
+        auto z_step = (thickness_domain_.second - thickness_domain_.first) / static_cast<double>(bins_[2]);
+        for(size_t x = 0; x < bins_[0]; ++x) {
+            // Two-dimensional fields are evaluated at the reference point
+            auto px = (static_cast<double>(x) + 0.5) / static_cast<double>(bins_[0]);
+            auto pos_x =
+                (bins_[0] == 1 ? reference.x() : reference.x() + (px - shift_x(px)) / normalization_[0] - offset_[0]);
+            for(size_t y = 0; y < bins_[1]; ++y) {
+                auto py = (static_cast<double>(y) + 0.5) / static_cast<double>(bins_[1]);
+                auto pos_y =
+                    (bins_[1] == 1 ? reference.y() : reference.y() + (py - shift_y(py)) / normalization_[1] - offset_[1]);
+                for(size_t z = 0; z < bins_[2]; ++z) {
+                    auto pos_z = thickness_domain_.first + (static_cast<double>(z) + 0.5) * z_step;
+                    auto index = x * bins_[1] * bins_[2] * N + y * bins_[2] * N + z * N;
+                    U value =
+                        function(get_impl(index, std::make_index_sequence<N>{}), ROOT::Math::XYZPoint(pos_x, pos_y, pos_z));
+                    append_field_components(*data, value);
+                }
+            }
+        }
+
+        DetectorField<U, M> derived;
+        derived.model_ = model_;
+        derived.field_ = std::move(data);
+        derived.bins_ = bins_;
+        derived.mapping_ = mapping_;
+        derived.normalization_ = normalization_;
+        derived.offset_ = offset_;
+        derived.thickness_domain_ = thickness_domain_;
+        derived.type_ = FieldType::GRID;
+        return derived;
+    }
+
     template <typename T, size_t N>
     void
     DetectorField<T, N>::setFunction(FieldFunction<T> function, std::pair<double, double> thickness_domain, FieldType type) {
@@ -17,6 +17,10 @@
 #include "core/geometry/RadialStripDetectorModel.hpp"
 #include "tools/liang_barsky.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <Math/Translation3D.h>
 
 using namespace allpix;
@@ -64,6 +68,9 @@ std::shared_ptr<DetectorModel> DetectorModel::factory(const std::string& name, c
     // Validate the detector model - we call this here because validation might depend on derived class properties:
     model->validate();
 
+    // Precompute the implant occupancy of the pixel cell to accelerate containment checks
+    model->buildImplantMask();
+
     return model;
 }
 
@@ -162,6 +169,154 @@ void DetectorModel::validate() {
     LOG(WARNING) << "No validation implemented for this detector geometry";
 }
 
+void DetectorModel::buildImplantMask() {
+    implant_mask_.clear();
+    if(implants_.empty()) {
+        return;
+    }
+
+    // Positions relative to the pixel center share the depth offset of the pixel centers, identical for all pixels
+    implant_mask_center_z_ = getPixelCenter(0, 0).z();
+
+    // Axis-aligned bounding boxes of all implants relative to the pixel center, and the smallest implant extent per axis
+    std::vector<std::pair<ROOT::Math::XYZVector, ROOT::Math::XYZVector>> boxes;
+    ROOT::Math::XYZVector min_extent(std::numeric_limits<double>::max(),
+                                     std::numeric_limits<double>::max(),
+                                     std::numeric_limits<double>::max());
+    for(const auto& implant : implants_) {
+        auto angle = implant.getOrientation().Angle();
+        auto size = implant.getSize();
+        ROOT::Math::XYZVector half(std::fabs(std::cos(angle)) * size.x() / 2 + std::fabs(std::sin(angle)) * size.y() / 2,
+                                   std::fabs(std::sin(angle)) * size.x() / 2 + std::fabs(std::cos(angle)) * size.y() / 2,
+                                   size.z() / 2);
+        boxes.emplace_back(implant.getOffset() - half, implant.getOffset() + half);
+        min_extent.SetXYZ(std::min(min_extent.x(), 2 * half.x()),
+                          std::min(min_extent.y(), 2 * half.y()),
+                          std::min(min_extent.z(), 2 * half.z()));
+    }
+
+    implant_mask_min_ = boxes.front().first;
+    implant_mask_max_ = boxes.front().second;
+    for(const auto& [lower, upper] : boxes) {
+        implant_mask_min_.SetXYZ(std::min(implant_mask_min_.x(), lower.x()),
+                                 std::min(implant_mask_min_.y(), lower.y()),
+                                 std::min(implant_mask_min_.z(), lower.z()));
+        implant_mask_max_.SetXYZ(std::max(implant_mask_max_.x(), upper.x()),
+                                 std::max(implant_mask_max_.y(), upper.y()),
+                                 std::max(implant_mask_max_.z(), upper.z()));
+    }
+
+    // Implants without volume cannot be resolved by the grid, always use the exact test
+    auto extent = implant_mask_max_ - implant_mask_min_;
+    if(min_extent.x() <= 0 || min_extent.y() <= 0 || min_extent.z() <= 0) {
+        return;
+    }
+
+    // Resolve the smallest implant with eight cells per axis, limiting the grid to 64 cells per axis
+    auto bins = [](double length, double feature) {
+        return std::clamp(static_cast<size_t>(std::ceil(8 * length / feature)), size_t(1), size_t(64));
+    };
+    implant_mask_bins_ = {
+        bins(extent.x(), min_extent.x()), bins(extent.y(), min_extent.y()), bins(extent.z(), min_extent.z())};
+    implant_mask_cell_.SetXYZ(extent.x() / static_cast<double>(implant_mask_bins_[0]),
+                              extent.y() / static_cast<double>(implant_mask_bins_[1]),
+                              extent.z() / static_cast<double>(implant_mask_bins_[2]));
+
+    // Classify the cells, slightly enlarged to be conservative with respect to rounding in the lookup
+    auto epsilon = 1e-6 * implant_mask_cell_;
+    implant_mask_.resize(implant_mask_bins_[0] * implant_mask_bins_[1] * implant_mask_bins_[2]);
+    for(size_t ix = 0; ix < implant_mask_bins_[0]; ++ix) {
+        for(size_t iy = 0; iy < implant_mask_bins_[1]; ++iy) {
+            for(size_t iz = 0; iz < implant_mask_bins_[2]; ++iz) {
+                ROOT::Math::XYZVector lower(implant_mask_min_.x() + static_cast<double>(ix) * implant_mask_cell_.x(),
+                                            implant_mask_min_.y() + static_cast<double>(iy) * implant_mask_cell_.y(),
+                                            implant_mask_min_.z() + static_cast<double>(iz) * implant_mask_cell_.z());
+                lower -= epsilon;
+                auto upper = lower + implant_mask_cell_ + 2 * epsilon;
+
+                uint8_t cell = 0;
+                for(size_t idx = 0; idx < implants_.size(); ++idx) {
+                    const auto& [box_lower, box_upper] = boxes[idx];
+                    if(upper.x() < box_lower.x() || lower.x() > box_upper.x() || upper.y() < box_lower.y() ||
+                       lower.y() > box_upper.y() || upper.z() < box_lower.z() || lower.z() > box_upper.z()) {
+                        continue;
+                    }
+
+                    // The first overlapping implant determines the result, the cell is fully contained in this convex
+                    // implant if all of its corners are
+                    bool contained = (idx + 1 < implant_mask_mixed_);
+                    for(int corner = 0; corner < 8 && contained; ++corner) {
+                        ROOT::Math::XYZVector position((corner & 1) ? upper.x() : lower.x(),
+                                                       (corner & 2) ? upper.y() : lower.y(),
+                                                       (corner & 4) ? upper.z() : lower.z());
+                        contained = implants_[idx].contains(position);
+                    }
+                    cell = (contained ? static_cast<uint8_t>(idx + 1) : implant_mask_mixed_);
+                    break;
+                }
+                implant_mask_[(ix * implant_mask_bins_[1] + iy) * implant_mask_bins_[2] + iz] = cell;
+            }
+        }
+    }
+
+    LOG(DEBUG) << "Built implant mask with " << implant_mask_bins_[0] << "x" << implant_mask_bins_[1] << "x"
+               << implant_mask_bins_[2] << " cells for detector model " << getType();
+
+    // Compare the mask with the exact test at positions between the cell boundaries, including one cell around the mask,
+    // and discard the mask if they disagree
+    size_t positions = 0;
+    size_t mismatches = 0;
+    auto probe = [](size_t index, double min, double cell) { return min + (static_cast<double>(index) - 1.5) * cell / 2; };
+    for(size_t ix = 0; ix < 2 * implant_mask_bins_[0] + 4; ++ix) {
+        for(size_t iy = 0; iy < 2 * implant_mask_bins_[1] + 4; ++iy) {
+            for(size_t iz = 0; iz < 2 * implant_mask_bins_[2] + 4; ++iz) {
+                ROOT::Math::XYZVector position(probe(ix, implant_mask_min_.x(), implant_mask_cell_.x()),
+                                               probe(iy, implant_mask_min_.y(), implant_mask_cell_.y()),
+                                               probe(iz, implant_mask_min_.z(), implant_mask_cell_.z()));
+                auto cell = getImplantMaskCell(position);
+                if(cell == implant_mask_mixed_) {
+                    continue;
+                }
+
+                auto implant = std::find_if(implants_.begin(), implants_.end(), [&](const auto& candidate) {
+                    return candidate.contains(position);
+                });
+                auto exact = (implant == implants_.end() ? 0 : static_cast<size_t>(implant - implants_.begin()) + 1);
+                mismatches += (exact != cell ? 1 : 0);
+                ++positions;
+            }
+        }
+    }
+
+    if(mismatches > 0) {
+        LOG(WARNING) << "Implant mask of detector model " << getType()
+                     << " disagrees with the exact containment test at " << mismatches << " of " << positions
+                     << " positions, using the exact test only";
+        implant_mask_.clear();
+    } else {
+        LOG(DEBUG) << "Verified implant mask of detector model " << getType()
+                   << " against the exact containment test at " << positions << " positions";
+    }
+}
+
+uint8_t DetectorModel::getImplantMaskCell(const ROOT::Math::XYZVector& position) const {
+    // Positions outside the bounding box of the implants are not within any implant
+    auto relative = position - implant_mask_min_;
+    auto extent = implant_mask_max_ - implant_mask_min_;
+    if(relative.x() < 0 || relative.y() < 0 || relative.z() < 0 || relative.x() > extent.x() || relative.y() > extent.y() ||
+       relative.z() > extent.z()) {
+        return 0;
+    }
+
+    auto index = [](double value, double cell, size_t bins) {
+        return std::min(static_cast<size_t>(value / cell), bins - 1);
+    };
+    auto ix = index(relative.x(), implant_mask_cell_.x(), implant_mask_bins_[0]);
+    auto iy = index(relative.y(), implant_mask_cell_.y(), implant_mask_bins_[1]);
+    auto iz = index(relative.z(), implant_mask_cell_.z(), implant_mask_bins_[2]);
+    return implant_mask_[(ix * implant_mask_bins_[1] + iy) * implant_mask_bins_[2] + iz];
+}
+
 bool DetectorModel::Implant::contains(const ROOT::Math::XYZVector& position) const {
     // Shift position to implant coordinate system and apply rotation around z axis:
     auto pos = orientation_(position - offset_);
@@ -307,9 +462,25 @@ std::optional<DetectorModel::Implant> DetectorModel::isWithinImplant(const ROOT:
         return std::nullopt;
     }
 
+    // Bail out if the position is outside the depth range of the implants - no need to find the pixel:
+    auto depth = local_pos.z() - implant_mask_center_z_;
+    if(!implant_mask_.empty() && (depth < implant_mask_min_.z() || depth > implant_mask_max_.z())) {
+        return std::nullopt;
+    }
+
     auto [xpixel, ypixel] = getPixelIndex(local_pos);
     auto inPixelPos = local_pos - getPixelCenter(xpixel, ypixel);
 
+    // Use the precomputed mask unless the cell is crossed by an implant boundary
+    if(!implant_mask_.empty()) {
+        auto cell = getImplantMaskCell(inPixelPos);
+        if(cell == 0) {
+            return std::nullopt;
+        } else if(cell != implant_mask_mixed_) {
+            return implants_[cell - 1u];
+        }
+    }
+
     for(const auto& implant : implants_) {
         if(implant.contains(inPixelPos)) {
             return implant;
@@ -18,8 +18,10 @@
 #define ALLPIX_DETECTOR_MODEL_H
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <Math/Point2D.h>
 #include <Math/Point3D.h>
@@ -373,6 +375,9 @@ namespace allpix {
          * surface, the additional depth parameter is used to create a volume within which carriers are considered inside the
          * implant.
          *
+         * Positions are first looked up in the implant mask precomputed when the model is created, and only positions in
+         * cells of the mask crossed by an implant boundary are tested against the individual implants.
+         *
          * @param local_pos Position in local coordinates of the detector model
          * @return Either the implant in which the position is located, or false
          */
@@ -582,7 +587,33 @@ namespace allpix {
         // Validation of the detector model
         virtual void validate();
 
+        /**
+         * @brief Precompute the occupancy of the implants on a grid relative to the pixel center
+         *
+         * The grid covers the bounding box of all implants. Every cell stores whether it is free of implants, fully
+         * contained in a single implant, or crossed by an implant boundary and therefore requires the exact test. The mask is
+         * then compared with the exact test for positions on a finer grid, and discarded if they disagree.
+         */
+        void buildImplantMask();
+
+        /**
+         * @brief Look up the cell of the implant mask for a position relative to the pixel center
+         * @param position Position relative to the pixel center
+         * @return Content of the mask cell
+         */
+        uint8_t getImplantMaskCell(const ROOT::Math::XYZVector& position) const;
+
         ConfigReader reader_;
+
+        // Precomputed implant occupancy relative to the pixel center: zero for cells without implant, the implant index
+        // plus one for cells fully contained in a single implant, and implant_mask_mixed_ for cells requiring the exact test
+        static constexpr uint8_t implant_mask_mixed_ = 255;
+        std::vector<uint8_t> implant_mask_;
+        std::array<size_t, 3> implant_mask_bins_{};
+        ROOT::Math::XYZVector implant_mask_min_{};
+        ROOT::Math::XYZVector implant_mask_max_{};
+        ROOT::Math::XYZVector implant_mask_cell_{};
+        double implant_mask_center_z_{};
     };
 } // namespace allpix
 
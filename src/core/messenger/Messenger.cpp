@@ -15,10 +15,12 @@
 #include <stdexcept>
 #include <string>
 #include <typeindex>
+#include <unordered_map>
 
 #include "Message.hpp"
 #include "core/module/Module.hpp"
 #include "core/utils/log.h"
+#include "core/utils/trace.h"
 #include "core/utils/type.h"
 #include "delegates.h"
 
@@ -148,6 +150,19 @@ void LocalMessenger::dispatchMessage(Module* source, std::shared_ptr<BaseMessage
         name = source->get_configuration().get<std::string>("output");
     }
 
+    // Trace the dispatch under the message type name, which is only demangled once per thread and type
+    const char* trace_name = "";
+    if(Tracer::enabled()) {
+        thread_local std::unordered_map<std::type_index, const char*> trace_names;
+        const BaseMessage* inst = message.get();
+        auto& type_name = trace_names[typeid(*inst)];
+        if(type_name == nullptr) {
+            type_name = Tracer::intern(allpix::demangle(typeid(*inst).name()));
+        }
+        trace_name = type_name;
+    }
+    TraceSpan span(trace_name, "dispatch", Log::getEventNum());
+
     bool send = false;
 
     // Send messages to specific listeners
@@ -24,8 +24,6 @@
 
 using namespace allpix;
 
-std::mutex Event::stats_mutex_;
-
 Event::Event(Messenger& messenger, uint64_t event_num, uint64_t seed) : number(event_num), seed_(seed) {
     local_messenger_ = std::make_unique<LocalMessenger>(messenger);
 }
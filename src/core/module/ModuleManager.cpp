@@ -20,6 +20,7 @@
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <limits>
 #include <set>
 #include <stdexcept>
@@ -34,6 +35,7 @@
 #include "core/geometry/GeometryManager.hpp"
 #include "core/messenger/Messenger.hpp"
 #include "core/utils/log.h"
+#include "core/utils/trace.h"
 
 // Common prefix for all modules
 // TODO [doc] Should be provided by the build system
@@ -64,6 +66,16 @@ void ModuleManager::load(Messenger* messenger, ConfigManager* conf_manager, Geom
     // Set default for performance plot creation:
     global_config.setDefault("performance_plots", false);
 
+    // Enable tracing of the execution if a trace file is requested
+    global_config.setDefault<size_t>("trace_buffer_size", 65536);
+    if(global_config.has("trace_file")) {
+        auto trace_buffer_size = global_config.get<size_t>("trace_buffer_size");
+        if(trace_buffer_size == 0) {
+            throw InvalidValueError(global_config, "trace_buffer_size", "buffer size should be larger than zero");
+        }
+        Tracer::enable(trace_buffer_size);
+    }
+
     // Store the messenger
     messenger_ = messenger;
 
@@ -689,6 +701,14 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
     Configuration& global_config = conf_manager_->getGlobalConfiguration();
     auto plot = global_config.get<bool>("performance_plots");
 
+    // Names of the modules in the execution trace
+    std::map<Module*, const char*> trace_names;
+    if(Tracer::enabled()) {
+        for(const auto& module : modules_) {
+            trace_names.emplace(module.get(), Tracer::intern(module->get_identifier().getUniqueName()));
+        }
+    }
+
     // Creates the thread pool
     LOG(TRACE) << "Initializing thread pool with " << number_of_threads_ << " threads";
     auto initialize_function =
@@ -765,11 +785,19 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-overflow"
         auto event_function_with_module =
-            [this, plot, number_of_events, event_num = i, event_seed = seed, &finished_events, &aborted_events](
-                std::shared_ptr<Event> event,
-                ModuleList::iterator module_iter,
-                int64_t event_time,
-                auto&& self_func) mutable -> void {
+            [this,
+             plot,
+             number_of_events,
+             event_num = i,
+             event_seed = seed,
+             &finished_events,
+             &aborted_events,
+             &trace_names](std::shared_ptr<Event> event,
+                           ModuleList::iterator module_iter,
+                           int64_t event_time,
+                           int64_t rescheduled_at,
+                           const char* wait_reason,
+                           auto&& self_func) mutable -> void {
             // The RNG to be used by all events running on this thread
             static thread_local RandomNumberGenerator random_engine;
 
@@ -782,6 +810,13 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                 LOG(TRACE) << "Continue with earlier event, restoring random seed";
                 event->set_and_seed_random_engine(&random_engine);
                 event->restore_random_engine_state();
+
+                // Trace the time the event has been waiting for the module it was interrupted at, which overlaps with the
+                // spans of other events executed by this thread in the meantime
+                if(wait_reason != nullptr && !trace_names.empty()) {
+                    Tracer::recordAsync(
+                        trace_names.at(module_iter->get()), wait_reason, event_num, rescheduled_at, Tracer::now());
+                }
             }
 
             while(module_iter != modules_.end()) {
@@ -794,6 +829,7 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                 if(!module->check_delegates(this->messenger_, event.get())) {
                     LOG(TRACE) << "Not all required messages are received for " << module->get_identifier().getUniqueName()
                                << ", skipping module!";
+                    module->skip_event(event_num);
                     ++module_iter;
                     continue;
                 }
@@ -808,14 +844,18 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                 // Run module
                 bool stop = false;
                 bool abort = false;
+                const char* stop_reason = nullptr;
+                auto trace_start = (trace_names.empty() ? 0 : Tracer::now());
                 try {
                     if(module->require_sequence() && event_num != thread_pool_->minimumUncompleted()) {
                         stop = true;
+                        stop_reason = "wait_for_sequence";
                     } else {
                         module->run(event.get());
                     }
                 } catch(const MissingDependenciesException& e) {
                     stop = true;
+                    stop_reason = "wait_for_dependencies";
                 } catch(const AbortEventException& e) {
                     LOG(WARNING) << "Event aborted:" << std::endl << e.what();
                     abort = true;
@@ -828,21 +868,32 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                 // Reset logging
                 ModuleManager::set_module_after(old_settings);
 
+                // Trace the module execution, interrupted executions are traced as rescheduling
+                int64_t trace_end = 0;
+                if(!trace_names.empty()) {
+                    trace_end = Tracer::now();
+                    Tracer::record(
+                        trace_names.at(module.get()), (stop ? "reschedule" : "module"), event_num, trace_start, trace_end);
+                }
+
                 // Update execution time
                 auto end = std::chrono::steady_clock::now();
                 auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
                 // Note: we do not need to lock a mutex because the std::map is not altered and its values are atomic.
                 this->module_execution_time_[module.get()] += duration;
 
+                // Note: no lock is required, the event time is local to this task and histograms are filled per thread
                 if(plot) {
-                    std::lock_guard<std::mutex> stat_lock{event->stats_mutex_};
                     event_time += duration;
                     this->module_event_time_[module.get()]->Fill(
                         std::chrono::duration<double>(std::chrono::nanoseconds(duration)).count());
                 }
 
                 if(abort) {
-                    // Break module execution loop:
+                    // Inform the remaining modules that they will not see this event and break module execution loop:
+                    for(auto skip_iter = std::next(module_iter); skip_iter != modules_.end(); ++skip_iter) {
+                        (*skip_iter)->skip_event(event_num);
+                    }
                     aborted_events++;
                     break;
                 }
@@ -853,7 +904,8 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
                     // Store state of PRNG engine:
                     event->store_random_engine_state();
                     // Reschedule the event:
-                    auto event_function = std::bind(self_func, event, module_iter, event_time, self_func);
+                    auto event_function =
+                        std::bind(self_func, event, module_iter, event_time, trace_end, stop_reason, self_func);
                     auto future = thread_pool_->submit(event->number, event_function, false);
                     assert(future.valid() || !thread_pool_->valid());
                     auto buffered_events = thread_pool_->bufferedQueueSize();
@@ -882,7 +934,7 @@ void ModuleManager::run(RandomNumberGenerator& seeder) {
         };
 
         auto event_function =
-            std::bind(event_function_with_module, nullptr, modules_.begin(), 0, event_function_with_module);
+            std::bind(event_function_with_module, nullptr, modules_.begin(), 0, 0, nullptr, event_function_with_module);
 
         auto future = thread_pool_->submit(event_function);
         assert(future.valid() || !thread_pool_->valid());
@@ -950,8 +1002,11 @@ void ModuleManager::finalize() {
         auto old_settings = set_module_before(module->get_identifier().getUniqueName(), module->get_configuration(), "F:");
         // Change to our ROOT directory
         module->getROOTDirectory()->cd();
-        // Finalize module
-        module->finalize();
+        // Finalize module, tracing it as flush of its output
+        {
+            TraceSpan span(Tracer::enabled() ? Tracer::intern(module->get_identifier().getUniqueName()) : "", "finalize");
+            module->finalize();
+        }
         // Remove the pointer to the ROOT directory after finalizing
         module->set_ROOT_directory(nullptr);
         // Remove the config manager
@@ -993,7 +1048,18 @@ void ModuleManager::finalize() {
     }
 
     // Close module ROOT file
-    modules_file_->Close();
+    {
+        TraceSpan span("main_root_file", "finalize");
+        modules_file_->Close();
+    }
+
+    // Write the execution trace
+    if(Tracer::enabled()) {
+        auto path = std::filesystem::path(gSystem->pwd()) / global_config.get<std::string>("trace_file");
+        path.replace_extension("json");
+        auto spans = Tracer::write(path);
+        LOG(STATUS) << "Wrote " << spans << " spans to execution trace " << path;
+    }
     LOG_PROGRESS(STATUS, "FINALIZE_LOOP") << "Finalization completed";
     auto end_time = std::chrono::steady_clock::now();
     finalize_time_ =
@@ -12,7 +12,9 @@
 #ifndef ALLPIX_RANDOM_DISTRIBUTIONS_H
 #define ALLPIX_RANDOM_DISTRIBUTIONS_H
 
+#include <boost/random/binomial_distribution.hpp>
 #include <boost/random/exponential_distribution.hpp>
+#include <boost/random/negative_binomial_distribution.hpp>
 #include <boost/random/normal_distribution.hpp>
 #include <boost/random/piecewise_linear_distribution.hpp>
 #include <boost/random/poisson_distribution.hpp>
@@ -24,6 +26,8 @@ namespace allpix {
     template <typename T> using poisson_distribution = boost::random::poisson_distribution<T>;
     template <typename T> using uniform_real_distribution = boost::random::uniform_real_distribution<T>;
     template <typename T> using exponential_distribution = boost::random::exponential_distribution<T>;
+    template <typename T> using binomial_distribution = boost::random::binomial_distribution<T>;
+    template <typename T> using negative_binomial_distribution = boost::random::negative_binomial_distribution<T>;
 } // namespace allpix
 
 #endif // ALLPIX_RANDOM_DISTRIBUTIONS_H
@@ -0,0 +1,205 @@
+/**
+ * @file
+ * @brief Implementation of the tracer
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "core/utils/exceptions.h"
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+namespace {
+    // Single recorded span, times are in nanoseconds since the tracer was enabled
+    struct Span {
+        const char* name;
+        const char* category;
+        uint64_t event;
+        int64_t start;
+        int64_t duration;
+        bool async;
+    };
+
+    // Ring buffer of a single thread, only the owning thread writes to it
+    struct Buffer {
+        Buffer(size_t size, unsigned int thread) : spans(size), thread_id(thread) {}
+
+        std::vector<Span> spans;
+        std::atomic<uint64_t> count{0};
+        unsigned int thread_id;
+    };
+
+    // Global state of the tracer
+    struct State {
+        std::atomic<bool> enabled{false};
+        std::atomic<unsigned int> generation{0};
+        size_t buffer_size{0};
+        std::chrono::steady_clock::time_point epoch;
+
+        // Guards registration of buffers and interned names
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Buffer>> buffers;
+        std::set<std::string> names;
+    };
+
+    State& state() {
+        static State state;
+        return state;
+    }
+
+    // Store a span in the buffer of the calling thread
+    void record_span(const Span& span) {
+        auto& trace_state = state();
+        if(!trace_state.enabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // Register a buffer for this thread on its first span after the tracer has been enabled
+        thread_local Buffer* buffer = nullptr;
+        thread_local unsigned int generation = 0;
+        if(buffer == nullptr || generation != trace_state.generation.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock{trace_state.mutex};
+            auto thread_id = static_cast<unsigned int>(trace_state.buffers.size());
+            trace_state.buffers.push_back(std::make_unique<Buffer>(trace_state.buffer_size, thread_id));
+            buffer = trace_state.buffers.back().get();
+            generation = trace_state.generation;
+        }
+
+        // Overwrite the oldest span if the buffer is full
+        auto count = buffer->count.load(std::memory_order_relaxed);
+        buffer->spans[count % buffer->spans.size()] = span;
+        buffer->count.store(count + 1, std::memory_order_release);
+    }
+
+    // Write the microseconds of a duration in nanoseconds with full precision
+    void write_microseconds(std::ostream& out, int64_t nanoseconds) {
+        out << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+    }
+
+    // Write a string as JSON string, names only need quotes and backslashes to be escaped
+    void write_string(std::ostream& out, const char* str) {
+        out << '"';
+        for(const char* c = str; *c != '\0'; ++c) {
+            if(*c == '"' || *c == '\\') {
+                out << '\\';
+            }
+            out << *c;
+        }
+        out << '"';
+    }
+} // namespace
+
+void Tracer::enable(size_t buffer_size) {
+    auto& trace_state = state();
+    std::lock_guard<std::mutex> lock{trace_state.mutex};
+
+    // Invalidate the buffers registered by the threads so far
+    trace_state.buffers.clear();
+    trace_state.buffer_size = std::max<size_t>(buffer_size, 1);
+    trace_state.epoch = std::chrono::steady_clock::now();
+    trace_state.generation++;
+    trace_state.enabled = true;
+}
+
+bool Tracer::enabled() {
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+int64_t Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state().epoch).count();
+}
+
+const char* Tracer::intern(const std::string& name) {
+    auto& trace_state = state();
+    std::lock_guard<std::mutex> lock{trace_state.mutex};
+    return trace_state.names.insert(name).first->c_str();
+}
+
+void Tracer::record(const char* name, const char* category, uint64_t event, int64_t start, int64_t end) {
+    record_span({name, category, event, start, end - start, false});
+}
+
+void Tracer::recordAsync(const char* name, const char* category, uint64_t event, int64_t start, int64_t end) {
+    record_span({name, category, event, start, end - start, true});
+}
+
+/**
+ * Spans are written as complete events, the event number is added as argument for spans belonging to an event. Spans which
+ * may overlap with the other spans of their thread are written as pair of asynchronous begin and end events with the event
+ * number as identifier. The threads are numbered in the order in which they have recorded their first span.
+ */
+size_t Tracer::write(const std::filesystem::path& file_name) {
+    auto& trace_state = state();
+    std::lock_guard<std::mutex> lock{trace_state.mutex};
+
+    std::ofstream file(file_name);
+    if(!file.good()) {
+        throw RuntimeError("Cannot create trace file " + file_name.string());
+    }
+
+    size_t written = 0;
+    uint64_t dropped = 0;
+    bool separate = false;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for(const auto& buffer : trace_state.buffers) {
+        auto count = buffer->count.load(std::memory_order_acquire);
+        auto size = static_cast<uint64_t>(buffer->spans.size());
+        auto first = (count > size ? count - size : 0);
+        dropped += first;
+
+        for(auto idx = first; idx < count; ++idx) {
+            const auto& span = buffer->spans[idx % size];
+            auto write_event = [&](const char* phase, int64_t timestamp) {
+                file << (separate ? ",\n" : "\n") << "{\"name\":";
+                separate = true;
+                write_string(file, span.name);
+                file << ",\"cat\":";
+                write_string(file, span.category);
+                file << ",\"ph\":\"" << phase << "\",\"ts\":";
+                write_microseconds(file, timestamp);
+                if(span.async) {
+                    file << ",\"id\":" << span.event;
+                } else {
+                    file << ",\"dur\":";
+                    write_microseconds(file, span.duration);
+                }
+                file << ",\"pid\":1,\"tid\":" << buffer->thread_id;
+                if(span.event != 0) {
+                    file << ",\"args\":{\"event\":" << span.event << "}";
+                }
+                file << "}";
+            };
+
+            if(span.async) {
+                write_event("b", span.start);
+                write_event("e", span.start + span.duration);
+            } else {
+                write_event("X", span.start);
+            }
+            ++written;
+        }
+    }
+    file << "\n]}\n";
+
+    if(dropped > 0) {
+        LOG(WARNING) << "Trace buffers were full, the oldest " << dropped << " spans have been dropped";
+    }
+    return written;
+}
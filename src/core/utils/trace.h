@@ -0,0 +1,135 @@
+/**
+ * @file
+ * @brief Provides a low-overhead tracer recording timed spans of the framework execution
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_TRACE_H
+#define ALLPIX_TRACE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace allpix {
+    /**
+     * @brief Tracer recording timed spans of modules, messages and events
+     *
+     * Every thread records its spans into its own fixed-size ring buffer, which is registered once with the tracer when the
+     * thread records its first span. Recording is lock-free since each buffer has a single writer, and the oldest spans of a
+     * thread are overwritten if its buffer is full. The buffers are only read by \ref Tracer::write, which should only be
+     * called after all recording threads have finished, and which exports all spans in the Chrome trace event format. These
+     * files can be inspected with the Perfetto UI or the trace viewer of Chromium-based browsers.
+     *
+     * All names and categories passed to the tracer need to remain valid until the trace has been written, names created at
+     * runtime should therefore be passed through \ref Tracer::intern first.
+     */
+    class Tracer {
+    public:
+        /**
+         * @brief Enable the tracer, discarding all previously recorded spans
+         * @param buffer_size Number of spans kept per thread
+         */
+        static void enable(size_t buffer_size);
+
+        /**
+         * @brief Check if the tracer is enabled
+         * @return True if spans are recorded, false otherwise
+         */
+        static bool enabled();
+
+        /**
+         * @brief Get the current time of the tracer clock
+         * @return Nanoseconds since the tracer was enabled
+         */
+        static int64_t now();
+
+        /**
+         * @brief Get a copy of a name with static storage duration
+         * @param name Name to store
+         * @return Pointer to the stored name, identical for all calls with the same name
+         */
+        static const char* intern(const std::string& name);
+
+        /**
+         * @brief Record a span in the buffer of the calling thread
+         * @param name Name of the span
+         * @param category Category of the span
+         * @param event Number of the event the span belongs to, or zero if not related to an event
+         * @param start Start time of the span as returned by \ref Tracer::now
+         * @param end End time of the span as returned by \ref Tracer::now
+         */
+        static void record(const char* name, const char* category, uint64_t event, int64_t start, int64_t end);
+
+        /**
+         * @brief Record a span of an event in the buffer of the calling thread which may overlap with its other spans
+         * @param name Name of the span
+         * @param category Category of the span
+         * @param event Number of the event the span belongs to
+         * @param start Start time of the span as returned by \ref Tracer::now
+         * @param end End time of the span as returned by \ref Tracer::now
+         *
+         * Used for times an event spends waiting, which are only known once the event is resumed and therefore do not nest
+         * with the spans recorded by the resuming thread. These spans are written as asynchronous events identified by the
+         * event number, such that they are displayed on a separate track per event.
+         */
+        static void recordAsync(const char* name, const char* category, uint64_t event, int64_t start, int64_t end);
+
+        /**
+         * @brief Write all recorded spans to a file in the Chrome trace event format
+         * @param file_name Path of the file to write
+         * @return Number of spans written
+         * @warning Should not be called while other threads are still recording spans
+         */
+        static size_t write(const std::filesystem::path& file_name);
+    };
+
+    /**
+     * @brief Span recorded with the tracer from its construction until its destruction
+     *
+     * Does not do anything if the tracer is not enabled at construction.
+     */
+    class TraceSpan {
+    public:
+        /**
+         * @brief Start a span
+         * @param name Name of the span
+         * @param category Category of the span
+         * @param event Number of the event the span belongs to, or zero if not related to an event
+         */
+        TraceSpan(const char* name, const char* category, uint64_t event = 0)
+            : name_(name), category_(category), event_(event), start_(Tracer::enabled() ? Tracer::now() : -1) {}
+
+        /**
+         * @brief Record the span
+         */
+        ~TraceSpan() {
+            if(start_ >= 0) {
+                Tracer::record(name_, category_, event_, start_, Tracer::now());
+            }
+        }
+
+        /// @{
+        /**
+         * @brief Copying or moving a span is not allowed
+         */
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+        TraceSpan(TraceSpan&&) = delete;
+        TraceSpan& operator=(TraceSpan&&) = delete;
+        /// @}
+
+    private:
+        const char* name_;
+        const char* category_;
+        uint64_t event_;
+        int64_t start_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_TRACE_H */
@@ -22,13 +22,15 @@
 #include "core/config/ConfigReader.hpp"
 #include "core/utils/log.h"
 #include "core/utils/type.h"
+#include "core/utils/unit.h"
 
 #include "objects/Object.hpp"
 #include "objects/objects.h"
 
 using namespace allpix;
 
-thread_local std::shared_ptr<pqxx::connection> DatabaseWriterModule::conn_ = nullptr;
+thread_local std::map<const DatabaseWriterModule*, std::shared_ptr<pqxx::connection>> DatabaseWriterModule::connections_;
+thread_local std::map<const DatabaseWriterModule*, DatabaseWriterModule::StreamBuffer> DatabaseWriterModule::buffers_;
 
 DatabaseWriterModule::DatabaseWriterModule(Configuration& config, Messenger* messenger, GeometryManager*)
     : SequentialModule(config), messenger_(messenger) {
@@ -42,6 +44,11 @@ DatabaseWriterModule::DatabaseWriterModule(Configuration& config, Messenger* mes
 
     config_.setDefault("run_id", "none");
 
+    config_.setDefault("streaming", false);
+    config_.setDefault("id_block_size", 10000);
+    config_.setDefault("batch_size", 100000);
+    config_.setDefault("batch_interval", Units::get(10.0, "s"));
+
     // retrieving configuration parameters
     host_ = config_.get<std::string>("host");
     port_ = config_.get<std::string>("port");
@@ -53,6 +60,16 @@ DatabaseWriterModule::DatabaseWriterModule(Configuration& config, Messenger* mes
     // Select pixel hit timing information to be saved:
     timing_global_ = config_.get<bool>("global_timing");
 
+    // Configuration of the streaming mode
+    streaming_ = config_.get<bool>("streaming");
+    id_block_size_ = config_.get<size_t>("id_block_size");
+    batch_size_ = config_.get<size_t>("batch_size");
+    if(id_block_size_ == 0) {
+        throw InvalidValueError(config_, "id_block_size", "block size for reserved object IDs needs to be positive");
+    }
+    batch_interval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::nano>(config_.get<double>("batch_interval")));
+
     // Waive sequence requirement if requested by user
     if(!config_.get<bool>("require_sequence")) {
         waive_sequence_requirement();
@@ -102,18 +119,19 @@ void DatabaseWriterModule::prepare_statements(std::shared_ptr<pqxx::connection>
 
 void DatabaseWriterModule::initializeThread() {
     // Establishing connection to the database
-    conn_ = std::make_shared<pqxx::connection>("host=" + host_ + " port=" + port_ + " dbname=" + database_name_ +
-                                               " user=" + user_ + " password=" + password_);
-    if(!conn_->is_open()) {
+    auto conn = std::make_shared<pqxx::connection>("host=" + host_ + " port=" + port_ + " dbname=" + database_name_ +
+                                                   " user=" + user_ + " password=" + password_);
+    if(!conn->is_open()) {
         throw ModuleError("Could not connect to database " + database_name_ + " at host " + host_);
     }
 
-    prepare_statements(conn_);
+    prepare_statements(conn);
+    connections_[this] = conn;
 
     // Inserting run entry in the database
     try {
         // Open new transaction
-        pqxx::work transaction(*conn_);
+        pqxx::work transaction(connection());
         auto runR = transaction.exec_prepared1("add_run", run_id_);
         run_nr_ = runR.front().as<int>();
         // Commit transaction to database:
@@ -123,6 +141,9 @@ void DatabaseWriterModule::initializeThread() {
         throw ModuleError("SQL error: " + std::string(e.what()));
     }
 
+    // Start from an empty stream buffer for this instance on this thread
+    buffers_[this] = StreamBuffer();
+
     // Read include and exclude list
     if(config_.has("include") && config_.has("exclude")) {
         throw InvalidValueError(config_, "exclude", "include and exclude parameter are mutually exclusive");
@@ -173,6 +194,16 @@ bool DatabaseWriterModule::filter(const std::shared_ptr<BaseMessage>& message,
 void DatabaseWriterModule::run(Event* event) {
     auto messages = messenger_->fetchFilteredMessages(this, event);
 
+    // In streaming mode, only buffer the objects and write them in batches spanning many events
+    if(streaming_) {
+        buffer_event(event, messages);
+        const auto& buffer = buffers_.at(this);
+        if(buffer.size >= batch_size_ || std::chrono::steady_clock::now() - buffer.last_flush >= batch_interval_) {
+            flush_buffer();
+        }
+        return;
+    }
+
     // TO BE NOTED
     // the correct relations of objects in the database are guaranteed by the fact that sequence of dispatched messages
     // within one event always follows this order: MCTrack -> MCParticle -> DepositedCharge -> PropagatedCharge ->
@@ -188,7 +219,7 @@ void DatabaseWriterModule::run(Event* event) {
     LOG(TRACE) << "Writing new objects to database";
     try {
         // Open new transaction
-        pqxx::work transaction(*conn_);
+        pqxx::work transaction(connection());
         LOG(DEBUG) << "Started new database transaction";
 
         // Writing entry to event table
@@ -332,13 +363,322 @@ void DatabaseWriterModule::run(Event* event) {
     }
 }
 
+int DatabaseWriterModule::next_id(StreamBuffer& buffer, const std::string& table, const std::string& column) {
+    auto& ids = buffer.reserved_ids[table];
+    if(ids.empty()) {
+        // Reserve a new block of values from the serial sequence of this table. The values are not necessarily consecutive
+        // when other clients draw from the same sequence, but they are guaranteed to be unique.
+        try {
+            pqxx::nontransaction transaction(connection());
+            auto result = transaction.exec("SELECT nextval(pg_get_serial_sequence(" + transaction.quote(table) + ", " +
+                                           transaction.quote(column) + ")) FROM generate_series(1, " +
+                                           std::to_string(id_block_size_) + ");");
+            ids.reserve(result.size());
+            // Store in reverse order to hand out the lowest values first
+            for(auto row = result.rbegin(); row != result.rend(); ++row) {
+                ids.push_back(row->front().as<int>());
+            }
+        } catch(const std::exception& e) {
+            throw ModuleError("SQL error: " + std::string(e.what()));
+        }
+        LOG(DEBUG) << "Reserved block of " << ids.size() << " IDs for table " << table;
+    }
+
+    auto id = ids.back();
+    ids.pop_back();
+    return id;
+}
+
+void DatabaseWriterModule::buffer_event(Event* event,
+                                        const std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>& messages) {
+    // Same reference chain as in the direct mode, but with client-side IDs
+    std::optional<int> mctrack_nr;
+    std::optional<int> mcparticle_nr;
+    std::optional<int> depositedcharge_nr;
+    std::optional<int> propagatedcharge_nr;
+    std::optional<int> pixelcharge_nr;
+
+    auto& buffer = buffers_.at(this);
+    auto event_nr = next_id(buffer, "event", "event_nr");
+    buffer.events.emplace_back(event_nr, run_nr_, static_cast<int>(event->number));
+
+    for(const auto& pair : messages) {
+        auto& message = pair.first;
+        auto detectorName = (message->getDetector() != nullptr ? message->getDetector()->getName() : "global");
+
+        for(const auto& object : message->getObjectArray()) {
+            auto& o = object.get();
+            std::string class_name = allpix::demangle(typeid(o).name());
+
+            if(class_name == "PixelHit") {
+                const auto& hit = static_cast<const PixelHit&>(o);
+                buffer.pixelhits.emplace_back(next_id(buffer, "pixelhit", "pixelhit_nr"),
+                                               run_nr_,
+                                               event_nr,
+                                               mcparticle_nr,
+                                               pixelcharge_nr,
+                                               detectorName,
+                                               hit.getIndex().X(),
+                                               hit.getIndex().Y(),
+                                               hit.getSignal(),
+                                               (timing_global_ ? hit.getGlobalTime() : hit.getLocalTime()));
+            } else if(class_name == "PixelCharge") {
+                const auto& charge = static_cast<const PixelCharge&>(o);
+                pixelcharge_nr = next_id(buffer, "pixelcharge", "pixelcharge_nr");
+                buffer.pixelcharges.emplace_back(pixelcharge_nr.value(),
+                                                  run_nr_,
+                                                  event_nr,
+                                                  propagatedcharge_nr,
+                                                  detectorName,
+                                                  charge.getCharge(),
+                                                  charge.getIndex().X(),
+                                                  charge.getIndex().Y(),
+                                                  charge.getPixel().getLocalCenter().X(),
+                                                  charge.getPixel().getLocalCenter().Y(),
+                                                  charge.getPixel().getGlobalCenter().X(),
+                                                  charge.getPixel().getGlobalCenter().Y());
+            } else if(class_name == "PropagatedCharge") {
+                const auto& charge = static_cast<const PropagatedCharge&>(o);
+                propagatedcharge_nr = next_id(buffer, "propagatedcharge", "propagatedcharge_nr");
+                buffer.propagatedcharges.emplace_back(propagatedcharge_nr.value(),
+                                                       run_nr_,
+                                                       event_nr,
+                                                       depositedcharge_nr,
+                                                       detectorName,
+                                                       static_cast<int>(charge.getType()),
+                                                       charge.getCharge(),
+                                                       charge.getLocalPosition().X(),
+                                                       charge.getLocalPosition().Y(),
+                                                       charge.getLocalPosition().Z(),
+                                                       charge.getGlobalPosition().X(),
+                                                       charge.getGlobalPosition().Y(),
+                                                       charge.getGlobalPosition().Z());
+            } else if(class_name == "MCTrack") {
+                const auto& track = static_cast<const MCTrack&>(o);
+                mctrack_nr = next_id(buffer, "mctrack", "mctrack_nr");
+                buffer.mctracks.emplace_back(mctrack_nr.value(),
+                                              run_nr_,
+                                              event_nr,
+                                              detectorName,
+                                              reinterpret_cast<uintptr_t>(&object),
+                                              reinterpret_cast<uintptr_t>(track.getParent()),
+                                              track.getParticleID(),
+                                              track.getCreationProcessName(),
+                                              track.getOriginatingVolumeName(),
+                                              track.getStartPoint().X(),
+                                              track.getStartPoint().Y(),
+                                              track.getStartPoint().Z(),
+                                              track.getEndPoint().X(),
+                                              track.getEndPoint().Y(),
+                                              track.getEndPoint().Z(),
+                                              track.getGlobalStartTime(),
+                                              track.getGlobalEndTime(),
+                                              track.getKineticEnergyInitial(),
+                                              track.getKineticEnergyFinal());
+            } else if(class_name == "DepositedCharge") {
+                const auto& charge = static_cast<const DepositedCharge&>(o);
+                depositedcharge_nr = next_id(buffer, "depositedcharge", "depositedcharge_nr");
+                buffer.depositedcharges.emplace_back(depositedcharge_nr.value(),
+                                                      run_nr_,
+                                                      event_nr,
+                                                      mcparticle_nr,
+                                                      detectorName,
+                                                      static_cast<int>(charge.getType()),
+                                                      charge.getCharge(),
+                                                      charge.getLocalPosition().X(),
+                                                      charge.getLocalPosition().Y(),
+                                                      charge.getLocalPosition().Z(),
+                                                      charge.getGlobalPosition().X(),
+                                                      charge.getGlobalPosition().Y(),
+                                                      charge.getGlobalPosition().Z());
+            } else if(class_name == "MCParticle") {
+                const auto& particle = static_cast<const MCParticle&>(o);
+                mcparticle_nr = next_id(buffer, "mcparticle", "mcparticle_nr");
+                buffer.mcparticles.emplace_back(mcparticle_nr.value(),
+                                                 run_nr_,
+                                                 event_nr,
+                                                 mctrack_nr,
+                                                 detectorName,
+                                                 reinterpret_cast<uintptr_t>(&object),
+                                                 reinterpret_cast<uintptr_t>(particle.getParent()),
+                                                 reinterpret_cast<uintptr_t>(particle.getTrack()),
+                                                 particle.getParticleID(),
+                                                 particle.getLocalStartPoint().X(),
+                                                 particle.getLocalStartPoint().Y(),
+                                                 particle.getLocalStartPoint().Z(),
+                                                 particle.getLocalEndPoint().X(),
+                                                 particle.getLocalEndPoint().Y(),
+                                                 particle.getLocalEndPoint().Z(),
+                                                 particle.getGlobalStartPoint().X(),
+                                                 particle.getGlobalStartPoint().Y(),
+                                                 particle.getGlobalStartPoint().Z(),
+                                                 particle.getGlobalEndPoint().X(),
+                                                 particle.getGlobalEndPoint().Y(),
+                                                 particle.getGlobalEndPoint().Z());
+            } else {
+                LOG(WARNING) << "Following object type is not yet accounted for in database output: " << class_name;
+                continue;
+            }
+            buffer.size++;
+            write_cnt_++;
+        }
+        msg_cnt_++;
+    }
+    LOG(TRACE) << "Buffered objects of event " << event->number << ", " << buffer.size << " objects pending";
+}
+
+void DatabaseWriterModule::flush_buffer() {
+    // Helper to stream all rows of one table via COPY, only a single COPY can be active per connection at any time
+    auto stream_table = [](pqxx::work& transaction, const std::string& table, const auto& columns, auto& rows) {
+        if(rows.empty()) {
+            return;
+        }
+        pqxx::stream_to stream(transaction, table, columns);
+        for(const auto& row : rows) {
+            stream << row;
+        }
+        stream.complete();
+        rows.clear();
+    };
+
+    auto& buffer = buffers_.at(this);
+    LOG(DEBUG) << "Streaming " << buffer.events.size() << " events with " << buffer.size << " objects to database";
+    try {
+        pqxx::work transaction(connection());
+
+        // Tables are streamed in the order of their references to satisfy the foreign key constraints
+        stream_table(transaction, "event", std::vector<std::string>{"event_nr", "run_nr", "eventid"}, buffer.events);
+        stream_table(transaction,
+                     "mctrack",
+                     std::vector<std::string>{"mctrack_nr",
+                                              "run_nr",
+                                              "event_nr",
+                                              "detector",
+                                              "address",
+                                              "parentaddress",
+                                              "particleid",
+                                              "productionprocess",
+                                              "productionvolume",
+                                              "initialpositionx",
+                                              "initialpositiony",
+                                              "initialpositionz",
+                                              "finalpositionx",
+                                              "finalpositiony",
+                                              "finalpositionz",
+                                              "initialtime",
+                                              "finaltime",
+                                              "initialkineticenergy",
+                                              "finalkineticenergy"},
+                     buffer.mctracks);
+        stream_table(transaction,
+                     "mcparticle",
+                     std::vector<std::string>{"mcparticle_nr",
+                                              "run_nr",
+                                              "event_nr",
+                                              "mctrack_nr",
+                                              "detector",
+                                              "address",
+                                              "parentaddress",
+                                              "trackaddress",
+                                              "particleid",
+                                              "localstartpointx",
+                                              "localstartpointy",
+                                              "localstartpointz",
+                                              "localendpointx",
+                                              "localendpointy",
+                                              "localendpointz",
+                                              "globalstartpointx",
+                                              "globalstartpointy",
+                                              "globalstartpointz",
+                                              "globalendpointx",
+                                              "globalendpointy",
+                                              "globalendpointz"},
+                     buffer.mcparticles);
+        stream_table(transaction,
+                     "depositedcharge",
+                     std::vector<std::string>{"depositedcharge_nr",
+                                              "run_nr",
+                                              "event_nr",
+                                              "mcparticle_nr",
+                                              "detector",
+                                              "carriertype",
+                                              "charge",
+                                              "localx",
+                                              "localy",
+                                              "localz",
+                                              "globalx",
+                                              "globaly",
+                                              "globalz"},
+                     buffer.depositedcharges);
+        stream_table(transaction,
+                     "propagatedcharge",
+                     std::vector<std::string>{"propagatedcharge_nr",
+                                              "run_nr",
+                                              "event_nr",
+                                              "depositedcharge_nr",
+                                              "detector",
+                                              "carriertype",
+                                              "charge",
+                                              "localx",
+                                              "localy",
+                                              "localz",
+                                              "globalx",
+                                              "globaly",
+                                              "globalz"},
+                     buffer.propagatedcharges);
+        stream_table(transaction,
+                     "pixelcharge",
+                     std::vector<std::string>{"pixelcharge_nr",
+                                              "run_nr",
+                                              "event_nr",
+                                              "propagatedcharge_nr",
+                                              "detector",
+                                              "charge",
+                                              "x",
+                                              "y",
+                                              "localx",
+                                              "localy",
+                                              "globalx",
+                                              "globaly"},
+                     buffer.pixelcharges);
+        stream_table(transaction,
+                     "pixelhit",
+                     std::vector<std::string>{"pixelhit_nr",
+                                              "run_nr",
+                                              "event_nr",
+                                              "mcparticle_nr",
+                                              "pixelcharge_nr",
+                                              "detector",
+                                              "x",
+                                              "y",
+                                              "signal",
+                                              "hittime"},
+                     buffer.pixelhits);
+
+        transaction.commit();
+        LOG(DEBUG) << "Database transaction completed";
+    } catch(const std::exception& e) {
+        throw ModuleError("SQL error: " + std::string(e.what()));
+    }
+
+    buffer.size = 0;
+    buffer.last_flush = std::chrono::steady_clock::now();
+}
+
 void DatabaseWriterModule::finalizeThread() {
+    // Write all objects still buffered by this thread
+    if(streaming_) {
+        flush_buffer();
+    }
+
 // Disconnecting from database
 #if PQXX_VERSION_MAJOR > 6
-    conn_->close();
+    connection().close();
 #else
-    conn_->disconnect();
+    connection().disconnect();
 #endif
+    connections_.erase(this);
+    buffers_.erase(this);
 }
 
 void DatabaseWriterModule::finalize() {
@@ -10,9 +10,13 @@
  */
 
 #include <atomic>
+#include <chrono>
 #include <fstream>
 #include <map>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/GeometryManager.hpp"
@@ -76,12 +80,145 @@ namespace allpix {
          */
         static void prepare_statements(std::shared_ptr<pqxx::connection> connection);
 
+        /**
+         * @brief Rows of all tables buffered by the current thread for one module instance while operating in streaming mode
+         *
+         * The first element of every row is the primary key of the object, assigned on the client side from blocks of
+         * sequence values reserved from the database.
+         */
+        struct StreamBuffer {
+            std::vector<std::tuple<int, int, int>> events;
+            std::vector<std::tuple<int,
+                                   int,
+                                   int,
+                                   std::string,
+                                   uintptr_t,
+                                   uintptr_t,
+                                   int,
+                                   std::string,
+                                   std::string,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double>>
+                mctracks;
+            std::vector<std::tuple<int,
+                                   int,
+                                   int,
+                                   std::optional<int>,
+                                   std::string,
+                                   uintptr_t,
+                                   uintptr_t,
+                                   uintptr_t,
+                                   int,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double>>
+                mcparticles;
+            std::vector<std::tuple<int,
+                                   int,
+                                   int,
+                                   std::optional<int>,
+                                   std::string,
+                                   int,
+                                   unsigned int,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double>>
+                depositedcharges;
+            std::vector<std::tuple<int,
+                                   int,
+                                   int,
+                                   std::optional<int>,
+                                   std::string,
+                                   int,
+                                   unsigned int,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double,
+                                   double>>
+                propagatedcharges;
+            std::vector<std::tuple<int,
+                                   int,
+                                   int,
+                                   std::optional<int>,
+                                   std::string,
+                                   long,
+                                   int,
+                                   int,
+                                   double,
+                                   double,
+                                   double,
+                                   double>>
+                pixelcharges;
+            std::vector<
+                std::tuple<int, int, int, std::optional<int>, std::optional<int>, std::string, int, int, double, double>>
+                pixelhits;
+
+            // Number of buffered objects and time of the last flush to the database
+            size_t size{};
+            std::chrono::steady_clock::time_point last_flush{std::chrono::steady_clock::now()};
+
+            // Primary keys reserved from the database sequences but not yet assigned, per table
+            std::map<std::string, std::vector<int>> reserved_ids;
+        };
+
+        /**
+         * @brief Take the next client-side primary key for the given table, reserving a new block from the database sequence
+         * if necessary
+         * @param buffer Stream buffer of this module instance on the current thread
+         * @param table Name of the database table
+         * @param column Name of the serial primary key column of the table
+         * @return Unique primary key for a new row of this table
+         */
+        int next_id(StreamBuffer& buffer, const std::string& table, const std::string& column);
+
+        /**
+         * @brief Convert all objects of an event to rows and append them to the stream buffer of this instance on the
+         * current thread
+         * @param event Event the objects belong to
+         * @param messages Messages of this event accepted by the filter
+         */
+        void buffer_event(Event* event, const std::vector<std::pair<std::shared_ptr<BaseMessage>, std::string>>& messages);
+
+        /**
+         * @brief Stream all rows buffered for this instance by the current thread to the database using COPY and commit them
+         * in a single transaction
+         */
+        void flush_buffer();
+
         // Object names to include or exclude from writing
         std::set<std::string> include_;
         std::set<std::string> exclude_;
 
-        // postgreSQL objects
-        static thread_local std::shared_ptr<pqxx::connection> conn_;
+        /**
+         * @brief Get the database connection of this module instance on the current thread
+         * @return Reference to the connection
+         */
+        pqxx::connection& connection() const { return *connections_.at(this); }
+
+        // postgreSQL objects, one connection per module instance and thread
+        static thread_local std::map<const DatabaseWriterModule*, std::shared_ptr<pqxx::connection>> connections_;
         std::string host_;
         std::string port_;
         std::string database_name_;
@@ -91,6 +228,13 @@ namespace allpix {
         int run_nr_{0};
         bool timing_global_{};
 
+        // Streaming mode using client-side IDs and COPY statements, buffered per module instance and thread
+        static thread_local std::map<const DatabaseWriterModule*, StreamBuffer> buffers_;
+        bool streaming_{};
+        size_t id_block_size_{};
+        size_t batch_size_{};
+        std::chrono::steady_clock::duration batch_interval_{};
+
         // Statistical information about number of objects
         std::atomic<unsigned long> write_cnt_{};
         std::atomic<unsigned long> msg_cnt_{};
@@ -13,6 +13,8 @@
 #include "DepositionCosmicsModule.hpp"
 #include "RNGWrapper.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <memory>
 #include <regex>
@@ -29,6 +31,16 @@ using namespace allpix;
 CosmicsGeneratorActionG4::CosmicsGeneratorActionG4(const Configuration& config)
     : particle_gun_(std::make_unique<G4ParticleGun>()), config_(config) {
 
+    // Parse other configuration parameters:
+    reset_particle_time_ = config_.get<bool>("reset_particle_time");
+
+    // Showers are drawn from the library if available, no CRY setup is required
+    shower_library_ = DepositionCosmicsModule::shower_library_;
+    if(shower_library_ != nullptr) {
+        LOG(DEBUG) << "Using shower library with " << shower_library_->size() << " showers";
+        return;
+    }
+
     LOG(DEBUG) << "Setting up CRY generator";
     LOG(DEBUG) << "CRY configuration: " << config_.get<std::string>("_cry_config");
     LOG(DEBUG) << "CRY data: " << config_.get<std::string>("data_path");
@@ -39,15 +51,16 @@ CosmicsGeneratorActionG4::CosmicsGeneratorActionG4(const Configuration& config)
     LOG(DEBUG) << "Configuring CRY random engine to use Geant4's event-seeded engine";
     RNGWrapper<CLHEP::HepRandomEngine>::set(CLHEP::HepRandom::getTheEngine(), &CLHEP::HepRandomEngine::flat);
     setup->setRandomFunction(RNGWrapper<CLHEP::HepRandomEngine>::rng);
-
-    // Parse other configuration parameters:
-    reset_particle_time_ = config_.get<bool>("reset_particle_time");
 }
 
 /**
  * Called automatically for every event
  */
 void CosmicsGeneratorActionG4::GeneratePrimaries(G4Event* event) {
+    if(shower_library_ != nullptr) {
+        generate_from_library(event);
+        return;
+    }
 
     // Let CRY generate the particles
     std::vector<CRYParticle*> vect;
@@ -88,3 +101,63 @@ void CosmicsGeneratorActionG4::GeneratePrimaries(G4Event* event) {
                    << " t=" << Units::display(Units::get(time, "s"), {"ns", "us", "ms"});
     }
 }
+
+/**
+ * Showers are drawn uniformly from the library using the per-event seeded Geant4 engine. Every shower is rotated by a random
+ * angle around the z axis and translated by a random offset in the x-y plane. Particles leaving the area are wrapped around
+ * periodically, which preserves the uniform incidence of the showers on the area.
+ */
+void CosmicsGeneratorActionG4::generate_from_library(G4Event* event) {
+    auto* engine = CLHEP::HepRandom::getTheEngine();
+    auto index = std::min(static_cast<size_t>(engine->flat() * static_cast<double>(shower_library_->size())),
+                          shower_library_->size() - 1);
+    auto angle = 2. * CLHEP::pi * engine->flat();
+    auto side_length = shower_library_->getSideLength();
+    auto offset_x = (engine->flat() - 0.5) * side_length;
+    auto offset_y = (engine->flat() - 0.5) * side_length;
+
+    const auto& shower = shower_library_->getShower(index);
+    LOG(DEBUG) << "Drawing shower " << index << " with " << shower.size() << " particles from library, rotated by "
+               << Units::display(angle, {"deg"});
+
+    // Accumulate the average time simulated by CRY per shower in the framework base units
+    DepositionCosmicsModule::cry_instance_time_simulated_ += shower_library_->getTimePerShower() * 1e9;
+
+    auto wrap = [side_length](double coordinate) {
+        return coordinate - side_length * std::floor((coordinate + side_length / 2) / side_length);
+    };
+    auto cos_angle = std::cos(angle);
+    auto sin_angle = std::sin(angle);
+
+    // Event time frame starts with first particle arriving
+    double event_starting_time = std::numeric_limits<double>::max();
+    if(!reset_particle_time_) {
+        for(const auto& particle : shower) {
+            event_starting_time = std::min(event_starting_time, particle.time);
+        }
+    }
+
+    auto* pdg_table = G4ParticleTable::GetParticleTable();
+    for(const auto& particle : shower) {
+        const auto& [x, y, z] = particle.position;
+        const auto& [u, v, w] = particle.direction;
+        auto position = G4ThreeVector(
+            wrap(cos_angle * x - sin_angle * y + offset_x), wrap(sin_angle * x + cos_angle * y + offset_y), z);
+        auto direction = G4ThreeVector(cos_angle * u - sin_angle * v, sin_angle * u + cos_angle * v, w);
+
+        particle_gun_->SetParticleDefinition(pdg_table->FindParticle(particle.pdg_code));
+        particle_gun_->SetParticleEnergy(particle.kinetic_energy * CLHEP::MeV);
+        particle_gun_->SetParticlePosition(position * CLHEP::m);
+        particle_gun_->SetParticleMomentumDirection(direction);
+
+        double time = (reset_particle_time_ ? 0. : particle.time - event_starting_time);
+        particle_gun_->SetParticleTime(time);
+        particle_gun_->GeneratePrimaryVertex(event);
+
+        LOG(DEBUG) << "  " << CRYUtils::partName(static_cast<CRYParticle::CRYId>(particle.cry_id))
+                   << ": charge=" << particle.charge << std::setprecision(4)
+                   << " energy=" << Units::display(particle.kinetic_energy, {"MeV", "GeV"})
+                   << " pos=" << Units::display(position * 1e3, {"m"}) << " dir. cos=" << direction
+                   << " t=" << Units::display(Units::get(time, "s"), {"ns", "us", "ms"});
+    }
+}
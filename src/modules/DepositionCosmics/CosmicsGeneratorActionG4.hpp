@@ -26,6 +26,8 @@
 
 #include "core/config/Configuration.hpp"
 
+#include "ShowerLibrary.hpp"
+
 namespace allpix {
     /**
      * @brief Generates the particles in every event
@@ -44,8 +46,15 @@ namespace allpix {
         void GeneratePrimaries(G4Event*) override;
 
     private:
+        /**
+         * @brief Generate the particles of a shower drawn from the shower library
+         * @param event Geant4 event to add the primary vertices to
+         */
+        void generate_from_library(G4Event* event);
+
         std::unique_ptr<G4ParticleGun> particle_gun_;
         std::unique_ptr<CRYGenerator> cry_generator_;
+        std::shared_ptr<const ShowerLibrary> shower_library_;
 
         bool reset_particle_time_{};
         const Configuration& config_;
@@ -11,6 +11,7 @@
 
 #include "DepositionCosmicsModule.hpp"
 #include "CosmicsGeneratorActionG4.hpp"
+#include "ShowerLibrary.hpp"
 
 #include "tools/geant4/MTRunManager.hpp"
 #include "tools/geant4/RunManager.hpp"
@@ -28,6 +29,7 @@
 using namespace allpix;
 
 thread_local double DepositionCosmicsModule::cry_instance_time_simulated_ = 0;
+std::shared_ptr<const ShowerLibrary> DepositionCosmicsModule::shower_library_ = nullptr;
 
 DepositionCosmicsModule::DepositionCosmicsModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
     : DepositionGeant4Module(config, messenger, geo_manager) {
@@ -49,6 +51,7 @@ DepositionCosmicsModule::DepositionCosmicsModule(Configuration& config, Messenge
     config_.setDefault("latitude", 53.0);
     config_.setDefault("date", "12-31-2020");
     config_.setDefault("reset_particle_time", false);
+    config_.setDefault("shower_library_size", 10000);
 
     // Force source type and position:
     config_.set("source_type", "cosmics");
@@ -123,6 +126,7 @@ DepositionCosmicsModule::DepositionCosmicsModule(Configuration& config, Messenge
         LOG(DEBUG) << "Maximum side length (in x,y): " << Units::display(size, {"mm", "cm", "m"})
                    << ", selecting subbox of size " << size_meters << "m";
         cry_config << " subboxLength " << size_meters;
+        subbox_length_ = size_meters;
     } else {
         auto area = Units::convert(config_.get<int>("area"), "m");
         if(area > 300) {
@@ -130,6 +134,7 @@ DepositionCosmicsModule::DepositionCosmicsModule(Configuration& config, Messenge
         }
         LOG(DEBUG) << "Configuring subbox of size " << area << "m from configuration parameter";
         cry_config << " subboxLength " << area;
+        subbox_length_ = area;
     }
 
     auto latitude = config_.get<double>("latitude");
@@ -143,6 +148,35 @@ DepositionCosmicsModule::DepositionCosmicsModule(Configuration& config, Messenge
     config_.set<std::string>("_cry_config", cry_config.str());
 }
 
+void DepositionCosmicsModule::initialize() {
+    // Load or generate the shower library before the generator actions are constructed
+    if(config_.has("shower_library")) {
+        auto library_file = config_.getPath("shower_library");
+        auto library_size = config_.get<size_t>("shower_library_size");
+        if(library_size == 0) {
+            throw InvalidValueError(config_, "shower_library_size", "library needs to hold at least one shower");
+        }
+        auto key = config_.get<std::string>("_cry_config") + " librarySize " + std::to_string(library_size);
+
+        auto library = std::make_shared<ShowerLibrary>();
+        if(!library->load(library_file, key)) {
+            LOG(STATUS) << "Generating library of " << library_size << " showers with CRY";
+            auto seed = getConfigManager()->getGlobalConfiguration().get<uint64_t>("random_seed");
+            library->generate(config_.get<std::string>("_cry_config"),
+                              config_.get<std::string>("data_path"),
+                              subbox_length_,
+                              library_size,
+                              seed);
+            library->save(library_file, key);
+        }
+        LOG(INFO) << "Drawing showers from library " << library_file << " holding " << library->size() << " showers";
+        shower_library_ = std::move(library);
+    }
+
+    // Call base class initialization:
+    DepositionGeant4Module::initialize();
+}
+
 void DepositionCosmicsModule::initialize_g4_action() {
     auto* action_initialization =
         new ActionInitializationG4<CosmicsGeneratorActionG4, GeneratorActionInitializationMaster>(config_);
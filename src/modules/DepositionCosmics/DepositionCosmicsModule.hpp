@@ -13,7 +13,9 @@
 #define ALLPIX_COSMICS_DEPOSITION_MODULE_H
 
 #include "../DepositionGeant4/DepositionGeant4Module.hpp"
+#include "ShowerLibrary.hpp"
 
+#include <memory>
 #include <mutex>
 
 namespace allpix {
@@ -38,6 +40,11 @@ namespace allpix {
          */
         DepositionCosmicsModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager);
 
+        /**
+         * @brief Load or generate the shower library if requested, and initialize the Geant4 simulation
+         */
+        void initialize() override;
+
         /**
          * @brief Cleanup \ref RunManager for each thread
          */
@@ -52,6 +59,11 @@ namespace allpix {
         void initialize_g4_action() override;
 
         static thread_local double cry_instance_time_simulated_;
+
+        // Library of pre-generated showers, shared read-only by the generator actions of all threads
+        static std::shared_ptr<const ShowerLibrary> shower_library_;
+        double subbox_length_{};
+
         std::mutex stats_mutex_;
         double total_time_simulated_{};
     };
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief Implements the library of pre-generated CRY showers
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ShowerLibrary.hpp"
+#include "RNGWrapper.hpp"
+
+#include <fstream>
+#include <memory>
+
+#include <CLHEP/Random/MixMaxRng.h>
+#include <CRYGenerator.h>
+#include <CRYParticle.h>
+#include <CRYSetup.h>
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "core/module/exceptions.h"
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+// Identifier and format version of shower library files
+static const std::string library_file_identifier = "Allpix Squared CRY shower library";
+static const unsigned int library_file_version = 1;
+
+bool ShowerLibrary::load(const std::filesystem::path& file_name, const std::string& key) {
+    if(!std::filesystem::exists(file_name)) {
+        LOG(INFO) << "No shower library found at " << file_name;
+        return false;
+    }
+
+    std::ifstream file(file_name, std::ios::binary);
+    try {
+        cereal::PortableBinaryInputArchive archive(file);
+
+        std::string identifier;
+        unsigned int version = 0;
+        std::string file_key;
+        archive(identifier, version, file_key);
+        if(identifier != library_file_identifier || version != library_file_version) {
+            LOG(WARNING) << "File " << file_name << " is not a shower library of the current version, ignoring it";
+            return false;
+        }
+        if(file_key != key) {
+            LOG(INFO) << "Shower library " << file_name << " has been generated with different settings";
+            LOG(DEBUG) << "Library settings: " << file_key << std::endl << "Current settings: " << key;
+            return false;
+        }
+
+        archive(side_length_, time_simulated_, showers_);
+    } catch(cereal::Exception& e) {
+        LOG(WARNING) << "Shower library " << file_name << " is incomplete, ignoring it: " << e.what();
+        showers_.clear();
+        return false;
+    }
+
+    LOG(DEBUG) << "Loaded shower library " << file_name << " holding " << showers_.size() << " showers";
+    return !showers_.empty();
+}
+
+void ShowerLibrary::generate(
+    const std::string& cry_config, const std::string& data_path, double side_length, size_t size, uint64_t seed) {
+    side_length_ = side_length;
+    time_simulated_ = 0;
+    showers_.clear();
+    showers_.reserve(size);
+
+    // CRY draws from a dedicated engine, the per-event Geant4 engine is not available during initialization
+    CLHEP::MixMaxRng engine(static_cast<long>(seed));
+    RNGWrapper<CLHEP::HepRandomEngine>::set(&engine, &CLHEP::HepRandomEngine::flat);
+
+    auto setup = std::make_unique<CRYSetup>(cry_config, data_path);
+    setup->setRandomFunction(RNGWrapper<CLHEP::HepRandomEngine>::rng);
+    CRYGenerator generator(setup.get());
+
+    std::vector<CRYParticle*> particles;
+    for(size_t i = 0; i < size; ++i) {
+        particles.clear();
+        generator.genEvent(&particles);
+
+        Shower shower;
+        shower.reserve(particles.size());
+        for(auto* particle : particles) {
+            shower.push_back({static_cast<int>(particle->id()),
+                              particle->PDGid(),
+                              particle->charge(),
+                              particle->ke(),
+                              {particle->x(), particle->y(), particle->z()},
+                              {particle->u(), particle->v(), particle->w()},
+                              particle->t()});
+            delete particle;
+        }
+        showers_.push_back(std::move(shower));
+
+        if((i + 1) % 1000 == 0) {
+            LOG_PROGRESS(STATUS, "shower_library") << "Generated " << (i + 1) << " of " << size << " showers";
+        }
+    }
+    time_simulated_ = generator.timeSimulated();
+
+    // Reset the wrapper, the engine goes out of scope
+    RNGWrapper<CLHEP::HepRandomEngine>::set(CLHEP::HepRandom::getTheEngine(), &CLHEP::HepRandomEngine::flat);
+}
+
+void ShowerLibrary::save(const std::filesystem::path& file_name, const std::string& key) const {
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if(!file.good()) {
+        throw ModuleError("Could not create shower library file " + file_name.string());
+    }
+
+    cereal::PortableBinaryOutputArchive archive(file);
+    archive(library_file_identifier, library_file_version, key, side_length_, time_simulated_, showers_);
+    LOG(STATUS) << "Stored " << showers_.size() << " showers in library " << file_name;
+}
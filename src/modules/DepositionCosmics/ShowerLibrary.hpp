@@ -0,0 +1,111 @@
+/**
+ * @file
+ * @brief Defines the library of pre-generated CRY showers
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_COSMICS_DEPOSITION_MODULE_SHOWER_LIBRARY_H
+#define ALLPIX_COSMICS_DEPOSITION_MODULE_SHOWER_LIBRARY_H
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace allpix {
+    /**
+     * @brief Library of cosmic ray showers generated by CRY, stored in a binary file for reuse
+     *
+     * Generating showers with CRY for large areas is expensive. The library samples a fixed number of showers once for a
+     * given CRY configuration and stores them with the cereal library, such that subsequent runs only draw showers from
+     * the library. All quantities are stored in the units used by CRY, i.e. meters, MeV and seconds.
+     */
+    class ShowerLibrary {
+    public:
+        /**
+         * @brief Single particle of a shower
+         */
+        struct Particle {
+            int cry_id{};
+            int pdg_code{};
+            int charge{};
+            double kinetic_energy{};
+            std::array<double, 3> position{};
+            std::array<double, 3> direction{};
+            double time{};
+
+            template <class Archive> void serialize(Archive& archive) {
+                archive(cry_id, pdg_code, charge, kinetic_energy, position, direction, time);
+            }
+        };
+
+        using Shower = std::vector<Particle>;
+
+        /**
+         * @brief Load a library from file
+         * @param file_name Path of the library file
+         * @param key Description of the CRY configuration the library needs to have been generated with
+         * @return True if a library generated with identical settings has been loaded, false otherwise
+         */
+        bool load(const std::filesystem::path& file_name, const std::string& key);
+
+        /**
+         * @brief Generate a new library with CRY
+         * @param cry_config Configuration string passed to CRY
+         * @param data_path Directory with the tabulated CRY data
+         * @param side_length Side length of the area the showers are generated for, in meters
+         * @param size Number of showers to generate
+         * @param seed Seed of the random number generator used for the generation
+         */
+        void generate(const std::string& cry_config,
+                      const std::string& data_path,
+                      double side_length,
+                      size_t size,
+                      uint64_t seed);
+
+        /**
+         * @brief Write the library to file
+         * @param file_name Path of the library file
+         * @param key Description of the CRY configuration the library has been generated with
+         */
+        void save(const std::filesystem::path& file_name, const std::string& key) const;
+
+        /**
+         * @brief Get the number of showers in the library
+         * @return Number of showers
+         */
+        size_t size() const { return showers_.size(); }
+
+        /**
+         * @brief Get a shower from the library
+         * @param index Index of the shower
+         * @return Particles of the shower
+         */
+        const Shower& getShower(size_t index) const { return showers_.at(index); }
+
+        /**
+         * @brief Get the side length of the area the showers have been generated for
+         * @return Side length in meters
+         */
+        double getSideLength() const { return side_length_; }
+
+        /**
+         * @brief Get the average time simulated by CRY per shower
+         * @return Time per shower in seconds
+         */
+        double getTimePerShower() const { return showers_.empty() ? 0. : time_simulated_ / static_cast<double>(size()); }
+
+    private:
+        std::vector<Shower> showers_;
+        double side_length_{};
+        double time_simulated_{};
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_COSMICS_DEPOSITION_MODULE_SHOWER_LIBRARY_H */
@@ -0,0 +1,403 @@
+/**
+ * @file
+ * @brief Implements the persistent cache of Monte Carlo truth and charge deposits
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "DepositCache.hpp"
+
+#include <algorithm>
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "core/module/exceptions.h"
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+// Identifier and format version of cache files
+static const std::string cache_file_identifier = "Allpix Squared deposit cache";
+static const unsigned int cache_file_version = 1;
+
+// Size of the trailing archive holding the index offset: endianness flag and offset
+static const std::streamoff cache_footer_size = sizeof(uint8_t) + sizeof(uint64_t);
+
+static std::array<double, 3> to_array(const ROOT::Math::XYZPoint& point) {
+    return {point.x(), point.y(), point.z()};
+}
+
+static ROOT::Math::XYZPoint to_point(const std::array<double, 3>& array) {
+    return {array[0], array[1], array[2]};
+}
+
+/**
+ * Returns the index of an object within the vector it is stored in, or -1 if the pointer does not refer to this vector
+ */
+template <typename T> static long index_of(const T* object, const std::vector<T>& objects) {
+    if(object == nullptr || object < objects.data() || object >= objects.data() + objects.size()) {
+        return -1;
+    }
+    return static_cast<long>(object - objects.data());
+}
+
+bool DepositCache::open(const std::filesystem::path& file_name, const std::string& key) {
+    file_name_ = file_name;
+    if(!std::filesystem::exists(file_name)) {
+        LOG(INFO) << "No deposit cache found at " << file_name;
+        return false;
+    }
+
+    file_.open(file_name, std::ios::in | std::ios::binary);
+    try {
+        std::string identifier;
+        unsigned int version = 0;
+        std::string file_key;
+        {
+            cereal::PortableBinaryInputArchive archive(file_);
+            archive(identifier, version, file_key);
+        }
+        if(identifier != cache_file_identifier || version != cache_file_version) {
+            LOG(WARNING) << "File " << file_name << " is not a deposit cache of the current version, ignoring it";
+            file_.close();
+            return false;
+        }
+        if(file_key != key) {
+            LOG(INFO) << "Deposit cache " << file_name << " has been created with different settings";
+            LOG(DEBUG) << "Cached settings:" << std::endl << file_key << "Current settings:" << std::endl << key;
+            file_.close();
+            return false;
+        }
+
+        // Read the offset of the index from the end of the file and load the index
+        uint64_t index_offset = 0;
+        file_.seekg(-cache_footer_size, std::ios::end);
+        {
+            cereal::PortableBinaryInputArchive archive(file_);
+            archive(index_offset);
+        }
+        file_.seekg(static_cast<std::streamoff>(index_offset));
+        {
+            cereal::PortableBinaryInputArchive archive(file_);
+            archive(index_);
+        }
+    } catch(cereal::Exception& e) {
+        LOG(WARNING) << "Deposit cache " << file_name << " is incomplete, ignoring it: " << e.what();
+        file_.close();
+        index_.clear();
+        return false;
+    }
+
+    reading_ = true;
+    LOG(DEBUG) << "Opened deposit cache " << file_name << " holding " << index_.size() << " events";
+    return true;
+}
+
+void DepositCache::create(const std::filesystem::path& file_name, const std::string& key) {
+    file_name_ = file_name;
+    reading_ = false;
+    index_.clear();
+
+    // Close a previously opened cache which could not be used
+    if(file_.is_open()) {
+        file_.close();
+    }
+
+    file_.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!file_.good()) {
+        throw ModuleError("Could not create deposit cache file " + file_name.string());
+    }
+
+    cereal::PortableBinaryOutputArchive archive(file_);
+    archive(cache_file_identifier, cache_file_version, key);
+}
+
+DepositCache::EventRecord DepositCache::makeRecord(const std::shared_ptr<MCTrackMessage>& track_message,
+                                                   const std::vector<SensorMessages>& sensor_messages) {
+    EventRecord record;
+
+    const auto& tracks = track_message->getData();
+    record.tracks.reserve(tracks.size());
+    for(const auto& track : tracks) {
+        TrackRecord track_record;
+        track_record.start = to_array(track.getStartPoint());
+        track_record.end = to_array(track.getEndPoint());
+        track_record.volume_start = track.getOriginatingVolumeName();
+        track_record.volume_end = track.getTerminatingVolumeName();
+        track_record.process_name = track.getCreationProcessName();
+        track_record.process_type = track.getCreationProcessType();
+        track_record.particle_id = track.getParticleID();
+        track_record.start_time = track.getGlobalStartTime();
+        track_record.end_time = track.getGlobalEndTime();
+        track_record.kinetic_energy_initial = track.getKineticEnergyInitial();
+        track_record.kinetic_energy_final = track.getKineticEnergyFinal();
+        track_record.total_energy_initial = track.getTotalEnergyInitial();
+        track_record.total_energy_final = track.getTotalEnergyFinal();
+        track_record.parent = index_of(track.getParent(), tracks);
+        record.tracks.push_back(std::move(track_record));
+    }
+
+    for(const auto& [particle_message, deposit_message] : sensor_messages) {
+        SensorRecord sensor_record;
+        sensor_record.detector = particle_message->getDetector()->getName();
+
+        const auto& particles = particle_message->getData();
+        sensor_record.particles.reserve(particles.size());
+        for(const auto& particle : particles) {
+            ParticleRecord particle_record;
+            particle_record.local_start = to_array(particle.getLocalStartPoint());
+            particle_record.global_start = to_array(particle.getGlobalStartPoint());
+            particle_record.local_end = to_array(particle.getLocalEndPoint());
+            particle_record.global_end = to_array(particle.getGlobalEndPoint());
+            particle_record.particle_id = particle.getParticleID();
+            particle_record.local_time = particle.getLocalTime();
+            particle_record.global_time = particle.getGlobalTime();
+            particle_record.charge = particle.getTotalDepositedCharge();
+            particle_record.track = index_of(particle.getTrack(), tracks);
+            particle_record.parent = index_of(particle.getParent(), particles);
+            sensor_record.particles.push_back(particle_record);
+        }
+
+        if(deposit_message != nullptr) {
+            const auto& deposits = deposit_message->getData();
+            sensor_record.deposits.reserve(deposits.size());
+            for(const auto& deposit : deposits) {
+                DepositRecord deposit_record;
+                deposit_record.local_position = to_array(deposit.getLocalPosition());
+                deposit_record.global_position = to_array(deposit.getGlobalPosition());
+                deposit_record.type = static_cast<int>(deposit.getType());
+                deposit_record.charge = deposit.getCharge();
+                deposit_record.local_time = deposit.getLocalTime();
+                deposit_record.global_time = deposit.getGlobalTime();
+                deposit_record.particle = index_of(deposit.getMCParticle(), particles);
+                sensor_record.deposits.push_back(deposit_record);
+            }
+        }
+        record.sensors.push_back(std::move(sensor_record));
+    }
+
+    return record;
+}
+
+DepositCache::EventRecord DepositCache::mergeRecords(std::vector<EventRecord> records) {
+    EventRecord merged;
+
+    // Sensors are merged by detector name, keeping the order in which they appear first
+    std::map<std::string, size_t> sensor_index;
+    for(auto& record : records) {
+        auto track_offset = static_cast<long>(merged.tracks.size());
+        for(auto& track : record.tracks) {
+            if(track.parent >= 0) {
+                track.parent += track_offset;
+            }
+            merged.tracks.push_back(std::move(track));
+        }
+
+        for(auto& sensor : record.sensors) {
+            auto [iter, inserted] = sensor_index.emplace(sensor.detector, merged.sensors.size());
+            if(inserted) {
+                merged.sensors.emplace_back();
+                merged.sensors.back().detector = sensor.detector;
+            }
+            auto& merged_sensor = merged.sensors[iter->second];
+
+            auto particle_offset = static_cast<long>(merged_sensor.particles.size());
+            for(auto& particle : sensor.particles) {
+                if(particle.track >= 0) {
+                    particle.track += track_offset;
+                }
+                if(particle.parent >= 0) {
+                    particle.parent += particle_offset;
+                }
+                merged_sensor.particles.push_back(particle);
+            }
+            for(auto& deposit : sensor.deposits) {
+                if(deposit.particle >= 0) {
+                    deposit.particle += particle_offset;
+                }
+                merged_sensor.deposits.push_back(deposit);
+            }
+        }
+    }
+
+    // Local times refer to the earliest particle in the sensor, which may stem from any of the merged records
+    for(auto& sensor : merged.sensors) {
+        if(sensor.particles.empty()) {
+            continue;
+        }
+        auto time_reference = std::min_element(sensor.particles.begin(),
+                                               sensor.particles.end(),
+                                               [](const auto& lhs, const auto& rhs) {
+                                                   return lhs.global_time < rhs.global_time;
+                                               })
+                                  ->global_time;
+        for(auto& particle : sensor.particles) {
+            particle.local_time = particle.global_time - time_reference;
+        }
+        for(auto& deposit : sensor.deposits) {
+            deposit.local_time = deposit.global_time - time_reference;
+        }
+    }
+
+    return merged;
+}
+
+void DepositCache::storeAborted(const Event* event, const std::string& reason) {
+    EventRecord record;
+    record.number = event->number;
+    record.seed = event->getSeed();
+    record.abort_reason = reason;
+    store(record);
+}
+
+void DepositCache::store(const EventRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto offset = static_cast<uint64_t>(file_.tellp());
+    {
+        cereal::PortableBinaryOutputArchive archive(file_);
+        archive(record);
+    }
+    index_[record.number] = offset;
+    LOG(TRACE) << "Stored event " << record.number << " in deposit cache at offset " << offset;
+}
+
+unsigned int DepositCache::dispatch(Module* module, Messenger* messenger, GeometryManager* geo_manager, Event* event) {
+    EventRecord record;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_.seekg(static_cast<std::streamoff>(index_.at(event->number)));
+        try {
+            cereal::PortableBinaryInputArchive archive(file_);
+            archive(record);
+        } catch(cereal::Exception& e) {
+            throw ModuleError("Could not read event " + std::to_string(event->number) + " from deposit cache " +
+                              file_name_.string() + ": " + e.what());
+        }
+    }
+
+    // Events are seeded in order, a different seed means that the cache does not belong to this run
+    if(record.number != event->number || record.seed != event->getSeed()) {
+        throw ModuleError("Event " + std::to_string(event->number) + " in deposit cache " + file_name_.string() +
+                          " has been simulated with a different seed");
+    }
+    if(!record.abort_reason.empty()) {
+        throw AbortEventException(record.abort_reason);
+    }
+
+    return dispatchRecord(record, module, messenger, geo_manager, event);
+}
+
+unsigned int DepositCache::dispatchRecord(
+    const EventRecord& record, Module* module, Messenger* messenger, GeometryManager* geo_manager, Event* event) {
+    // Create the Monte Carlo tracks, linking parents before moving them into the message does not relocate them
+    std::vector<MCTrack> tracks;
+    tracks.reserve(record.tracks.size());
+    for(const auto& track : record.tracks) {
+        tracks.emplace_back(to_point(track.start),
+                            to_point(track.end),
+                            track.volume_start,
+                            track.volume_end,
+                            track.process_name,
+                            track.process_type,
+                            track.particle_id,
+                            track.start_time,
+                            track.end_time,
+                            track.kinetic_energy_initial,
+                            track.kinetic_energy_final,
+                            track.total_energy_initial,
+                            track.total_energy_final);
+    }
+    for(size_t i = 0; i < record.tracks.size(); ++i) {
+        if(record.tracks[i].parent >= 0) {
+            tracks[i].setParent(&tracks.at(static_cast<size_t>(record.tracks[i].parent)));
+        }
+    }
+    auto track_message = std::make_shared<MCTrackMessage>(std::move(tracks));
+    const auto& track_data = track_message->getData();
+    messenger->dispatchMessage(module, track_message, event);
+
+    unsigned int total_charges = 0;
+    for(const auto& sensor : record.sensors) {
+        auto detector = geo_manager->getDetector(sensor.detector);
+
+        std::vector<MCParticle> particles;
+        particles.reserve(sensor.particles.size());
+        for(const auto& particle : sensor.particles) {
+            particles.emplace_back(to_point(particle.local_start),
+                                   to_point(particle.global_start),
+                                   to_point(particle.local_end),
+                                   to_point(particle.global_end),
+                                   particle.particle_id,
+                                   particle.local_time,
+                                   particle.global_time);
+            particles.back().setTotalDepositedCharge(particle.charge);
+            if(particle.track >= 0) {
+                particles.back().setTrack(&track_data.at(static_cast<size_t>(particle.track)));
+            }
+        }
+        for(size_t i = 0; i < sensor.particles.size(); ++i) {
+            if(sensor.particles[i].parent >= 0) {
+                particles[i].setParent(&particles.at(static_cast<size_t>(sensor.particles[i].parent)));
+            }
+        }
+        auto particle_message = std::make_shared<MCParticleMessage>(std::move(particles), detector);
+        const auto& particle_data = particle_message->getData();
+        messenger->dispatchMessage(module, particle_message, event);
+
+        if(sensor.deposits.empty()) {
+            continue;
+        }
+
+        unsigned int charges = 0;
+        std::vector<DepositedCharge> deposits;
+        deposits.reserve(sensor.deposits.size());
+        for(const auto& deposit : sensor.deposits) {
+            deposits.emplace_back(to_point(deposit.local_position),
+                                  to_point(deposit.global_position),
+                                  static_cast<CarrierType>(deposit.type),
+                                  deposit.charge,
+                                  deposit.local_time,
+                                  deposit.global_time,
+                                  deposit.particle >= 0 ? &particle_data.at(static_cast<size_t>(deposit.particle))
+                                                        : nullptr);
+            charges += deposit.charge;
+        }
+        total_charges += charges;
+
+        LOG(INFO) << "Deposited " << charges << " charges in sensor of detector " << sensor.detector;
+        messenger->dispatchMessage(module, std::make_shared<DepositedChargeMessage>(std::move(deposits), detector), event);
+    }
+
+    return total_charges;
+}
+
+void DepositCache::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(!file_.is_open()) {
+        return;
+    }
+
+    if(!reading_) {
+        // Append the index and its offset, completing the cache file
+        auto index_offset = static_cast<uint64_t>(file_.tellp());
+        {
+            cereal::PortableBinaryOutputArchive archive(file_);
+            archive(index_);
+        }
+        {
+            cereal::PortableBinaryOutputArchive archive(file_);
+            archive(index_offset);
+        }
+        LOG(STATUS) << "Stored " << index_.size() << " events in deposit cache " << file_name_;
+    }
+    file_.close();
+}
@@ -0,0 +1,258 @@
+/**
+ * @file
+ * @brief Defines the persistent cache of Monte Carlo truth and charge deposits
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_DEPOSITION_MODULE_DEPOSIT_CACHE_H
+#define ALLPIX_DEPOSITION_MODULE_DEPOSIT_CACHE_H
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/geometry/GeometryManager.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Event.hpp"
+#include "core/module/Module.hpp"
+
+#include "objects/DepositedCharge.hpp"
+#include "objects/MCParticle.hpp"
+#include "objects/MCTrack.hpp"
+
+namespace allpix {
+    /**
+     * @brief Persistent store for the Monte Carlo truth and charge deposits produced by the Geant4 simulation
+     *
+     * The cache is a binary file serialized with the cereal library. It starts with a header describing all settings that
+     * influence the Geant4 simulation, followed by one record per event holding the MCTrack, MCParticle and DepositedCharge
+     * objects. References between objects are stored as indices. The file ends with an index mapping event numbers to the
+     * offsets of their records, such that events can be read in arbitrary order as required for multithreaded processing.
+     */
+    class DepositCache {
+    public:
+        using SensorMessages = std::pair<std::shared_ptr<MCParticleMessage>, std::shared_ptr<DepositedChargeMessage>>;
+
+        using Point = std::array<double, 3>;
+
+        /**
+         * @brief Monte Carlo track, referencing its parent by index
+         */
+        struct TrackRecord {
+            Point start;
+            Point end;
+            std::string volume_start;
+            std::string volume_end;
+            std::string process_name;
+            int process_type{};
+            int particle_id{};
+            double start_time{};
+            double end_time{};
+            double kinetic_energy_initial{};
+            double kinetic_energy_final{};
+            double total_energy_initial{};
+            double total_energy_final{};
+            long parent{-1};
+
+            template <class Archive> void serialize(Archive& archive) {
+                archive(start,
+                        end,
+                        volume_start,
+                        volume_end,
+                        process_name,
+                        process_type,
+                        particle_id,
+                        start_time,
+                        end_time,
+                        kinetic_energy_initial,
+                        kinetic_energy_final,
+                        total_energy_initial,
+                        total_energy_final,
+                        parent);
+            }
+        };
+
+        /**
+         * @brief Monte Carlo particle, referencing its track and parent by index
+         */
+        struct ParticleRecord {
+            Point local_start;
+            Point global_start;
+            Point local_end;
+            Point global_end;
+            int particle_id{};
+            double local_time{};
+            double global_time{};
+            unsigned int charge{};
+            long track{-1};
+            long parent{-1};
+
+            template <class Archive> void serialize(Archive& archive) {
+                archive(local_start,
+                        global_start,
+                        local_end,
+                        global_end,
+                        particle_id,
+                        local_time,
+                        global_time,
+                        charge,
+                        track,
+                        parent);
+            }
+        };
+
+        /**
+         * @brief Charge deposit, referencing its Monte Carlo particle by index
+         */
+        struct DepositRecord {
+            Point local_position;
+            Point global_position;
+            int type{};
+            unsigned int charge{};
+            double local_time{};
+            double global_time{};
+            long particle{-1};
+
+            template <class Archive> void serialize(Archive& archive) {
+                archive(local_position, global_position, type, charge, local_time, global_time, particle);
+            }
+        };
+
+        /**
+         * @brief Monte Carlo particles and charge deposits of one sensor
+         */
+        struct SensorRecord {
+            std::string detector;
+            std::vector<ParticleRecord> particles;
+            std::vector<DepositRecord> deposits;
+
+            template <class Archive> void serialize(Archive& archive) { archive(detector, particles, deposits); }
+        };
+
+        /**
+         * @brief All objects produced by the Geant4 simulation of one event
+         */
+        struct EventRecord {
+            uint64_t number{};
+            uint64_t seed{};
+            std::string abort_reason;
+            std::vector<TrackRecord> tracks;
+            std::vector<SensorRecord> sensors;
+
+            template <class Archive> void serialize(Archive& archive) {
+                archive(number, seed, abort_reason, tracks, sensors);
+            }
+        };
+
+        /**
+         * @brief Convert messages into a record, replacing the references between objects by indices
+         * @param track_message Message with the Monte Carlo tracks of the event
+         * @param sensor_messages Messages with Monte Carlo particles and charge deposits for every sensor
+         * @return Record of the event without event number and seed
+         */
+        static EventRecord makeRecord(const std::shared_ptr<MCTrackMessage>& track_message,
+                                      const std::vector<SensorMessages>& sensor_messages);
+
+        /**
+         * @brief Merge the records of several sub-events into a single record
+         * @param records Records to be merged, objects are concatenated in the order of the records
+         * @return Merged record without event number and seed
+         *
+         * Local times of particles and deposits are recomputed relative to the earliest particle in each sensor.
+         */
+        static EventRecord mergeRecords(std::vector<EventRecord> records);
+
+        /**
+         * @brief Create the messages of a record and dispatch them
+         * @param record Record to be dispatched
+         * @param module Module responsible for dispatching the messages
+         * @param messenger Messenger used to dispatch them
+         * @param geo_manager Geometry manager to look up the detectors
+         * @param event Event to dispatch the messages to
+         * @return Total number of charge carriers deposited in all sensors
+         */
+        static unsigned int dispatchRecord(
+            const EventRecord& record, Module* module, Messenger* messenger, GeometryManager* geo_manager, Event* event);
+
+        /**
+         * @brief Open an existing cache file for reading
+         * @param file_name Path of the cache file
+         * @param key Description of the settings the cache needs to have been created with
+         * @return True if a complete cache file with identical settings has been found, false otherwise
+         */
+        bool open(const std::filesystem::path& file_name, const std::string& key);
+
+        /**
+         * @brief Create a new cache file, replacing any existing file
+         * @param file_name Path of the cache file
+         * @param key Description of the settings the cache is created with
+         */
+        void create(const std::filesystem::path& file_name, const std::string& key);
+
+        /**
+         * @brief Check if the cache has been opened for reading
+         * @return True if reading, false if writing
+         */
+        bool reading() const { return reading_; }
+
+        /**
+         * @brief Check if the cache holds a record for a given event
+         * @param event_num Number of the event
+         * @return True if the event is available
+         */
+        bool contains(uint64_t event_num) const { return index_.find(event_num) != index_.end(); }
+
+        /**
+         * @brief Store the record of an event
+         * @param record Record holding all objects of the event, including event number and seed
+         */
+        void store(const EventRecord& record);
+
+        /**
+         * @brief Store an event which has been aborted during the simulation
+         * @param event Event which has been aborted
+         * @param reason Reason for aborting the event
+         */
+        void storeAborted(const Event* event, const std::string& reason);
+
+        /**
+         * @brief Read the record of an event and dispatch its messages
+         * @param module Module responsible for dispatching the messages
+         * @param messenger Messenger used to dispatch them
+         * @param geo_manager Geometry manager to look up the detectors
+         * @param event Event to dispatch the messages to
+         * @return Total number of charge carriers deposited in all sensors
+         * @throws AbortEventException If the event has been aborted during the simulation
+         */
+        unsigned int dispatch(Module* module, Messenger* messenger, GeometryManager* geo_manager, Event* event);
+
+        /**
+         * @brief Write the index and close the cache file
+         */
+        void close();
+
+    private:
+        std::filesystem::path file_name_;
+        bool reading_{};
+
+        // File stream, shared between threads and protected by the mutex
+        std::fstream file_;
+        std::mutex mutex_;
+
+        // Offsets of the event records in the cache file
+        std::map<uint64_t, uint64_t> index_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_DEPOSITION_MODULE_DEPOSIT_CACHE_H */
@@ -12,22 +12,36 @@
 
 #include "DepositionGeant4Module.hpp"
 
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iterator>
 #include <limits>
+#include <set>
+#include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <G4Box.hh>
 #include <G4EmParameters.hh>
 #include <G4HadronicParameters.hh>
 #include <G4HadronicProcessStore.hh>
 #include <G4LogicalVolume.hh>
+#include <G4Material.hh>
 #include <G4NuclearLevelData.hh>
 #include <G4PhysListFactory.hh>
 #include <G4ProcessTable.hh>
 #include <G4RadioactiveDecayPhysics.hh>
+#include <G4RegionStore.hh>
 #include <G4StepLimiterPhysics.hh>
 #include <G4UImanager.hh>
 #include <G4UserLimits.hh>
+#include <G4Version.hh>
 
 #include "G4FieldManager.hh"
 #include "G4TransportationManager.hh"
@@ -81,6 +95,14 @@ DepositionGeant4Module::DepositionGeant4Module(Configuration& config, Messenger*
     // By default, only record MCTracks connected to MCParticles in the sensitive volume
     config_.setDefault<bool>("record_all_tracks", false);
 
+    // By default, every step with non-zero charge results in a separate deposit
+    config_.setDefault<double>("deposit_aggregation_length", 0);
+    config_.setDefault<unsigned int>("deposit_aggregation_charge", 0);
+
+    // By default, all primary particles of an event are simulated in a single Geant4 run
+    config_.setDefault<unsigned int>("sub_event_size", 0);
+    config_.setDefault<unsigned int>("sub_event_workers", 0);
+
     // Defaults for energy deposition in implants
     config_.setDefault<bool>("deposit_in_frontside_implants", true);
     config_.setDefault<bool>("deposit_in_backside_implants", false);
@@ -124,6 +146,61 @@ void DepositionGeant4Module::initialize() {
     number_of_particles_ = config_.get<unsigned int>("number_of_particles", 1);
     output_plots_ = config_.get<bool>("output_plots");
 
+    // Split events with many primary particles into sub-events, optionally simulated in parallel
+    sub_event_size_ = config_.get<unsigned int>("sub_event_size");
+    auto sub_event_workers = config_.get<unsigned int>("sub_event_workers");
+    if(sub_event_workers > 0 && sub_event_size_ == 0) {
+        throw InvalidCombinationError(
+            config_, {"sub_event_workers", "sub_event_size"}, "sub-event workers require a non-zero sub-event size");
+    }
+    if(sub_event_size_ > 0) {
+        sub_events_ = (number_of_particles_ + sub_event_size_ - 1) / sub_event_size_;
+        LOG(INFO) << "Splitting events into " << sub_events_ << " sub-events of up to " << sub_event_size_
+                  << " primary particles";
+        if(output_plots_) {
+            LOG(WARNING) << "Output plots are not filled when splitting events into sub-events";
+        }
+    }
+
+    // Serve the deposits from the cache if it holds all events of this run simulated with identical settings
+    if(config_.has("deposit_cache")) {
+        auto cache_file = config_.getPath("deposit_cache");
+        auto key = cache_key();
+
+        auto& global_config = getConfigManager()->getGlobalConfiguration();
+        auto first_event = global_config.get<uint64_t>("skip_events", 0) + 1;
+        auto last_event = first_event + global_config.get<uint64_t>("number_of_events", 1);
+
+        deposit_cache_ = std::make_unique<DepositCache>();
+        if(deposit_cache_->open(cache_file, key)) {
+            read_from_cache_ = true;
+            for(auto event_num = first_event; event_num < last_event; ++event_num) {
+                if(!deposit_cache_->contains(event_num)) {
+                    LOG(INFO) << "Deposit cache does not hold event " << event_num << ", simulating all events";
+                    read_from_cache_ = false;
+                    break;
+                }
+            }
+        }
+
+        if(read_from_cache_) {
+            // Every sensor draws one random number for its seed, followed by the two Geant4 seeds, for every sub-event
+            auto detectors = geo_manager_->getDetectors();
+            number_of_sensors_ = static_cast<size_t>(std::count_if(
+                detectors.begin(), detectors.end(), [this](const auto& detector) { return has_listeners(detector); }));
+            random_draws_ = (number_of_sensors_ + 2) * std::max(sub_events_, 1u);
+
+            if(output_plots_) {
+                LOG(WARNING) << "Output plots are not filled when reading deposits from cache";
+            }
+            LOG(STATUS) << "Reading deposits from cache " << cache_file << ", skipping Geant4 simulation";
+            return;
+        }
+
+        LOG(STATUS) << "Storing deposits in cache " << cache_file;
+        deposit_cache_->create(cache_file, key);
+    }
+
     // Load the G4 run manager (which is owned by the geometry builder)
     if(multithreadingEnabled()) {
         run_manager_g4_ = G4MTRunManager::GetMasterRunManager();
@@ -223,6 +300,7 @@ void DepositionGeant4Module::initialize() {
                   << ", derived from properties of detector \"" << min_detector << "\"";
     }
     physicsList->SetDefaultCutValue(production_cut);
+    physics_list_ = physicsList;
 
     // Set minimum remaining kinetic energy for a track
     double min_charge_creation_energy{};
@@ -273,6 +351,25 @@ void DepositionGeant4Module::initialize() {
     G4HadronicParameters::Instance()->SetVerboseLevel(0);
     G4NuclearLevelData::GetInstance()->GetParameters()->SetVerbose(0);
 
+    // Retrieve physics tables stored by a previous run with identical materials and physics settings, or store them later
+    if(config_.has("physics_table_cache")) {
+        auto key = physics_table_key(production_cut);
+        std::stringstream hash;
+        hash << std::hex << std::hash<std::string>()(key);
+        auto directory = config_.getPath("physics_table_cache") / hash.str();
+
+        std::ifstream key_file(directory / "settings.txt");
+        std::string stored_key((std::istreambuf_iterator<char>(key_file)), std::istreambuf_iterator<char>());
+        if(key_file.is_open() && stored_key == key) {
+            LOG(STATUS) << "Retrieving Geant4 physics tables from " << directory;
+            physicsList->SetPhysicsTableRetrieved(directory.string());
+        } else {
+            LOG(STATUS) << "Storing Geant4 physics tables for later runs in " << directory;
+            physics_table_directory_ = directory;
+            physics_table_key_ = key;
+        }
+    }
+
     // Initialize the full run manager to ensure correct state flags
     run_manager_g4_->Initialize();
 
@@ -292,6 +389,17 @@ void DepositionGeant4Module::initialize() {
         run_manager_mt->SetSDAndFieldConstruction(std::move(detector_construction));
     }
 
+    // Start the threads simulating sub-events, each holding its own worker run manager and sensitive detectors
+    if(sub_event_workers > 0) {
+        if(run_manager_mt == nullptr) {
+            LOG(WARNING) << "Multithreading is disabled, sub-events are simulated sequentially";
+        } else {
+            LOG(DEBUG) << "Starting " << sub_event_workers << " sub-event worker thread(s)";
+            sub_event_pool_ = std::make_unique<SubEventPool>(
+                sub_event_workers, [this]() { initializeThread(); }, [this]() { finalizeThread(); });
+        }
+    }
+
     // Flush the Geant4 stream buffer because some elements in the initialization never do:
     G4cout << G4endl;
 }
@@ -303,6 +411,10 @@ void DepositionGeant4Module::initialize_g4_action() {
 }
 
 void DepositionGeant4Module::initializeThread() {
+    // Geant4 is not used when reading from the deposit cache
+    if(read_from_cache_) {
+        return;
+    }
 
     LOG(DEBUG) << "Initializing run manager";
 
@@ -326,6 +438,24 @@ void DepositionGeant4Module::initializeThread() {
 
 void DepositionGeant4Module::run(Event* event) {
 
+    // Replay the cached event, drawing the same random numbers as the simulation to leave the event PRNG state unchanged
+    if(read_from_cache_) {
+        for(size_t i = 0; i < random_draws_; ++i) {
+            event->getRandomNumber();
+        }
+
+        uint64_t last_event_num = last_event_num_.load();
+        last_event_num_.compare_exchange_strong(last_event_num, event->number);
+
+        total_charges_ += deposit_cache_->dispatch(this, messenger_, geo_manager_, event);
+        return;
+    }
+
+    if(sub_event_size_ > 0) {
+        run_sub_events(event);
+        return;
+    }
+
     // Seed the sensitive detectors RNG
     for(auto& sensor : sensors_) {
         sensor->seed(event->getRandomNumber());
@@ -338,23 +468,18 @@ void DepositionGeant4Module::run(Event* event) {
     LOG(DEBUG) << "Seeding Geant4 event with seeds " << seed1 << " " << seed2;
 
     try {
-        if(multithreadingEnabled()) {
-            auto* run_manager_mt = static_cast<MTRunManager*>(run_manager_g4_);
-            run_manager_mt->Run(static_cast<int>(number_of_particles_), seed1, seed2);
-        } else {
-            auto* run_manager = static_cast<RunManager*>(run_manager_g4_);
-            run_manager->Run(static_cast<int>(number_of_particles_), seed1, seed2);
-        }
+        run_geant4(number_of_particles_, seed1, seed2);
 
         uint64_t last_event_num = last_event_num_.load();
         last_event_num_.compare_exchange_strong(last_event_num, event->number);
 
         track_info_manager_->createMCTracks();
-        track_info_manager_->dispatchMessage(this, messenger_, event);
+        auto track_message = track_info_manager_->dispatchMessage(this, messenger_, event);
 
         // Dispatch the necessary messages
+        std::vector<DepositCache::SensorMessages> sensor_messages;
         for(auto& sensor : sensors_) {
-            sensor->dispatchMessages(this, messenger_, event);
+            sensor_messages.push_back(sensor->dispatchMessages(this, messenger_, event));
 
             // Fill output plots if requested:
             if(output_plots_) {
@@ -365,11 +490,22 @@ void DepositionGeant4Module::run(Event* event) {
                 energy_per_event_[sensor->getName()]->Fill(deposited_energy);
             }
         }
+
+        // Store the dispatched messages for later runs
+        if(deposit_cache_ != nullptr) {
+            auto record = DepositCache::makeRecord(track_message, sensor_messages);
+            record.number = event->number;
+            record.seed = event->getSeed();
+            deposit_cache_->store(record);
+        }
     } catch(AbortEventException& e) {
         // Clear charge deposits of all sensors
         for(auto& sensor : sensors_) {
             sensor->clearEventInfo();
         }
+        if(deposit_cache_ != nullptr) {
+            deposit_cache_->storeAborted(event, e.what());
+        }
         run_manager_g4_->AbortRun();
         track_info_manager_->resetTrackInfoManager();
         throw;
@@ -378,7 +514,113 @@ void DepositionGeant4Module::run(Event* event) {
     track_info_manager_->resetTrackInfoManager();
 }
 
+void DepositionGeant4Module::run_sub_events(Event* event) {
+    // Draw the seeds of all sub-events in a fixed order, such that the result does not depend on the number of workers
+    std::vector<std::pair<unsigned int, std::vector<uint64_t>>> sub_events;
+    sub_events.reserve(sub_events_);
+    for(unsigned int first = 0; first < number_of_particles_; first += sub_event_size_) {
+        std::vector<uint64_t> seeds(sensors_.size() + 2);
+        for(auto& seed : seeds) {
+            seed = event->getRandomNumber();
+        }
+        sub_events.emplace_back(std::min(sub_event_size_, number_of_particles_ - first), std::move(seeds));
+    }
+
+    std::vector<DepositCache::EventRecord> records;
+    records.reserve(sub_events.size());
+    try {
+        if(sub_event_pool_ != nullptr) {
+            std::vector<std::future<DepositCache::EventRecord>> futures;
+            futures.reserve(sub_events.size());
+            for(const auto& sub_event : sub_events) {
+                futures.push_back(sub_event_pool_->submit(
+                    [this, &sub_event]() { return run_sub_event(sub_event.first, sub_event.second); }));
+            }
+
+            // Wait for all sub-events before propagating an exception, the tasks refer to the seeds of this event
+            std::exception_ptr exception;
+            for(auto& future : futures) {
+                try {
+                    records.push_back(future.get());
+                } catch(...) {
+                    if(!exception) {
+                        exception = std::current_exception();
+                    }
+                }
+            }
+            if(exception) {
+                std::rethrow_exception(exception);
+            }
+        } else {
+            for(const auto& [particles, seeds] : sub_events) {
+                records.push_back(run_sub_event(particles, seeds));
+            }
+        }
+    } catch(AbortEventException& e) {
+        if(deposit_cache_ != nullptr) {
+            deposit_cache_->storeAborted(event, e.what());
+        }
+        throw;
+    }
+
+    uint64_t last_event_num = last_event_num_.load();
+    last_event_num_.compare_exchange_strong(last_event_num, event->number);
+
+    // Merge the sub-events in the order of their seeds and dispatch the result as a single event
+    auto record = DepositCache::mergeRecords(std::move(records));
+    record.number = event->number;
+    record.seed = event->getSeed();
+    if(deposit_cache_ != nullptr) {
+        deposit_cache_->store(record);
+    }
+    total_charges_ += DepositCache::dispatchRecord(record, this, messenger_, geo_manager_, event);
+}
+
+DepositCache::EventRecord DepositionGeant4Module::run_sub_event(unsigned int particles,
+                                                                const std::vector<uint64_t>& seeds) {
+    for(size_t i = 0; i < sensors_.size(); ++i) {
+        sensors_[i]->seed(seeds.at(i));
+    }
+    auto seed1 = seeds.at(sensors_.size());
+    auto seed2 = seeds.at(sensors_.size() + 1);
+    LOG(DEBUG) << "Seeding Geant4 sub-event of " << particles << " particles with seeds " << seed1 << " " << seed2;
+
+    try {
+        run_geant4(particles, seed1, seed2);
+
+        track_info_manager_->createMCTracks();
+        auto track_message = track_info_manager_->createMessage();
+        std::vector<DepositCache::SensorMessages> sensor_messages;
+        for(auto& sensor : sensors_) {
+            sensor_messages.push_back(sensor->createMessages());
+        }
+        track_info_manager_->resetTrackInfoManager();
+
+        return DepositCache::makeRecord(track_message, sensor_messages);
+    } catch(AbortEventException&) {
+        for(auto& sensor : sensors_) {
+            sensor->clearEventInfo();
+        }
+        run_manager_g4_->AbortRun();
+        track_info_manager_->resetTrackInfoManager();
+        throw;
+    }
+}
+
+void DepositionGeant4Module::run_geant4(unsigned int particles, uint64_t seed1, uint64_t seed2) {
+    if(multithreadingEnabled()) {
+        auto* run_manager_mt = static_cast<MTRunManager*>(run_manager_g4_);
+        run_manager_mt->Run(static_cast<int>(particles), seed1, seed2);
+    } else {
+        auto* run_manager = static_cast<RunManager*>(run_manager_g4_);
+        run_manager->Run(static_cast<int>(particles), seed1, seed2);
+    }
+}
+
 void DepositionGeant4Module::finalize() {
+    // Finalize the sub-event threads to include their statistics
+    sub_event_pool_.reset();
+
     if(output_plots_) {
         // Write histograms
         LOG(TRACE) << "Writing output plots to file";
@@ -398,13 +640,30 @@ void DepositionGeant4Module::finalize() {
     } else {
         LOG(WARNING) << "No charges deposited";
     }
+
+    // Complete the deposit cache file
+    if(deposit_cache_ != nullptr) {
+        deposit_cache_->close();
+    }
+
+    // Store the physics tables, which are built at the latest when the first event is simulated
+    if(!physics_table_directory_.empty() && (multithreadingEnabled() || last_event_num_ > 0)) {
+        std::filesystem::create_directories(physics_table_directory_);
+        if(physics_list_->StorePhysicsTable(physics_table_directory_.string())) {
+            std::ofstream key_file(physics_table_directory_ / "settings.txt");
+            key_file << physics_table_key_;
+            LOG(INFO) << "Stored Geant4 physics tables in " << physics_table_directory_;
+        } else {
+            LOG(WARNING) << "Could not store Geant4 physics tables in " << physics_table_directory_;
+        }
+    }
 }
 
 void DepositionGeant4Module::finalizeThread() {
     // Record the number of sensors and the total charges
     record_module_statistics();
 
-    if(multithreadingEnabled()) {
+    if(multithreadingEnabled() && !read_from_cache_) {
         auto* run_manager_mt = static_cast<MTRunManager*>(run_manager_g4_);
         run_manager_mt->TerminateForThread();
     }
@@ -429,10 +688,7 @@ void DepositionGeant4Module::construct_sensitive_detectors_and_fields() {
     bool useful_deposition = false;
     for(auto& detector : geo_manager_->getDetectors()) {
         // Do not add sensitive detector for detectors that have no listeners for the deposited charges
-        if(!messenger_->hasReceiver(this,
-                                    std::make_shared<DepositedChargeMessage>(std::vector<DepositedCharge>(), detector)) &&
-           !messenger_->hasReceiver(this, std::make_shared<MCParticleMessage>(std::vector<MCParticle>(), detector)) &&
-           !messenger_->hasReceiver(this, std::make_shared<MCTrackMessage>(std::vector<MCTrack>()))) {
+        if(!has_listeners(detector)) {
             LOG(INFO) << "Not depositing charges in " << detector->getName()
                       << " because there is no listener for its output";
             continue;
@@ -452,9 +708,21 @@ void DepositionGeant4Module::construct_sensitive_detectors_and_fields() {
         // Cut-off time for particle generation:
         auto cutoff_time = config_.get<double>("cutoff_time");
 
+        // Settings for the aggregation of consecutive steps into single deposits
+        auto aggregation_length = config_.get<double>("deposit_aggregation_length");
+        auto aggregation_charge = config_.get<unsigned int>("deposit_aggregation_charge");
+        if(aggregation_length < 0) {
+            throw InvalidValueError(config_, "deposit_aggregation_length", "aggregation length cannot be negative");
+        }
+
         // Get model of the sensitive device
-        auto* sensitive_detector_action = new SensitiveDetectorActionG4(
-            detector, track_info_manager_.get(), charge_creation_energy, fano_factor, cutoff_time);
+        auto* sensitive_detector_action = new SensitiveDetectorActionG4(detector,
+                                                                        track_info_manager_.get(),
+                                                                        charge_creation_energy,
+                                                                        fano_factor,
+                                                                        cutoff_time,
+                                                                        aggregation_length,
+                                                                        aggregation_charge);
         auto logical_volume = geo_manager_->getExternalObject<G4LogicalVolume>(detector->getName(), "sensor_log");
         if(logical_volume == nullptr) {
             throw ModuleError("Detector " + detector->getName() + " has no sensitive device (broken Geant4 geometry)");
@@ -532,8 +800,94 @@ void DepositionGeant4Module::record_module_statistics() {
         number_of_sensors_ = num_sensors;
     }
 
-    // We calculate the total deposited charges here, since sensors exist per thread
+    // We calculate the total deposited charges here, since sensors exist per thread. Charges of sub-events are counted
+    // when dispatching the merged events instead
+    if(sub_event_size_ > 0) {
+        return;
+    }
     for(auto& sensor : sensors_) {
         total_charges_ += sensor->getTotalDepositedCharge();
     }
 }
+
+bool DepositionGeant4Module::has_listeners(const std::shared_ptr<Detector>& detector) {
+    return messenger_->hasReceiver(this,
+                                   std::make_shared<DepositedChargeMessage>(std::vector<DepositedCharge>(), detector)) ||
+           messenger_->hasReceiver(this, std::make_shared<MCParticleMessage>(std::vector<MCParticle>(), detector)) ||
+           messenger_->hasReceiver(this, std::make_shared<MCTrackMessage>(std::vector<MCTrack>()));
+}
+
+std::string DepositionGeant4Module::cache_key() {
+    std::stringstream key;
+    key << std::setprecision(std::numeric_limits<double>::max_digits10);
+    key << "Allpix Squared " << ALLPIX_PROJECT_VERSION << ", Geant4 " << G4VERSION_NUMBER << std::endl;
+
+    auto* config_manager = getConfigManager();
+    key << "random_seed = " << config_manager->getGlobalConfiguration().get<std::string>("random_seed") << std::endl;
+
+    // Settings of this module and of the modules defining the Geant4 geometry and fields, omitting output settings
+    const std::set<std::string> ignored_keys = {
+        "identifier",
+        "log_level",
+        "log_format",
+        "output_plots",
+        "output_plots_scale",
+        "deposit_cache",
+        "physics_table_cache",
+        "sub_event_workers"};
+    auto add_configuration = [&](const Configuration& config) {
+        for(const auto& [name, value] : config.getAll()) {
+            if(ignored_keys.find(name) == ignored_keys.end()) {
+                key << config.getName() << "." << name << " = " << value << std::endl;
+            }
+        }
+    };
+    add_configuration(config_);
+    for(const auto& config : config_manager->getInstanceConfigurations()) {
+        if(config.getName() == "GeometryBuilderGeant4" || config.getName() == "MagneticFieldReader") {
+            add_configuration(config);
+        }
+    }
+
+    // Placement and models of the detectors, and whether deposits are generated in them, as well as passive volumes
+    for(const auto& detector : geo_manager_->getDetectors()) {
+        key << "detector " << detector->getName() << " at " << detector->getPosition() << " with orientation "
+            << detector->getOrientation() << (has_listeners(detector) ? ", sensitive" : ", not sensitive") << std::endl;
+        for(const auto& model_config : detector->getModel()->getConfigurations()) {
+            add_configuration(model_config);
+        }
+    }
+    for(const auto& passive_element : geo_manager_->getPassiveElements()) {
+        add_configuration(passive_element);
+    }
+
+    return key.str();
+}
+
+/**
+ * Physics tables depend on the materials present in the geometry, the physics list with its options and the production cuts
+ * of the regions. The key lists all of them, such that tables are only retrieved for identical setups.
+ */
+std::string DepositionGeant4Module::physics_table_key(double production_cut) const {
+    std::stringstream key;
+    key << std::setprecision(std::numeric_limits<double>::max_digits10);
+    key << "Geant4 " << G4VERSION_NUMBER << std::endl;
+    key << "physics_list = " << config_.get<std::string>("physics_list") << std::endl;
+    key << "enable_pai = " << config_.get<bool>("enable_pai", false)
+        << ", pai_model = " << config_.get<std::string>("pai_model") << std::endl;
+    key << "production_cut = " << production_cut << std::endl;
+
+    for(const auto* material : *G4Material::GetMaterialTable()) {
+        key << "material " << material->GetName() << " with density " << material->GetDensity() << ":";
+        for(size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+            key << " " << material->GetElement(static_cast<G4int>(i))->GetName() << " "
+                << material->GetFractionVector()[i];
+        }
+        key << std::endl;
+    }
+    for(const auto* region : *G4RegionStore::GetInstance()) {
+        key << "region " << region->GetName() << std::endl;
+    }
+
+    return key.str();
+}
@@ -13,8 +13,10 @@
 #define ALLPIX_SIMPLE_DEPOSITION_MODULE_H
 
 #include <atomic>
+#include <filesystem>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <G4UserLimits.hh>
 
@@ -24,7 +26,9 @@
 #include "core/module/Event.hpp"
 #include "core/module/Module.hpp"
 
+#include "DepositCache.hpp"
 #include "SensitiveDetectorActionG4.hpp"
+#include "SubEventPool.hpp"
 #include "TrackInfoManager.hpp"
 
 #include "tools/ROOT.h"
@@ -33,6 +37,7 @@
 
 class G4UserLimits;
 class G4RunManager;
+class G4VModularPhysicsList;
 
 namespace allpix {
     /**
@@ -102,9 +107,53 @@ namespace allpix {
          */
         void record_module_statistics();
 
+        /**
+         * @brief Check if any module listens to the output of a detector
+         * @param detector Detector to check
+         * @return True if the detector has listeners for its deposited charges, MC particles or MC tracks
+         */
+        bool has_listeners(const std::shared_ptr<Detector>& detector);
+
+        /**
+         * @brief Describe all settings which influence the simulated deposits, used to validate the deposit cache
+         * @return Description of the settings
+         */
+        std::string cache_key();
+
+        /**
+         * @brief Describe all settings which influence the Geant4 physics tables, used to validate stored tables
+         * @param production_cut Default production cut applied to the physics list
+         * @return Description of the settings
+         */
+        std::string physics_table_key(double production_cut) const;
+
+        /**
+         * @brief Simulate an event as a sequence of sub-events and dispatch the merged result
+         * @param event Event to simulate
+         */
+        void run_sub_events(Event* event);
+
+        /**
+         * @brief Simulate a single sub-event on the calling thread
+         * @param particles Number of primary particles of the sub-event
+         * @param seeds Seeds of the sensitive detectors, followed by the two Geant4 seeds
+         * @return Record of the sub-event
+         */
+        DepositCache::EventRecord run_sub_event(unsigned int particles, const std::vector<uint64_t>& seeds);
+
+        /**
+         * @brief Run the Geant4 simulation on the calling thread
+         * @param particles Number of primary particles
+         * @param seed1 First Geant4 seed
+         * @param seed2 Second Geant4 seed
+         */
+        void run_geant4(unsigned int particles, uint64_t seed1, uint64_t seed2);
+
         // Configuration parameters:
         bool output_plots_{};
         unsigned int number_of_particles_{};
+        unsigned int sub_event_size_{};
+        unsigned int sub_events_{};
 
         // The track manager which this module uses to assign custom track IDs and manage & create MCTracks
         static thread_local std::unique_ptr<TrackInfoManager> track_info_manager_;
@@ -123,6 +172,19 @@ namespace allpix {
         std::map<std::string, Histogram<TH1D>> charge_per_event_;
         std::map<std::string, Histogram<TH1D>> energy_per_event_;
 
+        // Cache of the deposits from a previous run with identical settings
+        std::unique_ptr<DepositCache> deposit_cache_;
+        bool read_from_cache_{};
+        size_t random_draws_{};
+
+        // Physics list owned by the Geant4 run manager, and directory and settings to store its tables with if not retrieved
+        G4VModularPhysicsList* physics_list_{};
+        std::filesystem::path physics_table_directory_;
+        std::string physics_table_key_;
+
+        // Threads simulating the sub-events of an event in parallel
+        std::unique_ptr<SubEventPool> sub_event_pool_;
+
         // Total deposited charges
         std::atomic_uint total_charges_{0};
 
@@ -13,6 +13,9 @@
 #include "SensitiveDetectorActionG4.hpp"
 #include "TrackInfoG4.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 
 #include "G4DecayTable.hh"
@@ -40,10 +43,13 @@ SensitiveDetectorActionG4::SensitiveDetectorActionG4(const std::shared_ptr<Detec
                                                      TrackInfoManager* track_info_manager,
                                                      double charge_creation_energy,
                                                      double fano_factor,
-                                                     double cutoff_time)
+                                                     double cutoff_time,
+                                                     double aggregation_length,
+                                                     unsigned int aggregation_charge)
     : G4VSensitiveDetector("SensitiveDetector_" + detector->getName()), detector_(detector),
       track_info_manager_(track_info_manager), charge_creation_energy_(charge_creation_energy), fano_factor_(fano_factor),
-      cutoff_time_(cutoff_time) {
+      cutoff_time_(cutoff_time), aggregation_length_(aggregation_length), aggregation_charge_(aggregation_charge),
+      aggregate_(aggregation_length > 0 || aggregation_charge > 0) {
 
     // Add the sensor to the internal sensitive detector manager
     G4SDManager* sd_man_g4 = G4SDManager::GetSDMpointer();
@@ -96,26 +102,44 @@ G4bool SensitiveDetectorActionG4::ProcessHits(G4Step* step, G4TouchableHistory*)
         (track->GetVolume()->GetLogicalVolume() == track->GetLogicalVolumeAtVertex() ? userTrackInfo->getParentID() : 0);
 
     // Save begin point when track is seen for the first time
-    if(track_begin_.find(trackID) == track_begin_.end()) {
+    auto track_index = static_cast<size_t>(trackID);
+    if(track_index >= track_index_.size()) {
+        track_index_.resize(track_index + 1, -1);
+    }
+    if(track_index_[track_index] < 0) {
         track_info_manager_->setTrackInfoToBeStored(trackID);
         auto start_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(preStep->GetPosition()));
-        track_begin_.emplace(trackID, start_position);
-        track_parents_.emplace(trackID, parentTrackID);
-        track_time_.emplace(trackID, step_time);
-        track_pdg_.emplace(trackID, track->GetDynamicParticle()->GetPDGcode());
+        track_index_[track_index] = static_cast<long>(tracks_.size());
+        auto pdg_code = track->GetDynamicParticle()->GetPDGcode();
+        tracks_.push_back({trackID, parentTrackID, pdg_code, step_time, start_position, start_position, 0});
     }
 
     // Update current end point with the current last step
-    auto end_position = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(postStep->GetPosition()));
-    track_end_[trackID] = end_position;
-    track_charge_[trackID] += charge;
+    auto& track_record = tracks_[static_cast<size_t>(track_index_[track_index])];
+    track_record.end = detector_->getLocalPosition(static_cast<ROOT::Math::XYZPoint>(postStep->GetPosition()));
+    track_record.charge += charge;
 
     // Add new deposit if the charge is more than zero
     if(charge == 0) {
         return false;
     }
 
+    // Determine the aggregation voxel of this step
+    std::array<long, 3> voxel{};
+    if(aggregation_length_ > 0) {
+        voxel = {static_cast<long>(std::floor(deposit_position.x() / aggregation_length_)),
+                 static_cast<long>(std::floor(deposit_position.y() / aggregation_length_)),
+                 static_cast<long>(std::floor(deposit_position.z() / aggregation_length_))};
+    }
+
+    // Merge with the previous step of the same track if requested
+    deposit_steps_++;
+    if(aggregate_ && aggregate_deposit(deposit_position, voxel, charge, edep, step_time, trackID)) {
+        return true;
+    }
+
     // Store relevant quantities to create charge deposits:
+    deposit_voxel_ = voxel;
     deposit_position_.push_back(deposit_position);
     deposit_charge_.push_back(charge);
     deposit_energy_.push_back(edep);
@@ -125,6 +149,43 @@ G4bool SensitiveDetectorActionG4::ProcessHits(G4Step* step, G4TouchableHistory*)
     return true;
 }
 
+bool SensitiveDetectorActionG4::aggregate_deposit(const ROOT::Math::XYZPoint& position,
+                                                  const std::array<long, 3>& voxel,
+                                                  unsigned int charge,
+                                                  double energy,
+                                                  double time,
+                                                  int track_id) {
+    // Only merge consecutive steps of the same track, Geant4 processes all steps of a track before its secondaries
+    if(deposit_to_id_.empty() || deposit_to_id_.back() != track_id) {
+        return false;
+    }
+
+    // Stay within the voxel of the stored deposit and below the requested charge quantum
+    if(aggregation_length_ > 0 && voxel != deposit_voxel_) {
+        return false;
+    }
+    auto& aggregate_charge = deposit_charge_.back();
+    if(aggregation_charge_ > 0 && aggregate_charge >= aggregation_charge_) {
+        return false;
+    }
+
+    // Place the merged deposit at the charge-weighted mean position and time of the steps
+    auto total_charge = aggregate_charge + charge;
+    auto weight = static_cast<double>(charge) / static_cast<double>(total_charge);
+    auto& aggregate_position = deposit_position_.back();
+    aggregate_position += (position - aggregate_position) * weight;
+    auto& aggregate_time = deposit_time_.back();
+    aggregate_time += (time - aggregate_time) * weight;
+
+    aggregate_charge = total_charge;
+    deposit_energy_.back() += energy;
+
+    LOG(TRACE) << "Merged step with " << charge << " charges into deposit at "
+               << Units::display(aggregate_position, {"mm", "um"}) << " local, now holding " << aggregate_charge
+               << " charges";
+    return true;
+}
+
 std::string SensitiveDetectorActionG4::getName() const {
     return detector_->getName();
 }
@@ -148,80 +209,95 @@ double SensitiveDetectorActionG4::getDepositedEnergy() const {
 void SensitiveDetectorActionG4::clearEventInfo() {
     LOG(DEBUG) << "Clearing track and deposit vectors";
 
-    track_parents_.clear();
-    track_begin_.clear();
-    track_end_.clear();
-    track_pdg_.clear();
-    track_time_.clear();
-    track_charge_.clear();
+    for(const auto& track : tracks_) {
+        track_index_[static_cast<size_t>(track.id)] = -1;
+    }
+    tracks_.clear();
 
     deposit_position_.clear();
     deposit_charge_.clear();
     deposit_energy_.clear();
     deposit_time_.clear();
+    deposit_steps_ = 0;
 
     deposit_to_id_.clear();
-    id_to_particle_.clear();
 }
 
-void SensitiveDetectorActionG4::dispatchMessages(Module* module, Messenger* messenger, Event* event) {
+std::pair<std::shared_ptr<MCParticleMessage>, std::shared_ptr<DepositedChargeMessage>>
+SensitiveDetectorActionG4::dispatchMessages(Module* module, Messenger* messenger, Event* event) {
+    auto messages = createMessages();
 
-    auto time_reference = std::min_element(track_time_.begin(), track_time_.end(), [](const auto& l, const auto& r) {
-                              return l.second < r.second;
-                          })->second;
+    // Send the mc particle information
+    messenger->dispatchMessage(module, messages.first, event);
+
+    // Send a deposit message if we have any deposits
+    if(messages.second != nullptr) {
+        LOG(INFO) << "Deposited " << deposited_charge_ << " charges in sensor of detector " << detector_->getName();
+        messenger->dispatchMessage(module, messages.second, event);
+    }
+
+    return messages;
+}
+
+std::pair<std::shared_ptr<MCParticleMessage>, std::shared_ptr<DepositedChargeMessage>>
+SensitiveDetectorActionG4::createMessages() {
+
+    auto time_reference = std::numeric_limits<double>::max();
+    for(const auto& track : tracks_) {
+        time_reference = std::min(time_reference, track.time);
+    }
     LOG(TRACE) << "Earliest MCParticle arrived at " << Units::display(time_reference, {"ns", "ps"}) << " global";
 
+    // Order the tracks by their id, tracks are usually seen in this order already
+    auto by_id = [](const TrackRecord& l, const TrackRecord& r) { return l.id < r.id; };
+    if(!std::is_sorted(tracks_.begin(), tracks_.end(), by_id)) {
+        std::sort(tracks_.begin(), tracks_.end(), by_id);
+        for(size_t i = 0; i < tracks_.size(); ++i) {
+            track_index_[static_cast<size_t>(tracks_[i].id)] = static_cast<long>(i);
+        }
+    }
+
     // Create the mc particles
     std::vector<MCParticle> mc_particles;
-    for(auto& track_id_point : track_begin_) {
-        auto track_id = track_id_point.first;
-        auto local_begin = track_id_point.second;
-
-        ROOT::Math::XYZPoint end_point;
-        auto local_end = track_end_.at(track_id);
-        auto pdg_code = track_pdg_.at(track_id);
-        auto charge = track_charge_.at(track_id);
-        auto track_time_global = track_time_.at(track_id);
-        auto track_time_local = track_time_global - time_reference;
-
-        auto global_begin = detector_->getGlobalPosition(local_begin);
-        auto global_end = detector_->getGlobalPosition(local_end);
+    mc_particles.reserve(tracks_.size());
+    for(const auto& track : tracks_) {
+        auto track_time_local = track.time - time_reference;
+
+        auto global_begin = detector_->getGlobalPosition(track.begin);
+        auto global_end = detector_->getGlobalPosition(track.end);
         mc_particles.emplace_back(
-            local_begin, global_begin, local_end, global_end, pdg_code, track_time_local, track_time_global);
+            track.begin, global_begin, track.end, global_end, track.pdg_code, track_time_local, track.time);
         // Count electrons and holes:
-        mc_particles.back().setTotalDepositedCharge(2 * charge);
-        mc_particles.back().setTrack(track_info_manager_->findMCTrack(track_id));
-        id_to_particle_[track_id] = mc_particles.size() - 1;
+        mc_particles.back().setTotalDepositedCharge(2 * track.charge);
+        mc_particles.back().setTrack(track_info_manager_->findMCTrack(track.id));
 
-        LOG(DEBUG) << "Found MC particle " << pdg_code << " crossing detector " << detector_->getName() << " from "
-                   << Units::display(local_begin, {"mm", "um"}) << " to " << Units::display(local_end, {"mm", "um"})
-                   << " local after " << Units::display(track_time_global, {"ns", "ps"}) << " global / "
+        LOG(DEBUG) << "Found MC particle " << track.pdg_code << " crossing detector " << detector_->getName() << " from "
+                   << Units::display(track.begin, {"mm", "um"}) << " to " << Units::display(track.end, {"mm", "um"})
+                   << " local after " << Units::display(track.time, {"ns", "ps"}) << " global / "
                    << Units::display(track_time_local, {"ns", "ps"}) << " local";
     }
 
-    for(auto& track_parent : track_parents_) {
-        auto track_id = track_parent.first;
-        auto parent_id = track_parent.second;
-        if(id_to_particle_.find(parent_id) == id_to_particle_.end()) {
+    // Link the mc particles to their parents in a single pass
+    for(size_t i = 0; i < tracks_.size(); ++i) {
+        auto parent_index = static_cast<size_t>(tracks_[i].parent_id);
+        if(tracks_[i].parent_id <= 0 || parent_index >= track_index_.size() || track_index_[parent_index] < 0) {
             // Skip tracks without direct parents with deposits
             // FIXME: Geant4 does not allow for an easy way retrieve the whole hierarchy
             continue;
         }
-        auto track_idx = id_to_particle_.at(track_id);
-        auto parent_idx = id_to_particle_.at(parent_id);
-        mc_particles.at(track_idx).setParent(&mc_particles.at(parent_idx));
+        mc_particles[i].setParent(&mc_particles[static_cast<size_t>(track_index_[parent_index])]);
     }
 
-    // Send the mc particle information
     auto mc_particle_message = std::make_shared<MCParticleMessage>(std::move(mc_particles), detector_);
-    messenger->dispatchMessage(module, mc_particle_message, event);
 
-    // Send a deposit message if we have any deposits
+    // Create a deposit message if we have any deposits
     unsigned int charges = 0;
     double energies = 0.;
+    std::shared_ptr<DepositedChargeMessage> deposit_message;
     if(!deposit_position_.empty()) {
         // Prepare charge deposits for this event
         std::vector<DepositedCharge> deposits;
+        deposits.reserve(2 * deposit_position_.size());
         for(size_t i = 0; i < deposit_position_.size(); i++) {
             auto local_position = deposit_position_.at(i);
             auto global_position = detector_->getGlobalPosition(local_position);
@@ -238,15 +314,15 @@ void SensitiveDetectorActionG4::dispatchMessages(Module* module, Messenger* mess
             energies += edep;
 
             // Match deposit with mc particle if possible
-            auto track_id = deposit_to_id_.at(i);
+            auto particle_index = static_cast<size_t>(track_index_.at(static_cast<size_t>(deposit_to_id_.at(i))));
 
             // Deposit electron
             deposits.emplace_back(local_position, global_position, CarrierType::ELECTRON, charge, local_time, global_time);
-            deposits.back().setMCParticle(&mc_particle_message->getData().at(id_to_particle_.at(track_id)));
+            deposits.back().setMCParticle(&mc_particle_message->getData().at(particle_index));
 
             // Deposit hole
             deposits.emplace_back(local_position, global_position, CarrierType::HOLE, charge, local_time, global_time);
-            deposits.back().setMCParticle(&mc_particle_message->getData().at(id_to_particle_.at(track_id)));
+            deposits.back().setMCParticle(&mc_particle_message->getData().at(particle_index));
 
             LOG(DEBUG) << "Created deposit of " << charge << " charges at " << Units::display(global_position, {"mm", "um"})
                        << " global / " << Units::display(local_position, {"mm", "um"}) << " local in "
@@ -254,13 +330,13 @@ void SensitiveDetectorActionG4::dispatchMessages(Module* module, Messenger* mess
                        << Units::display(local_time, {"ns", "ps"}) << " local";
         }
 
-        LOG(INFO) << "Deposited " << charges << " charges in sensor of detector " << detector_->getName();
+        if(aggregate_) {
+            LOG(DEBUG) << "Aggregated " << deposit_steps_ << " steps into " << deposit_position_.size()
+                       << " deposits in sensor of detector " << detector_->getName();
+        }
 
         // Create a new charge deposit message
-        auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(deposits), detector_);
-
-        // Dispatch the message
-        messenger->dispatchMessage(module, deposit_message, event);
+        deposit_message = std::make_shared<DepositedChargeMessage>(std::move(deposits), detector_);
     }
     // Store the number of charge carriers:
     deposited_charge_ = charges;
@@ -268,4 +344,6 @@ void SensitiveDetectorActionG4::dispatchMessages(Module* module, Messenger* mess
 
     // Clear track data, deposit information, and link tables for next event
     clearEventInfo();
+
+    return {mc_particle_message, deposit_message};
 }
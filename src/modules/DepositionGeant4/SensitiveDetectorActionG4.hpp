@@ -12,7 +12,9 @@
 #ifndef ALLPIX_SIMPLE_DEPOSITION_MODULE_SENSITIVE_DETECTOR_ACTION_H
 #define ALLPIX_SIMPLE_DEPOSITION_MODULE_SENSITIVE_DETECTOR_ACTION_H
 
+#include <array>
 #include <memory>
+#include <utility>
 
 #include <G4VSensitiveDetector.hh>
 #include <G4WrapperProcess.hh>
@@ -41,12 +43,16 @@ namespace allpix {
          * @param charge_creation_energy Energy needed per deposited charge
          * @param fano_factor Fano factor for fluctuations in the energy fraction going into e/h pair creation
          * @param cutoff_time Cut-off time for the creation of secondary particles
+         * @param aggregation_length Edge length of the voxels consecutive steps of a track are merged in, zero to disable
+         * @param aggregation_charge Number of charges up to which consecutive steps of a track are merged, zero to disable
          */
         SensitiveDetectorActionG4(const std::shared_ptr<Detector>& detector,
                                   TrackInfoManager* track_info_manager,
                                   double charge_creation_energy,
                                   double fano_factor,
-                                  double cutoff_time);
+                                  double cutoff_time,
+                                  double aggregation_length = 0,
+                                  unsigned int aggregation_charge = 0);
 
         /**
          * @brief Get total number of charges deposited in the sensitive device bound to this action
@@ -99,8 +105,19 @@ namespace allpix {
          * @param module The module which is responsible for dispatching the message
          * @param messenger The messenger used to dispatch it
          * @param event Event to dispatch the messages to
+         * @return The dispatched MCParticle message and DepositedCharge message, the latter empty if there are no deposits
          */
-        void dispatchMessages(Module* module, Messenger* messenger, Event* event);
+        std::pair<std::shared_ptr<MCParticleMessage>, std::shared_ptr<DepositedChargeMessage>>
+        dispatchMessages(Module* module, Messenger* messenger, Event* event);
+
+        /**
+         * @brief Create the MCParticle and DepositedCharge messages of the current event without dispatching them
+         * @return The MCParticle message and DepositedCharge message, the latter empty if there are no deposits
+         *
+         * The event information is cleared afterwards. The particles refer to the tracks of the thread-local track manager,
+         * which therefore needs to hold the tracks of the same event.
+         */
+        std::pair<std::shared_ptr<MCParticleMessage>, std::shared_ptr<DepositedChargeMessage>> createMessages();
 
     private:
         std::shared_ptr<Detector> detector_;
@@ -111,6 +128,28 @@ namespace allpix {
         double fano_factor_;
         double cutoff_time_;
 
+        /**
+         * @brief Merge a step into the last stored deposit if it belongs to the same track and aggregation criteria are met
+         * @param position Local position of the step
+         * @param voxel Index of the aggregation voxel the step is located in
+         * @param charge Number of charges created in the step
+         * @param energy Energy deposited in the step
+         * @param time Global time of the step
+         * @param track_id Identifier of the track the step belongs to
+         * @return True if the step has been merged, false if a new deposit needs to be stored
+         */
+        bool aggregate_deposit(const ROOT::Math::XYZPoint& position,
+                               const std::array<long, 3>& voxel,
+                               unsigned int charge,
+                               double energy,
+                               double time,
+                               int track_id);
+
+        // Settings for the aggregation of consecutive steps
+        double aggregation_length_;
+        unsigned int aggregation_charge_;
+        bool aggregate_{};
+
         /**
          * Random number generator for e/h pair creation fluctuation
          * @note It is okay to keep a separate random number generator here because instances of this class are thread_local
@@ -129,24 +168,31 @@ namespace allpix {
         std::vector<unsigned int> deposit_charge_;
         std::vector<double> deposit_energy_;
         std::vector<double> deposit_time_;
+        // Aggregation voxel of the last stored deposit and number of steps stored in deposits
+        std::array<long, 3> deposit_voxel_{};
+        unsigned int deposit_steps_{};
 
-        // List of begin points for tracks
-        std::map<int, ROOT::Math::XYZPoint> track_begin_;
-        // List of end points for tracks
-        std::map<int, ROOT::Math::XYZPoint> track_end_;
-        // Parent of all mc tracks
-        std::map<int, int> track_parents_;
-        // PDG code of the tracks
-        std::map<int, int> track_pdg_;
-        // Arrival timestamp of the tracks
-        std::map<int, double> track_time_;
-        // Total charge by track
-        std::map<int, unsigned int> track_charge_;
+        /**
+         * @brief Information about a track passing through the sensor
+         */
+        struct TrackRecord {
+            int id;
+            int parent_id;
+            int pdg_code;
+            double time;
+            ROOT::Math::XYZPoint begin;
+            ROOT::Math::XYZPoint end;
+            unsigned int charge;
+        };
+
+        // Tracks seen in this sensor, ordered by track id when dispatching
+        std::vector<TrackRecord> tracks_;
+        // Map from track id to the index in the list of tracks, which equals the mc particle index, or -1 if not seen. Track
+        // ids are assigned consecutively, the vector is only reset for tracks seen and retains its size across events
+        std::vector<long> track_index_;
 
         // Map from deposit index to track id
         std::vector<int> deposit_to_id_;
-        // Map from track id to mc particle index
-        std::map<int, size_t> id_to_particle_;
     };
 } // namespace allpix
 
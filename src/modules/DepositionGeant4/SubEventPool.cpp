@@ -0,0 +1,104 @@
+/**
+ * @file
+ * @brief Implements the pool of Geant4 worker threads simulating sub-events
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "SubEventPool.hpp"
+
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+SubEventPool::SubEventPool(unsigned int num_threads,
+                           std::function<void()> initialize_function,
+                           std::function<void()> finalize_function)
+    : initialize_function_(std::move(initialize_function)), finalize_function_(std::move(finalize_function)) {
+    threads_.reserve(num_threads);
+    for(unsigned int i = 0; i < num_threads; ++i) {
+        threads_.emplace_back(&SubEventPool::worker, this);
+    }
+
+    // Wait for all threads to be ready, such that Geant4 initialization errors are reported during module initialization
+    std::unique_lock<std::mutex> lock(mutex_);
+    initialized_condition_.wait(lock, [this]() { return initialized_threads_ == threads_.size(); });
+    if(exception_) {
+        lock.unlock();
+        stop();
+        std::rethrow_exception(exception_);
+    }
+}
+
+SubEventPool::~SubEventPool() { stop(); }
+
+std::future<DepositCache::EventRecord> SubEventPool::submit(Task task) {
+    std::packaged_task<DepositCache::EventRecord()> packaged_task(std::move(task));
+    auto future = packaged_task.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(std::move(packaged_task));
+    }
+    condition_.notify_one();
+    return future;
+}
+
+void SubEventPool::worker() {
+    bool initialized = true;
+    try {
+        initialize_function_();
+    } catch(...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!exception_) {
+            exception_ = std::current_exception();
+        }
+        initialized = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++initialized_threads_;
+    }
+    initialized_condition_.notify_all();
+    if(!initialized) {
+        return;
+    }
+
+    while(true) {
+        std::packaged_task<DepositCache::EventRecord()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return done_ || !queue_.empty(); });
+            if(queue_.empty()) {
+                break;
+            }
+            task = std::move(queue_.front());
+            queue_.pop();
+        }
+
+        // Exceptions are stored in the future of the task
+        task();
+    }
+
+    try {
+        finalize_function_();
+    } catch(std::exception& e) {
+        LOG(ERROR) << "Failed to finalize sub-event thread: " << e.what();
+    }
+}
+
+void SubEventPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+    }
+    condition_.notify_all();
+    for(auto& thread : threads_) {
+        if(thread.joinable()) {
+            thread.join();
+        }
+    }
+}
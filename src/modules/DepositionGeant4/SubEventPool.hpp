@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @brief Defines the pool of Geant4 worker threads simulating sub-events
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_DEPOSITION_MODULE_SUB_EVENT_POOL_H
+#define ALLPIX_DEPOSITION_MODULE_SUB_EVENT_POOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "DepositCache.hpp"
+
+namespace allpix {
+    /**
+     * @brief Pool of threads simulating sub-events of a single event in parallel
+     *
+     * Every thread owns its own Geant4 worker run manager and sensitive detectors, which are set up by the initialization
+     * function when the thread is started and torn down by the finalization function before it exits. The threads are not
+     * registered with the framework thread pool and therefore share the thread number of the main thread.
+     */
+    class SubEventPool {
+    public:
+        using Task = std::function<DepositCache::EventRecord()>;
+
+        /**
+         * @brief Start the threads and wait until all of them have been initialized
+         * @param num_threads Number of threads
+         * @param initialize_function Function executed by every thread when it starts
+         * @param finalize_function Function executed by every thread before it exits
+         * @throws Exception thrown by the initialization function of any thread
+         */
+        SubEventPool(unsigned int num_threads,
+                     std::function<void()> initialize_function,
+                     std::function<void()> finalize_function);
+
+        /**
+         * @brief Finalize and join all threads, after completing the tasks remaining in the queue
+         */
+        ~SubEventPool();
+
+        /// @{
+        /**
+         * @brief Copying or moving the pool is not allowed
+         */
+        SubEventPool(const SubEventPool&) = delete;
+        SubEventPool& operator=(const SubEventPool&) = delete;
+        SubEventPool(SubEventPool&&) = delete;
+        SubEventPool& operator=(SubEventPool&&) = delete;
+        /// @}
+
+        /**
+         * @brief Queue the simulation of a sub-event
+         * @param task Function simulating the sub-event on the calling thread
+         * @return Future holding the record of the sub-event, or the exception thrown by the task
+         */
+        std::future<DepositCache::EventRecord> submit(Task task);
+
+    private:
+        /**
+         * @brief Main loop of every thread
+         */
+        void worker();
+
+        /**
+         * @brief Stop and join all threads
+         */
+        void stop();
+
+        std::function<void()> initialize_function_;
+        std::function<void()> finalize_function_;
+
+        std::queue<std::packaged_task<DepositCache::EventRecord()>> queue_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool done_{};
+
+        // Initialization status, the first exception thrown during initialization is propagated to the constructor
+        unsigned int initialized_threads_{};
+        std::condition_variable initialized_condition_;
+        std::exception_ptr exception_;
+
+        std::vector<std::thread> threads_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_DEPOSITION_MODULE_SUB_EVENT_POOL_H */
@@ -15,36 +15,45 @@ using namespace allpix;
 
 TrackInfoManager::TrackInfoManager(bool record_all) : counter_(1), record_all_(record_all) {}
 
+/**
+ * Sets an element of a vector indexed by track id, growing the vector if required
+ */
+template <typename T> static void set_by_id(std::vector<T>& vector, int id, T value) {
+    auto index = static_cast<size_t>(id);
+    if(index >= vector.size()) {
+        vector.resize(index + 1);
+    }
+    vector[index] = value;
+}
+
 std::unique_ptr<TrackInfoG4> TrackInfoManager::makeTrackInfo(const G4Track* const track) {
     auto custom_id = counter_++;
     auto G4ParentID = track->GetParentID();
-    auto parent_track_id = G4ParentID == 0 ? G4ParentID : g4_to_custom_id_.at(G4ParentID);
-    g4_to_custom_id_[track->GetTrackID()] = custom_id;
-    track_id_to_parent_id_[custom_id] = parent_track_id;
+    auto parent_track_id = G4ParentID == 0 ? G4ParentID : g4_to_custom_id_.at(static_cast<size_t>(G4ParentID));
+    set_by_id(g4_to_custom_id_, track->GetTrackID(), custom_id);
+    set_by_id(track_id_to_parent_id_, custom_id, parent_track_id);
     return std::make_unique<TrackInfoG4>(custom_id, parent_track_id, track);
 }
 
 void TrackInfoManager::setTrackInfoToBeStored(int track_id) {
-    auto element = std::find(to_store_track_ids_.begin(), to_store_track_ids_.end(), track_id);
-    // If track id is not present we add it, otherwise skip as we only need each track once
-    if(element == to_store_track_ids_.end()) {
-        to_store_track_ids_.emplace_back(track_id);
-    }
+    // Flagging a track id repeatedly has no effect as we only need each track once
+    set_by_id(to_store_track_ids_, track_id, true);
 }
 
 void TrackInfoManager::storeTrackInfo(std::unique_ptr<TrackInfoG4> the_track_info) {
     auto track_id = the_track_info->getID();
-    auto element = std::find(to_store_track_ids_.begin(), to_store_track_ids_.end(), track_id);
+    auto index = static_cast<size_t>(track_id);
+    auto to_store = (index < to_store_track_ids_.size() && to_store_track_ids_[index]);
 
-    if(record_all_ || element != to_store_track_ids_.end()) {
+    if(record_all_ || to_store) {
         LOG(DEBUG) << "Storing MCTrack with ID " << track_id;
         stored_track_infos_.push_back(std::move(the_track_info));
     } else {
         LOG(DEBUG) << "Not storing MCTrack with ID " << track_id;
     }
 
-    if(element != to_store_track_ids_.end()) {
-        to_store_track_ids_.erase(element);
+    if(to_store) {
+        to_store_track_ids_[index] = false;
     }
 }
 
@@ -59,27 +68,34 @@ void TrackInfoManager::resetTrackInfoManager() {
     id_to_track_.clear();
 }
 
-void TrackInfoManager::dispatchMessage(Module* module, Messenger* messenger, Event* event) {
+std::shared_ptr<MCTrackMessage> TrackInfoManager::dispatchMessage(Module* module, Messenger* messenger, Event* event) {
+    auto mc_track_message = createMessage();
+    messenger->dispatchMessage(module, mc_track_message, event);
+    return mc_track_message;
+}
+
+std::shared_ptr<MCTrackMessage> TrackInfoManager::createMessage() {
     set_all_track_parents();
     IFLOG(DEBUG) {
-        LOG(DEBUG) << "Dispatching " << stored_tracks_.size() << " MCTrack(s) from TrackInfoManager::dispatchMessage()";
+        LOG(DEBUG) << "Creating message with " << stored_tracks_.size() << " MCTrack(s) in TrackInfoManager";
         for(auto const& mc_track : stored_tracks_) {
             LOG(DEBUG) << "MCTrack originates at: " << Units::display(mc_track.getStartPoint(), {"mm", "um"})
                        << " and terminates at: " << Units::display(mc_track.getEndPoint(), {"mm", "um"});
         }
     }
-    auto mc_track_message = std::make_shared<MCTrackMessage>(std::move(stored_tracks_));
-    messenger->dispatchMessage(module, mc_track_message, event);
+    return std::make_shared<MCTrackMessage>(std::move(stored_tracks_));
 }
 
 MCTrack const* TrackInfoManager::findMCTrack(int track_id) const {
-    auto it = id_to_track_.find(track_id);
-    return (it == id_to_track_.end()) ? nullptr : it->second;
+    auto index = static_cast<size_t>(track_id);
+    return (track_id < 0 || index >= id_to_track_.size()) ? nullptr : id_to_track_[index];
 }
 
 void TrackInfoManager::createMCTracks() {
     // Reserve size so we don't move the vector around and change addresses:
     stored_tracks_.reserve(stored_track_infos_.size());
+    stored_track_ids_.reserve(stored_track_infos_.size());
+    id_to_track_.assign(static_cast<size_t>(counter_), nullptr);
 
     for(auto& track_info : stored_track_infos_) {
         stored_tracks_.emplace_back(track_info->getStartPoint(),
@@ -96,7 +112,7 @@ void TrackInfoManager::createMCTracks() {
                                     track_info->getTotalEnergyInitial(),
                                     track_info->getTotalEnergyFinal());
 
-        id_to_track_[track_info->getID()] = &stored_tracks_.back();
+        id_to_track_.at(static_cast<size_t>(track_info->getID())) = &stored_tracks_.back();
         stored_track_ids_.emplace_back(track_info->getID());
     }
 }
@@ -104,7 +120,7 @@ void TrackInfoManager::createMCTracks() {
 void TrackInfoManager::set_all_track_parents() {
     for(size_t ix = 0; ix < stored_track_ids_.size(); ++ix) {
         auto track_id = stored_track_ids_[ix];
-        auto parent_id = track_id_to_parent_id_[track_id];
+        auto parent_id = track_id_to_parent_id_[static_cast<size_t>(track_id)];
         stored_tracks_[ix].setParent(findMCTrack(parent_id));
     }
 }
@@ -13,7 +13,8 @@
 #ifndef TrackInfoManager_H
 #define TrackInfoManager_H 1
 
-#include <map>
+#include <memory>
+#include <vector>
 
 #include "G4Track.hh"
 #include "TrackInfoG4.hpp"
@@ -73,8 +74,15 @@ namespace allpix {
          * @param module The module which is responsible for dispatching the message
          * @param messenger The messenger used to dispatch it
          * @param event The event to dispatch the message to
+         * @return The dispatched message
          */
-        void dispatchMessage(Module* module, Messenger* messenger, Event* event);
+        std::shared_ptr<MCTrackMessage> dispatchMessage(Module* module, Messenger* messenger, Event* event);
+
+        /**
+         * @brief Move the stored tracks into a MCTrackMessage without dispatching it
+         * @return The created message
+         */
+        std::shared_ptr<MCTrackMessage> createMessage();
 
         /**
          * @brief Populate the #stored_tracks_ with MCTrack objects
@@ -105,20 +113,23 @@ namespace allpix {
         // Store configuration whether all tracks or only those connected to sensor should be stored
         bool record_all_{};
 
+        // Both Geant4 and custom track ids are assigned consecutively, all lookup tables are therefore vectors indexed by
+        // the respective id. Clearing them between events keeps their capacity, avoiding reallocations in later events.
+
         // Geant4 id to custom id translation
-        std::map<int, int> g4_to_custom_id_{};
+        std::vector<int> g4_to_custom_id_;
         // Custom id to custom parent id tracking
-        std::map<int, int> track_id_to_parent_id_{};
-        // List of track ids to be stored if they are provided via #storeTrackInfo
-        std::vector<int> to_store_track_ids_;
+        std::vector<int> track_id_to_parent_id_;
+        // Flags for the custom ids of tracks to be stored if they are provided via #storeTrackInfo
+        std::vector<bool> to_store_track_ids_;
         // The TrackInfoG4 instances which are handed over to this track manager
         std::vector<std::unique_ptr<TrackInfoG4>> stored_track_infos_;
         // The MCTrack vector which is dispatched via #dispatchMessage
         std::vector<MCTrack> stored_tracks_;
         // Ids ins same order as tracks stored in #stored_tracks_
         std::vector<int> stored_track_ids_;
-        // Id to index in #stored_tracks_ for easier handling
-        std::map<int, MCTrack const*> id_to_track_;
+        // Custom id to pointer into #stored_tracks_ for easier handling
+        std::vector<MCTrack const*> id_to_track_;
     };
 } // namespace allpix
 #endif /* TrackInfoManager_H */
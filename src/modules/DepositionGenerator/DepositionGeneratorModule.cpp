@@ -36,10 +36,13 @@ DepositionGeneratorModule::DepositionGeneratorModule(Configuration& config,
     // Enable multithreading of this module if multithreading is enabled
     allow_multithreading();
 
-    // Do *not* waive sequence requirement - we're reading from file and this should happen sequentially
+    // Do *not* waive sequence requirement - we're reading from file and this should happen sequentially unless the input
+    // file is indexed for random access, which is decided after opening the file
     waive_sequence_requirement(false);
 
     file_model_ = config_.get<PrimariesReader::FileModel>("model");
+    config_.setDefault("indexed_reading", false);
+    config_.setDefault("read_ahead", 16);
 
     // Force source type and position:
     config_.set("source_type", "generator");
@@ -47,6 +50,9 @@ DepositionGeneratorModule::DepositionGeneratorModule(Configuration& config,
     config_.set("source_position", ROOT::Math::XYZPoint());
     // Force number of particles to one, we are always reading a single generator event per event
     config_.set("number_of_particles", 1);
+    // Disable sub-events, the primaries are requested for the event number of the thread processing the event
+    config_.set("sub_event_size", 0);
+    config_.set("sub_event_workers", 0);
 
     // Add the particle source position to the geometry
     geo_manager_->addPoint(config_.get<ROOT::Math::XYZPoint>("source_position", ROOT::Math::XYZPoint()));
@@ -67,6 +73,12 @@ void DepositionGeneratorModule::initialize() {
         throw InvalidValueError(config_, "model", "Unsupported data file model");
     }
 
+    // Events can be processed in any order if the reader provides random access
+    if(reader_->isIndexed()) {
+        LOG(DEBUG) << "Input file indexed, waiving sequence requirement";
+        waive_sequence_requirement();
+    }
+
     // Call upstream initialization method
     DepositionGeant4Module::initialize();
 }
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * @brief Implements the indexed access shared by the particle readers
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "PrimariesReader.hpp"
+
+#include <algorithm>
+
+#include "core/module/exceptions.h"
+#include "core/utils/log.h"
+
+using namespace allpix;
+
+thread_local uint64_t PrimariesReader::event_num_ = 0;
+
+void PrimariesReader::enable_index(uint64_t last_event, uint64_t read_ahead) {
+    indexed_ = true;
+    last_event_ = last_event;
+    read_ahead_ = read_ahead;
+    next_read_ = 0;
+    cache_.clear();
+}
+
+std::vector<PrimariesReader::Particle> PrimariesReader::get_indexed_particles() {
+    // Generator events are counted from zero, framework events from one
+    auto generator_event = eventNum() - 1;
+    if(generator_event > last_event_) {
+        throw EndOfRunException("Requesting end of run: end of file reached");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = cache_.find(generator_event);
+    if(iter == cache_.end()) {
+        // Every event is requested once, so only events beyond the ones read before need to be read ahead
+        iter = cache_.emplace(generator_event, read_event(generator_event)).first;
+        auto first = std::max(next_read_, generator_event + 1);
+        auto last = std::min(last_event_, generator_event + read_ahead_);
+        for(auto event = first; event <= last; ++event) {
+            cache_.emplace(event, read_event(event));
+        }
+        next_read_ = std::max(next_read_, last + 1);
+        LOG(TRACE) << "Read generator event " << generator_event << " and events up to " << last << " into cache";
+    }
+
+    auto particles = std::move(iter->second);
+    cache_.erase(iter);
+    return particles;
+}
@@ -12,7 +12,10 @@
 #ifndef ALLPIX_GENERATOR_DEPOSITION_MODULE_READER_H
 #define ALLPIX_GENERATOR_DEPOSITION_MODULE_READER_H
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <G4ThreeVector.hh>
 
@@ -99,8 +102,8 @@ namespace allpix {
 
         /**
          * Purely virtual method to obtain a vector of primary particles for the current event. This methods needs to be
-         * implemented by derived classes which implement a specific file format. This method normally needs to be called
-         * sequentially and is not thread-safe.
+         * implemented by derived classes which implement a specific file format. This method needs to be called
+         * sequentially and is not thread-safe unless the reader has been indexed, see \ref isIndexed().
          * @return Vector of primary particles
          */
         virtual std::vector<Particle> getParticles() = 0;
@@ -112,14 +115,52 @@ namespace allpix {
          */
         uint64_t eventNum() const { return event_num_; }
 
+        /**
+         * Check if the reader provides random access to the events of the input file via an index. Indexed readers can be
+         * called concurrently from multiple threads, in any order of events.
+         * @return True if the reader is indexed
+         */
+        bool isIndexed() const { return indexed_; }
+
+    protected:
+        /**
+         * Enable random access after the derived reader has indexed its input file
+         * @param last_event  Highest generator event number available in the input file
+         * @param read_ahead  Number of subsequent events read into the cache with every requested event
+         */
+        void enable_index(uint64_t last_event, uint64_t read_ahead);
+
+        /**
+         * Read the primary particles of a generator event via the index. This method is only called with the reader lock
+         * held and needs to be implemented by derived classes.
+         * @param generator_event  Event number in the input file
+         * @return Vector of primary particles, empty if the event is not present in the input file
+         */
+        virtual std::vector<Particle> read_event(uint64_t generator_event) = 0;
+
+        /**
+         * Obtain the primary particles of the current event from the cache, reading the event and the following ones from
+         * the input file if necessary. This method is thread-safe.
+         * @return Vector of primary particles
+         */
+        std::vector<Particle> get_indexed_particles();
+
     private:
         /**
          * Helper method to set the currently processed event number from the \ref DepositionGeneratorModule::run() function.
-         * This is not thread-safe and should only be called in sequential processing mode.
+         * The event number is stored per thread, since the particles are requested from the thread processing the event.
          * @param event_num  Event number
          */
-        void set_event_num(uint64_t event_num) { event_num_ = event_num; }
-        uint64_t event_num_;
+        static void set_event_num(uint64_t event_num) { event_num_ = event_num; }
+        static thread_local uint64_t event_num_;
+
+        // Random access to the input file with a cache of events read ahead, protected by the mutex
+        bool indexed_{};
+        uint64_t last_event_{};
+        uint64_t read_ahead_{};
+        uint64_t next_read_{};
+        std::mutex mutex_;
+        std::map<uint64_t, std::vector<Particle>> cache_;
     };
 } // namespace allpix
 
@@ -11,6 +11,8 @@
 
 #include "PrimariesReaderGenie.hpp"
 
+#include <algorithm>
+
 #include "core/module/exceptions.h"
 #include "core/utils/log.h"
 
@@ -48,6 +50,19 @@ PrimariesReaderGenie::PrimariesReaderGenie(const Configuration& config) {
     check_tree_reader(config, py_);
     check_tree_reader(config, pz_);
     check_tree_reader(config, energy_);
+
+    // Map the generator event numbers to tree entries for random access
+    if(config.get<bool>("indexed_reading")) {
+        uint64_t last_event = 0;
+        for(Long64_t entry = 0; entry < tree_reader_->GetEntries(false); ++entry) {
+            tree_reader_->SetEntry(entry);
+            auto generator_event = static_cast<uint64_t>(*event_->Get());
+            index_.emplace(generator_event, entry);
+            last_event = std::max(last_event, generator_event);
+        }
+        enable_index(last_event, config.get<uint64_t>("read_ahead"));
+        LOG(INFO) << "Indexed " << index_.size() << " events for random access";
+    }
 }
 
 template <typename T>
@@ -64,6 +79,9 @@ void PrimariesReaderGenie::check_tree_reader(const Configuration& config, std::s
 }
 
 std::vector<PrimariesReader::Particle> PrimariesReaderGenie::getParticles() {
+    if(isIndexed()) {
+        return get_indexed_particles();
+    }
 
     // Read tree status:
     auto status = tree_reader_->GetEntryStatus();
@@ -80,13 +98,34 @@ std::vector<PrimariesReader::Particle> PrimariesReaderGenie::getParticles() {
         tree_reader_->Next();
         return {};
     }
+
+    // Return and advance to next tree entry:
+    auto particles = read_entry();
+    tree_reader_->Next();
+    return particles;
+}
+
+std::vector<PrimariesReader::Particle> PrimariesReaderGenie::read_event(uint64_t generator_event) {
+    auto entry = index_.find(generator_event);
+    if(entry == index_.end()) {
+        LOG(INFO) << "Event " << generator_event << " not found in input data, returning empty event";
+        return {};
+    }
+
+    auto status = tree_reader_->SetEntry(entry->second);
+    if(status != TTreeReader::kEntryValid) {
+        throw EndOfRunException("Problem reading from tree, error: " + std::to_string(static_cast<int>(status)));
+    }
+    return read_entry();
+}
+
+std::vector<PrimariesReader::Particle> PrimariesReaderGenie::read_entry() {
     LOG(INFO) << "Found " << px_->GetSize() << " primary particles";
 
     // Ensure all arrays have the same size:
     if(pdg_code_->GetSize() != energy_->GetSize() || pdg_code_->GetSize() != px_->GetSize() ||
        pdg_code_->GetSize() != py_->GetSize() || pdg_code_->GetSize() != pz_->GetSize()) {
         LOG(WARNING) << "Found broken event in input data, array sizes do not match, skipping";
-        tree_reader_->Next();
         return {};
     }
 
@@ -102,8 +141,5 @@ std::vector<PrimariesReader::Particle> PrimariesReaderGenie::getParticles() {
             pdg_code_->At(i), energy_->At(i), G4ThreeVector(px_->At(i), py_->At(i), pz_->At(i)), G4ThreeVector(0, 0, 0), 0);
         LOG(DEBUG) << "Adding particle with ID " << particles.back().pdg() << " energy " << particles.back().energy();
     }
-
-    // Return and advance to next tree entry:
-    tree_reader_->Next();
     return particles;
 }
@@ -14,6 +14,8 @@
 
 #include "PrimariesReader.hpp"
 
+#include <map>
+
 #include <TFile.h>
 #include <TTreeReader.h>
 #include <TTreeReaderArray.h>
@@ -32,12 +34,25 @@ namespace allpix {
 
         /**
          * Overwritten method to obtain the primary particles for the current event. This method needs to be called
-         * sequentially and is not thread-safe.
+         * sequentially and is not thread-safe unless the tree has been indexed.
          * @return Vector of primary particles
          */
         std::vector<Particle> getParticles() override;
 
     private:
+        /**
+         * Read the primary particles of a generator event from the tree entry found in the index
+         * @param generator_event  Event number in the input file
+         * @return Vector of primary particles
+         */
+        std::vector<Particle> read_event(uint64_t generator_event) override;
+
+        /**
+         * Convert the currently loaded tree entry into primary particles
+         * @return Vector of primary particles, empty if the entry is broken
+         */
+        std::vector<Particle> read_entry();
+
         // Helper to create and check tree branches
         template <typename T> void create_tree_reader(std::shared_ptr<T>& branch_ptr, const std::string& name);
         template <typename T> void check_tree_reader(const Configuration& config, std::shared_ptr<T> branch_ptr);
@@ -51,6 +66,9 @@ namespace allpix {
         std::shared_ptr<TTreeReaderArray<float>> py_;
         std::shared_ptr<TTreeReaderArray<float>> pz_;
         std::shared_ptr<TTreeReaderArray<float>> energy_;
+
+        // Tree entries of the generator events
+        std::map<uint64_t, Long64_t> index_;
     };
 } // namespace allpix
 
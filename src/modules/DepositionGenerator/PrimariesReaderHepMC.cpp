@@ -14,6 +14,9 @@
 #include "core/module/exceptions.h"
 #include "core/utils/log.h"
 
+#include <algorithm>
+#include <sstream>
+
 #include <HepMC3/Print.h>
 #include <HepMC3/ReaderAscii.h>
 #include <HepMC3/ReaderAsciiHepMC2.h>
@@ -32,6 +35,7 @@ PrimariesReaderHepMC::PrimariesReaderHepMC(const Configuration& config) {
     } else if(model == FileModel::HEPMC2) {
         file_path = config.getPathWithExtension("file_name", "txt", true);
         reader_ = std::make_unique<HepMC3::ReaderAsciiHepMC2>(file_path);
+        ascii_version_ = 2;
     } else if(model == FileModel::HEPMCROOT) {
         file_path = config.getPathWithExtension("file_name", "root", true);
         reader_ = std::make_unique<HepMC3::ReaderRoot>(file_path);
@@ -46,9 +50,66 @@ PrimariesReaderHepMC::PrimariesReaderHepMC(const Configuration& config) {
         throw InvalidValueError(config, "file_name", "could not open input file");
     }
     LOG(INFO) << "Successfully opened data file " << file_path;
+
+    if(config.get<bool>("indexed_reading")) {
+        if(model == FileModel::HEPMC || model == FileModel::HEPMC2) {
+            build_index(file_path, config.get<uint64_t>("read_ahead"));
+        } else {
+            LOG(WARNING) << "Indexed reading is only supported for ASCII files, reading events sequentially";
+        }
+    }
+}
+
+/**
+ * Events in HepMC3 and HepMC2 ASCII files start with a line beginning with "E" followed by the event number. Everything
+ * before the first event is header and run information, which is required to parse the events. The event listing is
+ * terminated by a line beginning with "HepMC::".
+ */
+void PrimariesReaderHepMC::build_index(const std::filesystem::path& file_path, uint64_t read_ahead) {
+    input_file_.open(file_path, std::ios::binary);
+    auto file_size = static_cast<std::streamoff>(std::filesystem::file_size(file_path));
+
+    // Record the start of every event and the end of the event listing
+    std::vector<std::pair<uint64_t, std::streamoff>> starts;
+    std::streamoff end_of_events = -1;
+    std::streamoff offset = 0;
+    std::string line;
+    while(std::getline(input_file_, line)) {
+        if(line.rfind("E ", 0) == 0) {
+            starts.emplace_back(std::stoull(line.substr(2)), offset);
+        } else if(line.rfind("HepMC::", 0) == 0 && !starts.empty() && end_of_events < 0) {
+            end_of_events = offset;
+        }
+        offset += static_cast<std::streamoff>(line.size()) + 1;
+    }
+    if(end_of_events < 0) {
+        end_of_events = std::min(offset, file_size);
+    }
+
+    uint64_t last_event = 0;
+    for(size_t i = 0; i < starts.size(); ++i) {
+        auto [generator_event, start] = starts[i];
+        auto end = (i + 1 < starts.size() ? starts[i + 1].second : end_of_events);
+        if(!index_.emplace(generator_event, std::make_pair(start, end - start)).second) {
+            throw ModuleError("Event " + std::to_string(generator_event) + " found twice in input data file");
+        }
+        last_event = std::max(last_event, generator_event);
+    }
+
+    // Keep the header to prepend it to every event
+    header_.resize(starts.empty() ? 0 : static_cast<size_t>(starts.front().second));
+    input_file_.clear();
+    input_file_.seekg(0);
+    input_file_.read(header_.data(), static_cast<std::streamsize>(header_.size()));
+
+    enable_index(last_event, read_ahead);
+    LOG(INFO) << "Indexed " << index_.size() << " events for random access";
 }
 
 std::vector<PrimariesReader::Particle> PrimariesReaderHepMC::getParticles() {
+    if(isIndexed()) {
+        return get_indexed_particles();
+    }
 
     // Read event from input file
     HepMC3::GenEvent evt(HepMC3::Units::MEV, HepMC3::Units::MM);
@@ -72,6 +133,42 @@ std::vector<PrimariesReader::Particle> PrimariesReaderHepMC::getParticles() {
         return {};
     }
 
+    return convert_event(evt);
+}
+
+std::vector<PrimariesReader::Particle> PrimariesReaderHepMC::read_event(uint64_t generator_event) {
+    auto entry = index_.find(generator_event);
+    if(entry == index_.end()) {
+        LOG(INFO) << "Event " << generator_event << " not found in input data, returning empty event";
+        return {};
+    }
+
+    // Parse the event together with the file header using a reader on an in-memory copy
+    auto [offset, size] = entry->second;
+    std::string data = header_;
+    data.resize(header_.size() + static_cast<size_t>(size));
+    input_file_.seekg(offset);
+    input_file_.read(data.data() + header_.size(), static_cast<std::streamsize>(size));
+    std::istringstream stream(data);
+
+    HepMC3::GenEvent evt(HepMC3::Units::MEV, HepMC3::Units::MM);
+    LOG(DEBUG) << "Reading event " << generator_event << " from HepMC3 file at offset " << offset;
+    std::unique_ptr<HepMC3::Reader> reader;
+    if(ascii_version_ == 2) {
+        reader = std::make_unique<HepMC3::ReaderAsciiHepMC2>(stream);
+    } else {
+        reader = std::make_unique<HepMC3::ReaderAscii>(stream);
+    }
+    // The stream ends with the event, the reader therefore flags its end and the event number is checked instead
+    reader->read_event(evt);
+    if(static_cast<uint64_t>(evt.event_number()) != generator_event) {
+        throw ModuleError("Could not read event " + std::to_string(generator_event) + " from input data file");
+    }
+
+    return convert_event(evt);
+}
+
+std::vector<PrimariesReader::Particle> PrimariesReaderHepMC::convert_event(HepMC3::GenEvent& evt) {
     // FIXME This prints to std::cout. We would need to pass a std::ostream as first parameter
     IFLOG(DEBUG) {
         HepMC3::Print::listing(evt);
@@ -102,6 +199,5 @@ std::vector<PrimariesReader::Particle> PrimariesReaderHepMC::getParticles() {
         }
     }
 
-    // Return and advance to next tree entry:
     return particles;
 }
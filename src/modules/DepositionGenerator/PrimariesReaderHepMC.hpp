@@ -14,6 +14,12 @@
 
 #include "PrimariesReader.hpp"
 
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+
 #include "HepMC3/GenEvent.h"
 #include "HepMC3/Reader.h"
 
@@ -31,13 +37,40 @@ namespace allpix {
 
         /**
          * Overwritten method to obtain the primary particles for the current event. This method needs to be called
-         * sequentially and is not thread-safe.
+         * sequentially and is not thread-safe unless the file has been indexed.
          * @return Vector of primary particles
          */
         std::vector<Particle> getParticles() override;
 
     private:
+        /**
+         * Record the byte offsets of all events in an ASCII file for random access
+         * @param file_path   Path of the input data file
+         * @param read_ahead  Number of subsequent events read into the cache with every requested event
+         */
+        void build_index(const std::filesystem::path& file_path, uint64_t read_ahead);
+
+        /**
+         * Read the primary particles of a generator event from the byte range found in the index
+         * @param generator_event  Event number in the input file
+         * @return Vector of primary particles
+         */
+        std::vector<Particle> read_event(uint64_t generator_event) override;
+
+        /**
+         * Convert the final state particles of a HepMC3 event into primary particles
+         * @param evt  HepMC3 event
+         * @return Vector of primary particles
+         */
+        static std::vector<Particle> convert_event(HepMC3::GenEvent& evt);
+
         std::shared_ptr<HepMC3::Reader> reader_;
+
+        // Index of the ASCII file with offset and size of every event, and the file header preceding the first event
+        std::ifstream input_file_;
+        std::map<uint64_t, std::pair<std::streamoff, std::streamoff>> index_;
+        std::string header_;
+        int ascii_version_{3};
     };
 } // namespace allpix
 
@@ -13,6 +13,7 @@
 
 #include <core/utils/distributions.h>
 #include <core/utils/log.h>
+#include <objects/DepositPoint.hpp>
 #include <objects/DepositedCharge.hpp>
 #include <objects/MCParticle.hpp>
 #include <tools/liang_barsky.h>
@@ -25,6 +26,8 @@
 #include <filesystem>
 #include <fstream>
 #include <iterator>
+#include <limits>
+#include <tuple>
 
 using namespace allpix;
 
@@ -87,6 +90,18 @@ DepositionLaserModule::DepositionLaserModule(Configuration& config, Messenger* m
         LOG(DEBUG) << "Photons will be generated as " << number_of_photons_ << " groups of " << group_photons_;
     }
 
+    config_.setDefault<bool>("compact_deposits", false);
+    compact_deposits_ = config_.get<bool>("compact_deposits");
+
+    if(config_.has("deposit_voxel_size")) {
+        deposit_voxel_size_ = config_.get<ROOT::Math::XYZVector>("deposit_voxel_size");
+        if(deposit_voxel_size_->x() <= 0 || deposit_voxel_size_->y() <= 0 || deposit_voxel_size_->z() <= 0) {
+            throw InvalidValueError(config_, "deposit_voxel_size", "Voxel size should be positive in all dimensions");
+        }
+        LOG(DEBUG) << "Photon absorption points will be merged in voxels of "
+                   << Units::display(deposit_voxel_size_.value(), {"um", "mm"});
+    }
+
     config_.setDefault<double>("pulse_duration", 0.5);
     pulse_duration_ = config_.get<double>("pulse_duration");
     LOG(DEBUG) << "Pulse duration: " << Units::display(pulse_duration_, "ns");
@@ -209,6 +224,71 @@ void DepositionLaserModule::initialize() {
         }
     }
 
+    // Cache transformations and global bounding boxes of all sensors and supported passive objects
+    auto add_volume = [&](std::shared_ptr<Detector> detector,
+                          std::string name,
+                          const ROOT::Math::XYZPoint& position,
+                          const ROOT::Math::Rotation3D& orientation,
+                          const ROOT::Math::XYZVector& size) {
+        ROOT::Math::Transform3D transform(orientation,
+                                          ROOT::Math::Translation3D(static_cast<ROOT::Math::XYZVector>(position)));
+        LaserVolume volume{std::move(detector),
+                           std::move(name),
+                           volumes_.size(),
+                           transform.Inverse(),
+                           orientation,
+                           orientation.Inverse(),
+                           size,
+                           {},
+                           {}};
+
+        // Enclose all corners of the box, with a margin to be conservative with respect to rounding
+        auto margin = 1e-9 * (1. + std::sqrt(static_cast<ROOT::Math::XYZVector>(position).Mag2() + size.Mag2()));
+        volume.lower.fill(std::numeric_limits<double>::max());
+        volume.upper.fill(std::numeric_limits<double>::lowest());
+        for(int corner = 0; corner < 8; ++corner) {
+            auto point = transform(ROOT::Math::XYZPoint((corner & 1) ? size.x() / 2 : -size.x() / 2,
+                                                        (corner & 2) ? size.y() / 2 : -size.y() / 2,
+                                                        (corner & 4) ? size.z() / 2 : -size.z() / 2));
+            std::array<double, 3> coordinates{point.x(), point.y(), point.z()};
+            for(size_t axis = 0; axis < 3; ++axis) {
+                volume.lower[axis] = std::min(volume.lower[axis], coordinates[axis] - margin);
+                volume.upper[axis] = std::max(volume.upper[axis], coordinates[axis] + margin);
+            }
+        }
+        volumes_.push_back(std::move(volume));
+    };
+
+    for(auto& detector : detectors) {
+        if(detector->getModel()->getSensorMaterial() != SensorMaterial::SILICON && !is_user_optics_) {
+            continue;
+        }
+        add_volume(detector,
+                   detector->getName(),
+                   detector->getPosition(),
+                   detector->getOrientation(),
+                   detector->getModel()->getSensorSize());
+    }
+    for(const auto& item : passive_configs) {
+        if(item.get<std::string>("type") != "box") {
+            continue;
+        }
+        auto [passive_position, passive_orientation] = geo_manager_->getPassiveElementOrientation(item.getName());
+        add_volume(nullptr,
+                   item.getName(),
+                   passive_position,
+                   passive_orientation,
+                   item.get<ROOT::Math::XYZVector>("size"));
+    }
+
+    // Sort the volumes into a bounding volume hierarchy
+    bvh_nodes_.clear();
+    if(!volumes_.empty()) {
+        build_bvh(0, volumes_.size());
+    }
+    LOG(DEBUG) << "Built bounding volume hierarchy with " << bvh_nodes_.size() << " nodes for " << volumes_.size()
+               << " volumes";
+
     // Create Histograms
     if(output_plots_) {
         LOG(DEBUG) << "Initializing histograms";
@@ -271,7 +351,10 @@ void DepositionLaserModule::run(Event* event) {
     // Containers for output messages
 
     std::map<std::shared_ptr<Detector>, std::vector<MCParticle>> mc_particles;
-    std::map<std::shared_ptr<Detector>, std::vector<DepositedCharge>> deposited_charges;
+    std::map<std::shared_ptr<Detector>, std::vector<DepositPoint>> deposited_charges;
+
+    // Absorption points merged per voxel, if requested
+    std::map<std::shared_ptr<Detector>, std::map<std::tuple<long, long, long>, PhotonVoxel>> voxels;
 
     // Lambda generator to yield pulse shape
     auto yield_starting_time = [&]() {
@@ -351,12 +434,32 @@ void DepositionLaserModule::run(Event* event) {
             h_deposited_charge_shapes_[hit.detector]->Fill(hit_local.X(), hit_local.Y(), hit_local.Z());
         }
 
+        // Accumulate the photon in its voxel instead of creating individual objects
+        if(deposit_voxel_size_.has_value()) {
+            auto voxel_index = [](double position, double size) { return static_cast<long>(std::floor(position / size)); };
+            auto& voxel = voxels[hit.detector][std::make_tuple(voxel_index(hit_local.x(), deposit_voxel_size_->x()),
+                                                               voxel_index(hit_local.y(), deposit_voxel_size_->y()),
+                                                               voxel_index(hit_local.z(), deposit_voxel_size_->z()))];
+            if(voxel.photons == 0 || time_entry_global < voxel.time_entry_global) {
+                voxel.time_entry_local = time_entry_local;
+                voxel.time_entry_global = time_entry_global;
+            }
+            ++voxel.photons;
+            voxel.entry_local += static_cast<ROOT::Math::XYZVector>(entry_local);
+            voxel.entry_global += static_cast<ROOT::Math::XYZVector>(hit.entry_global);
+            voxel.hit_local += static_cast<ROOT::Math::XYZVector>(hit_local);
+            voxel.hit_global += static_cast<ROOT::Math::XYZVector>(hit.hit_global);
+            voxel.time_hit_local += time_hit_local;
+            voxel.time_hit_global += time_hit_global;
+            continue;
+        }
+
         // If that is a first hit in this detector, create map entries
         if(mc_particles.count(hit.detector) == 0) {
             mc_particles[hit.detector] = std::vector<MCParticle>();
         }
         if(deposited_charges.count(hit.detector) == 0) {
-            deposited_charges[hit.detector] = std::vector<DepositedCharge>();
+            deposited_charges[hit.detector] = std::vector<DepositPoint>();
         }
 
         // Construct all necessary objects in-place
@@ -370,45 +473,91 @@ void DepositionLaserModule::run(Event* event) {
                                                 time_entry_global);
         // Count electrons and holes:
         mc_particles[hit.detector].back().setTotalDepositedCharge(2);
-
-        // allpix::DepositedCharge for electron
-        deposited_charges[hit.detector].emplace_back(hit_local,
-                                                     hit.hit_global,
-                                                     CarrierType::ELECTRON,
-                                                     group_photons_, // value
-                                                     time_hit_local,
-                                                     time_hit_global);
-
-        // allpix::DepositedCharge for hole
-        deposited_charges[hit.detector].emplace_back(hit_local,
-                                                     hit.hit_global,
-                                                     CarrierType::HOLE,
-                                                     group_photons_, // value
-                                                     time_hit_local,
-                                                     time_hit_global);
+        auto mc_particle_index = mc_particles[hit.detector].size() - 1;
+
+        // Deposit for electron
+        deposited_charges[hit.detector].push_back({hit_local,
+                                                   hit.hit_global,
+                                                   CarrierType::ELECTRON,
+                                                   static_cast<unsigned int>(group_photons_),
+                                                   time_hit_local,
+                                                   time_hit_global,
+                                                   mc_particle_index});
+
+        // Deposit for hole
+        deposited_charges[hit.detector].push_back({hit_local,
+                                                   hit.hit_global,
+                                                   CarrierType::HOLE,
+                                                   static_cast<unsigned int>(group_photons_),
+                                                   time_hit_local,
+                                                   time_hit_global,
+                                                   mc_particle_index});
 
     } // loop over photons
 
-    LOG(INFO) << "Registered hits in " << mc_particles.size() << " detectors";
+    // Create one MCParticle and one pair of deposits per voxel at the mean absorption point of its photons
+    for(const auto& [detector, detector_voxels] : voxels) {
+        for(const auto& [index, voxel] : detector_voxels) {
+            auto photons = static_cast<double>(voxel.photons);
+            auto charge = static_cast<unsigned int>(voxel.photons * group_photons_);
+            auto hit_local = ROOT::Math::XYZPoint(voxel.hit_local / photons);
+            auto hit_global = ROOT::Math::XYZPoint(voxel.hit_global / photons);
 
-    // After all the containers are filled, assign MCParticle links in DepositedCharges
-
-    for(const auto& [detector, data] : mc_particles) {
-        for(size_t i = 0; i < size(mc_particles[detector]); ++i) {
-            deposited_charges[detector][2 * i].setMCParticle(&(data[i]));
-            deposited_charges[detector][2 * i + 1].setMCParticle(&(data[i]));
+            mc_particles[detector].emplace_back(ROOT::Math::XYZPoint(voxel.entry_local / photons),
+                                                ROOT::Math::XYZPoint(voxel.entry_global / photons),
+                                                hit_local,
+                                                hit_global,
+                                                22, // gamma
+                                                voxel.time_entry_local,
+                                                voxel.time_entry_global);
+            mc_particles[detector].back().setTotalDepositedCharge(2 * charge);
+            auto mc_particle_index = mc_particles[detector].size() - 1;
+
+            deposited_charges[detector].push_back({hit_local,
+                                                   hit_global,
+                                                   CarrierType::ELECTRON,
+                                                   charge,
+                                                   voxel.time_hit_local / photons,
+                                                   voxel.time_hit_global / photons,
+                                                   mc_particle_index});
+            deposited_charges[detector].push_back({hit_local,
+                                                   hit_global,
+                                                   CarrierType::HOLE,
+                                                   charge,
+                                                   voxel.time_hit_local / photons,
+                                                   voxel.time_hit_global / photons,
+                                                   mc_particle_index});
         }
     }
 
+    LOG(INFO) << "Registered hits in " << mc_particles.size() << " detectors";
+
     // Dispatch messages
     for(auto& [detector, data] : mc_particles) {
         LOG(INFO) << "    " << detector->getName() << ": " << data.size() << " hits";
         auto mcparticle_message = std::make_shared<MCParticleMessage>(std::move(data), detector);
         messenger_->dispatchMessage(this, mcparticle_message, event);
-    }
 
-    for(auto& [detector, data] : deposited_charges) {
-        auto charge_message = std::make_shared<DepositedChargeMessage>(std::move(data), detector);
+        // Lightweight deposits refer to their MCParticle by index, full deposit objects are only created if requested
+        auto& deposits = deposited_charges[detector];
+        if(compact_deposits_) {
+            auto charge_message = std::make_shared<DepositPointMessage>(std::move(deposits), detector, mcparticle_message);
+            messenger_->dispatchMessage(this, charge_message, event);
+            continue;
+        }
+
+        std::vector<DepositedCharge> charges;
+        charges.reserve(deposits.size());
+        for(const auto& deposit : deposits) {
+            charges.emplace_back(deposit.local_position,
+                                 deposit.global_position,
+                                 deposit.type,
+                                 deposit.charge,
+                                 deposit.local_time,
+                                 deposit.global_time,
+                                 &mcparticle_message->getData()[deposit.mc_particle]);
+        }
+        auto charge_message = std::make_shared<DepositedChargeMessage>(std::move(charges), detector);
         messenger_->dispatchMessage(this, charge_message, event);
     }
 }
@@ -540,40 +689,22 @@ std::optional<DepositionLaserModule::PhotonHit> DepositionLaserModule::track(con
 
     double c = TMath::C() * 100; // speed of light in mm/ns
 
-    std::vector<std::shared_ptr<Detector>> detectors = geo_manager_->getDetectors();
-    std::vector<std::pair<std::shared_ptr<Detector>, std::pair<double, double>>> intersection_segments;
-
-    for(auto& detector : detectors) {
-        if(detector->getModel()->getSensorMaterial() != SensorMaterial::SILICON && !is_user_optics_) {
-            continue;
-        }
-        auto intersection = intersect_with_sensor(detector, position, direction);
-        if(intersection) {
-            intersection_segments.emplace_back(std::make_pair(detector, intersection.value()));
-        }
-    }
-
-    if(intersection_segments.empty()) {
+    auto intersection = intersect_with_volumes(position, direction);
+    if(intersection.sensor == nullptr) {
         LOG(DEBUG) << "No intersections with sensitive detectors";
         return std::nullopt;
     }
 
-    auto it_first_detector = std::min_element(begin(intersection_segments),
-                                              end(intersection_segments),
-                                              [](const auto& p1, const auto& p2) { return p1.second < p2.second; });
-
-    auto detector = it_first_detector->first;
-    double t0 = it_first_detector->second.first;
+    const auto& volume = *intersection.sensor;
+    auto detector = volume.detector;
+    double t0 = intersection.sensor_distances.first;
 
-    auto intersect_passive = intersect_with_passives(position, direction);
-    if(intersect_passive) {
-        if(intersect_passive.value().first < t0) {
-            LOG(DEBUG) << "Absorbed by (" << intersect_passive.value().second << ") passive object";
-            return std::nullopt;
-        }
+    if(intersection.passive != nullptr && intersection.passive_distance < t0) {
+        LOG(DEBUG) << "Absorbed by (" << intersection.passive->name << ") passive object";
+        return std::nullopt;
     }
 
-    auto normal_vector = -1 * intersection_normal_vector(detector, position + direction * t0);
+    auto normal_vector = -1 * intersection_normal_vector(volume, position + direction * t0);
 
     double incidence_angle = angle(direction, normal_vector);
     double refraction_angle = asin(sin(incidence_angle) / refractive_index_);
@@ -591,8 +722,8 @@ std::optional<DepositionLaserModule::PhotonHit> DepositionLaserModule::track(con
     LOG(DEBUG) << "        direction after refraction: " << new_direction;
 
     // Intersect the refracted ray with the detector
-    auto intersection = intersect_with_sensor(detector, position + direction * t0, new_direction);
-    auto [t0_refract, t1_refract] = intersection.value();
+    auto refracted_intersection = intersect_with_volume(volume, position + direction * t0, new_direction);
+    auto [t0_refract, t1_refract] = refracted_intersection.value();
     double crossing_distance = t1_refract - t0_refract;
 
     LOG(DEBUG) << "        crossing_distance: " << Units::display(crossing_distance, {"um", "mm"});
@@ -611,89 +742,142 @@ std::optional<DepositionLaserModule::PhotonHit> DepositionLaserModule::track(con
                      t0 / c + penetration_depth / c * refractive_index_};
 }
 
-std::optional<std::pair<double, double>>
-DepositionLaserModule::intersect_with_sensor(const std::shared_ptr<const Detector>& detector,
-                                             const ROOT::Math::XYZPoint& position_global,
-                                             const ROOT::Math::XYZVector& direction_global) const {
-    // Obtain total sensor size
-    auto sensor = detector->getModel()->getSensorSize();
+size_t DepositionLaserModule::build_bvh(size_t first, size_t count) {
+    BVHNode node{};
+    node.lower.fill(std::numeric_limits<double>::max());
+    node.upper.fill(std::numeric_limits<double>::lowest());
+    for(size_t idx = first; idx < first + count; ++idx) {
+        for(size_t axis = 0; axis < 3; ++axis) {
+            node.lower[axis] = std::min(node.lower[axis], volumes_[idx].lower[axis]);
+            node.upper[axis] = std::max(node.upper[axis], volumes_[idx].upper[axis]);
+        }
+    }
 
-    // Transform original position and direction to a sensor-related coordinate system,
+    auto node_index = bvh_nodes_.size();
+    bvh_nodes_.push_back(node);
+    if(count <= 2) {
+        bvh_nodes_[node_index].first = first;
+        bvh_nodes_[node_index].count = count;
+        return node_index;
+    }
 
-    // Construct transformation from the sensor system to the global one
-    // * The rotation into the global coordinate system
-    // * The shift from the origin to the detector position
-    ROOT::Math::Rotation3D rotation_center(detector->getOrientation());
-    ROOT::Math::Translation3D translation_center(static_cast<ROOT::Math::XYZVector>(detector->getPosition()));
-    ROOT::Math::Transform3D transform_center(rotation_center, translation_center);
+    // Split the volumes at the median of their centers along the longest axis of the node
+    size_t axis = 0;
+    for(size_t idx = 1; idx < 3; ++idx) {
+        if(node.upper[idx] - node.lower[idx] > node.upper[axis] - node.lower[axis]) {
+            axis = idx;
+        }
+    }
+    auto begin = volumes_.begin() + static_cast<std::ptrdiff_t>(first);
+    std::nth_element(begin,
+                     begin + static_cast<std::ptrdiff_t>(count / 2),
+                     begin + static_cast<std::ptrdiff_t>(count),
+                     [axis](const LaserVolume& v1, const LaserVolume& v2) {
+                         return v1.lower[axis] + v1.upper[axis] < v2.lower[axis] + v2.upper[axis];
+                     });
+
+    auto left = build_bvh(first, count / 2);
+    auto right = build_bvh(first + count / 2, count - count / 2);
+    bvh_nodes_[node_index].left = left;
+    bvh_nodes_[node_index].right = right;
+    return node_index;
+}
 
-    // Apply inverse of that transformation
-    auto position_local = transform_center.Inverse()(position_global);
+std::optional<std::pair<double, double>>
+DepositionLaserModule::intersect_with_volume(const LaserVolume& volume,
+                                             const ROOT::Math::XYZPoint& position_global,
+                                             const ROOT::Math::XYZVector& direction_global) {
+    // Transform original position and direction to the coordinate system of the volume
+    auto position_local = volume.to_local(position_global);
 
     // Direction vector can directly be rotated
-    auto direction_local = detector->getOrientation().Inverse()(direction_global);
+    auto direction_local = volume.rotation_inverse(direction_global);
 
-    return LiangBarsky::intersectionDistances(direction_local, position_local, sensor);
+    return LiangBarsky::intersectionDistances(direction_local, position_local, volume.size);
 }
 
-std::optional<std::pair<double, std::string>>
-DepositionLaserModule::intersect_with_passives(const ROOT::Math::XYZPoint& position_global,
-                                               const ROOT::Math::XYZVector& direction_global) const {
-
-    std::optional<std::pair<double, std::string>> result{};
-    auto passive_configs = geo_manager_->getPassiveElements();
+DepositionLaserModule::VolumeIntersection
+DepositionLaserModule::intersect_with_volumes(const ROOT::Math::XYZPoint& position_global,
+                                              const ROOT::Math::XYZVector& direction_global) const {
+    VolumeIntersection result{};
+    if(bvh_nodes_.empty()) {
+        return result;
+    }
 
-    for(const auto& item : passive_configs) {
-        auto shape = item.get<std::string>("type");
-        if(shape != "box") {
-            continue;
+    // Distance along the line to the entry into a bounding box from a slab test, std::nullopt if the line misses the box
+    std::array<double, 3> position{position_global.x(), position_global.y(), position_global.z()};
+    std::array<double, 3> direction{direction_global.x(), direction_global.y(), direction_global.z()};
+    auto slab_test = [&](const std::array<double, 3>& lower, const std::array<double, 3>& upper) -> std::optional<double> {
+        double t_near = std::numeric_limits<double>::lowest();
+        double t_far = std::numeric_limits<double>::max();
+        for(size_t axis = 0; axis < 3; ++axis) {
+            if(direction[axis] == 0) {
+                if(position[axis] < lower[axis] || position[axis] > upper[axis]) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+            auto t_lower = (lower[axis] - position[axis]) / direction[axis];
+            auto t_upper = (upper[axis] - position[axis]) / direction[axis];
+            t_near = std::max(t_near, std::min(t_lower, t_upper));
+            t_far = std::min(t_far, std::max(t_lower, t_upper));
         }
+        if(t_near > t_far) {
+            return std::nullopt;
+        }
+        return t_near;
+    };
 
-        auto [passive_position, passive_orientation] = geo_manager_->getPassiveElementOrientation(item.getName());
-        auto passive_size = item.get<ROOT::Math::XYZVector>("size");
-
-        ROOT::Math::Rotation3D rotation_center(passive_orientation);
-        ROOT::Math::Translation3D translation_center(static_cast<ROOT::Math::XYZVector>(passive_position));
-        ROOT::Math::Transform3D transform_center(rotation_center, translation_center);
-        auto position_local = transform_center.Inverse()(position_global);
-        auto direction_local = rotation_center.Inverse()(direction_global);
-
-        auto intersect = LiangBarsky::intersectionDistances(direction_local, position_local, passive_size);
+    // Traverse the hierarchy, skipping nodes which are entered only behind the closest sensor found so far
+    std::vector<size_t> stack{0};
+    while(!stack.empty()) {
+        const auto& node = bvh_nodes_[stack.back()];
+        stack.pop_back();
 
-        if(!intersect) {
+        auto t_near = slab_test(node.lower, node.upper);
+        if(!t_near.has_value() || (result.sensor != nullptr && t_near.value() > result.sensor_distances.first)) {
             continue;
         }
 
-        double distance = intersect.value().first;
-
-        if(!result) {
-            result = {distance, item.getName()};
+        if(node.count == 0) {
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+            continue;
         }
 
-        if(distance < result.value().first) {
-            result = {distance, item.getName()};
+        for(size_t idx = node.first; idx < node.first + node.count; ++idx) {
+            const auto& volume = volumes_[idx];
+            auto distances = intersect_with_volume(volume, position_global, direction_global);
+            if(!distances.has_value()) {
+                continue;
+            }
+
+            // Ties are resolved in the order of definition of the volumes
+            if(volume.detector != nullptr) {
+                if(result.sensor == nullptr ||
+                   std::tie(distances->first, distances->second, volume.index) <
+                       std::tie(result.sensor_distances.first, result.sensor_distances.second, result.sensor->index)) {
+                    result.sensor = &volume;
+                    result.sensor_distances = distances.value();
+                }
+            } else if(result.passive == nullptr ||
+                      std::tie(distances->first, volume.index) < std::tie(result.passive_distance, result.passive->index)) {
+                result.passive = &volume;
+                result.passive_distance = distances->first;
+            }
         }
     }
 
     return result;
 }
 
-ROOT::Math::XYZVector DepositionLaserModule::intersection_normal_vector(const std::shared_ptr<const Detector>& detector,
-                                                                        const ROOT::Math::XYZPoint& position_global) const {
+ROOT::Math::XYZVector DepositionLaserModule::intersection_normal_vector(const LaserVolume& volume,
+                                                                        const ROOT::Math::XYZPoint& position_global) {
     // Obtain total sensor size
-    auto sensor = detector->getModel()->getSensorSize();
-
-    // Transform original position and direction to a sensor-related coordinate system,
-
-    // Construct transformation from the sensor system to the global one
-    // * The rotation into the global coordinate system
-    // * The shift from the origin to the detector position
-    ROOT::Math::Rotation3D rotation_center(detector->getOrientation());
-    ROOT::Math::Translation3D translation_center(static_cast<ROOT::Math::XYZVector>(detector->getPosition()));
-    ROOT::Math::Transform3D transform_center(rotation_center, translation_center);
+    auto sensor = volume.size;
 
-    // Apply inverse of that transformation
-    auto position_local = transform_center.Inverse()(position_global);
+    // Transform original position to the coordinate system of the volume
+    auto position_local = volume.to_local(position_global);
 
     std::vector<double> distances_to_faces = {abs(position_local.X() - sensor.X() / 2),
                                               abs(position_local.X() + sensor.X() / 2),
@@ -714,5 +898,5 @@ ROOT::Math::XYZVector DepositionLaserModule::intersection_normal_vector(const st
     auto iter_min = std::min_element(begin(distances_to_faces), end(distances_to_faces));
     size_t index_min = static_cast<size_t>(abs(iter_min - begin(distances_to_faces))); // avoid implicit conversion
 
-    return rotation_center(normals_to_faces[index_min]);
+    return volume.rotation(normals_to_faces[index_min]);
 }
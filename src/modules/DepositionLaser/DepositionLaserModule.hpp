@@ -13,10 +13,16 @@
  * Refer to the User's Manual for more details.
  */
 
+#include <array>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include <Math/Rotation3D.h>
+#include <Math/Transform3D.h>
 
 #include "core/config/Configuration.hpp"
 #include "core/geometry/GeometryManager.hpp"
@@ -52,6 +58,45 @@ namespace allpix {
             double time_to_hit;
         };
 
+        // Box volume of a sensor or a passive object with cached transformations and global bounding box
+        struct LaserVolume { // NOLINT
+            std::shared_ptr<Detector> detector; // Null for passive objects
+            std::string name;
+            size_t index;
+            ROOT::Math::Transform3D to_local;
+            ROOT::Math::Rotation3D rotation;
+            ROOT::Math::Rotation3D rotation_inverse;
+            ROOT::Math::XYZVector size;
+            std::array<double, 3> lower;
+            std::array<double, 3> upper;
+        };
+
+        // Node of the bounding volume hierarchy, referring either to two child nodes or to a range of volumes
+        struct BVHNode { // NOLINT
+            std::array<double, 3> lower;
+            std::array<double, 3> upper;
+            size_t left;
+            size_t right;
+            size_t first;
+            size_t count; // Number of volumes of leaf nodes, zero for inner nodes
+        };
+
+        // First sensor along a track and closest passive object in front of it, if any
+        struct VolumeIntersection { // NOLINT
+            const LaserVolume* sensor{};
+            std::pair<double, double> sensor_distances{};
+            const LaserVolume* passive{};
+            double passive_distance{};
+        };
+
+        // Absorption points of photons merged within one voxel of a sensor
+        struct PhotonVoxel { // NOLINT
+            size_t photons{};
+            ROOT::Math::XYZVector entry_local{}, entry_global{}, hit_local{}, hit_global{};
+            double time_entry_local{}, time_entry_global{};
+            double time_hit_local{}, time_hit_global{};
+        };
+
     public:
         /**
          * @brief Constructor for this unique module
@@ -78,28 +123,33 @@ namespace allpix {
 
     private:
         /**
-         * @brief Check intersection of the given track with the given detector
+         * @brief Build the bounding volume hierarchy over a range of volumes
+         * Reorders the volumes within the range and returns the index of the created node
+         */
+        size_t build_bvh(size_t first, size_t count);
+
+        /**
+         * @brief Check intersection of the given track with the given volume
          * This is a wrapper around LiangBarsky::intersectionDistances,
          * which properly transforms coordinates to make it work
          */
-        std::optional<std::pair<double, double>> intersect_with_sensor(const std::shared_ptr<const Detector>& detector,
-                                                                       const ROOT::Math::XYZPoint& position_global,
-                                                                       const ROOT::Math::XYZVector& direction_global) const;
+        static std::optional<std::pair<double, double>> intersect_with_volume(const LaserVolume& volume,
+                                                                              const ROOT::Math::XYZPoint& position_global,
+                                                                              const ROOT::Math::XYZVector& direction_global);
 
         /**
-         * @brief Check intersection with passive objects if there is any
-         * Only works for boxes
+         * @brief Find the first sensor along the given track, and the closest passive object if it is encountered before
+         * Traverses the bounding volume hierarchy, only volumes whose bounding box intersects the track are tested
          */
-        std::optional<std::pair<double, std::string>>
-        intersect_with_passives(const ROOT::Math::XYZPoint& position_global,
-                                const ROOT::Math::XYZVector& direction_global) const;
+        VolumeIntersection intersect_with_volumes(const ROOT::Math::XYZPoint& position_global,
+                                                  const ROOT::Math::XYZVector& direction_global) const;
 
         /**
-         * @brief Get a normal vector for a point where the given track enters the given detector
+         * @brief Get a normal vector for a point where the given track enters the given volume
          * Returns a normal vector to sensor face, closest to the hit_point
          */
-        ROOT::Math::XYZVector intersection_normal_vector(const std::shared_ptr<const Detector>& detector,
-                                                         const ROOT::Math::XYZPoint& position_global) const;
+        static ROOT::Math::XYZVector intersection_normal_vector(const LaserVolume& volume,
+                                                                const ROOT::Math::XYZPoint& position_global);
 
         /**
          * @brief Generate starting position and direction for a single photon, obeying the set beam geometry
@@ -136,6 +186,12 @@ namespace allpix {
         bool is_user_optics_{false};
 
         size_t group_photons_;
+        std::optional<ROOT::Math::XYZVector> deposit_voxel_size_;
+        bool compact_deposits_{};
+
+        // Sensors and passive objects, sorted into the bounding volume hierarchy
+        std::vector<LaserVolume> volumes_;
+        std::vector<BVHNode> bvh_nodes_;
 
         // Histograms
         bool output_plots_;
@@ -19,6 +19,7 @@
 #include "core/module/Event.hpp"
 #include "core/utils/distributions.h"
 #include "core/utils/log.h"
+#include "objects/DepositPoint.hpp"
 #include "objects/DepositedCharge.hpp"
 #include "objects/MCParticle.hpp"
 
@@ -37,10 +38,12 @@ DepositionPointChargeModule::DepositionPointChargeModule(Configuration& config,
     // Set default value for the number of charges deposited
     config_.setDefault("position", ROOT::Math::XYZPoint(0., 0., 0.));
     config_.setDefault("source_type", SourceType::POINT);
+    config_.setDefault("compact_deposits", false);
 
     // Read type and model:
     type_ = config_.get<SourceType>("source_type");
     model_ = config_.get<DepositionModel>("model");
+    compact_deposits_ = config_.get<bool>("compact_deposits");
 
     // Read spot size
     if(model_ == DepositionModel::SPOT) {
@@ -160,7 +163,7 @@ void DepositionPointChargeModule::run(Event* event) {
 
 void DepositionPointChargeModule::DepositPoint(Event* event, const ROOT::Math::XYZPoint& position) {
     // Vector of deposited charges and their "MCParticle"
-    std::vector<DepositedCharge> charges;
+    std::vector<allpix::DepositPoint> charges;
     std::vector<MCParticle> mcparticles;
 
     LOG(DEBUG) << "Position (local coordinates): " << Units::display(position, {"um", "mm"});
@@ -179,24 +182,20 @@ void DepositionPointChargeModule::DepositPoint(Event* event, const ROOT::Math::X
     // Count electrons and holes:
     mcparticles.back().setTotalDepositedCharge(2 * carriers_);
 
-    charges.emplace_back(position, position_global, CarrierType::ELECTRON, carriers_, 0., 0., &(mcparticles.back()));
-    charges.emplace_back(position, position_global, CarrierType::HOLE, carriers_, 0., 0., &(mcparticles.back()));
+    charges.push_back({position, position_global, CarrierType::ELECTRON, carriers_, 0., 0., 0});
+    charges.push_back({position, position_global, CarrierType::HOLE, carriers_, 0., 0., 0});
     LOG(DEBUG) << "Deposited " << carriers_ << " charge carriers of both types at global position "
                << Units::display(position_global, {"um", "mm"}) << " in detector " << detector_->getName();
 
     // Dispatch the messages to the framework
-    auto mcparticle_message = std::make_shared<MCParticleMessage>(std::move(mcparticles), detector_);
-    messenger_->dispatchMessage(this, mcparticle_message, event);
-
-    auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(charges), detector_);
-    messenger_->dispatchMessage(this, deposit_message, event);
+    dispatch_deposits(event, std::move(mcparticles), std::move(charges));
 }
 
 void DepositionPointChargeModule::DepositLine(Event* event, const ROOT::Math::XYZPoint& position) {
     auto model = detector_->getModel();
 
     // Vector of deposited charges and their "MCParticle"
-    std::vector<DepositedCharge> charges;
+    std::vector<allpix::DepositPoint> charges;
     std::vector<MCParticle> mcparticles;
 
     // Cross-check calculated position to be within sensor:
@@ -226,17 +225,40 @@ void DepositionPointChargeModule::DepositLine(Event* event, const ROOT::Math::XY
         position_local += ROOT::Math::XYZVector(0, 0, step_size_z_);
         auto position_global = detector_->getGlobalPosition(position_local);
 
-        charges.emplace_back(
-            position_local, position_global, CarrierType::ELECTRON, carriers_, 0., 0., &(mcparticles.back()));
-        charges.emplace_back(position_local, position_global, CarrierType::HOLE, carriers_, 0., 0., &(mcparticles.back()));
+        charges.push_back({position_local, position_global, CarrierType::ELECTRON, carriers_, 0., 0., 0});
+        charges.push_back({position_local, position_global, CarrierType::HOLE, carriers_, 0., 0., 0});
         LOG(TRACE) << "Deposited " << carriers_ << " charge carriers of both types at global position "
                    << Units::display(position_global, {"um", "mm"}) << " in detector " << detector_->getName();
     }
 
     // Dispatch the messages to the framework
+    dispatch_deposits(event, std::move(mcparticles), std::move(charges));
+}
+
+void DepositionPointChargeModule::dispatch_deposits(Event* event,
+                                                    std::vector<MCParticle> mcparticles,
+                                                    std::vector<allpix::DepositPoint> deposits) {
     auto mcparticle_message = std::make_shared<MCParticleMessage>(std::move(mcparticles), detector_);
     messenger_->dispatchMessage(this, mcparticle_message, event);
 
+    // Lightweight deposits refer to their MCParticle by index, full deposit objects are only created if requested
+    if(compact_deposits_) {
+        auto deposit_message = std::make_shared<DepositPointMessage>(std::move(deposits), detector_, mcparticle_message);
+        messenger_->dispatchMessage(this, deposit_message, event);
+        return;
+    }
+
+    std::vector<DepositedCharge> charges;
+    charges.reserve(deposits.size());
+    for(const auto& deposit : deposits) {
+        charges.emplace_back(deposit.local_position,
+                             deposit.global_position,
+                             deposit.type,
+                             deposit.charge,
+                             deposit.local_time,
+                             deposit.global_time,
+                             &mcparticle_message->getData()[deposit.mc_particle]);
+    }
     auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(charges), detector_);
     messenger_->dispatchMessage(this, deposit_message, event);
 }
@@ -12,6 +12,8 @@
 #include <string>
 
 #include "core/module/Module.hpp"
+#include "objects/DepositPoint.hpp"
+#include "objects/MCParticle.hpp"
 
 namespace allpix {
     /**
@@ -72,6 +74,15 @@ namespace allpix {
          */
         void DepositLine(Event*, const ROOT::Math::XYZPoint& position);
 
+        /**
+         * @brief Dispatch the generated MCParticles and the deposits, either as lightweight deposits or as full objects
+         * @param event Pointer to current event
+         * @param mcparticles Generated MCParticles
+         * @param deposits Generated deposits, referring to the MCParticles by index
+         */
+        void
+        dispatch_deposits(Event* event, std::vector<MCParticle> mcparticles, std::vector<allpix::DepositPoint> deposits);
+
         Messenger* messenger_;
 
         std::shared_ptr<Detector> detector_;
@@ -83,5 +94,6 @@ namespace allpix {
         double step_size_z_{};
         unsigned int root_{}, carriers_{};
         ROOT::Math::XYZVector position_{};
+        bool compact_deposits_{};
     };
 } // namespace allpix
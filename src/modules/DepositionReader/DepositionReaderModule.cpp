@@ -11,15 +11,105 @@
 
 #include "DepositionReaderModule.hpp"
 
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "core/utils/distributions.h"
 #include "core/utils/log.h"
 #include "physics/MaterialProperties.hpp"
 
 using namespace allpix;
 
+namespace {
+    // Identifier and format version of binary deposition files
+    const std::string binary_file_identifier = "APSQDEP1";
+    const uint32_t binary_file_version = 1;
+
+    /**
+     * @brief Helper to parse the next comma-separated field of a line without constructing intermediate streams
+     * @param line Line to parse
+     * @param pos Position of the first character of the field, advanced past the next comma
+     * @return Value of the field
+     * @throws ModuleError If the field is missing, empty, not a number or out of range
+     */
+    template <typename T> T parse_field(const std::string& line, size_t& pos) {
+        auto next = std::min(line.find(',', pos), line.size());
+        const char* begin = line.c_str() + pos;
+        const char* field_end = line.c_str() + next;
+
+        T value{};
+        char* end = nullptr;
+        bool out_of_range = false;
+        errno = 0;
+        if constexpr(std::is_floating_point_v<T>) {
+            value = static_cast<T>(std::strtod(begin, &end));
+            // Underflow to denormal values is accepted, overflow is not
+            out_of_range = (errno == ERANGE && std::isinf(value));
+        } else {
+            auto parsed = std::strtol(begin, &end, 10);
+            out_of_range =
+                (errno == ERANGE || parsed < std::numeric_limits<T>::min() || parsed > std::numeric_limits<T>::max());
+            value = static_cast<T>(parsed);
+        }
+
+        // Only whitespace may follow the value within the field
+        while(end < field_end && std::isspace(static_cast<unsigned char>(*end)) != 0) {
+            ++end;
+        }
+        if(end == begin || end != field_end || out_of_range) {
+            throw ModuleError("Could not parse value \"" + allpix::trim(line.substr(pos, next - pos)) + "\" in line \"" +
+                              line + "\"");
+        }
+
+        pos = std::min(next + 1, line.size());
+        return value;
+    }
+} // namespace
+
+DepositionReaderModule::MappedFile::MappedFile(const std::filesystem::path& file_path) {
+    auto fd = ::open(file_path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+
+    struct stat file_stat {};
+    if(::fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        throw std::runtime_error(std::strerror(errno));
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    if(size_ > 0) {
+        auto* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error(std::strerror(errno));
+        }
+        data_ = static_cast<char*>(mapping);
+    }
+    ::close(fd);
+}
+
+DepositionReaderModule::MappedFile::~MappedFile() {
+    if(data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+}
+
 DepositionReaderModule::DepositionReaderModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager)
     : SequentialModule(config), geo_manager_(geo_manager), messenger_(messenger) {
     // Enable multithreading of this module if multithreading is enabled
@@ -55,11 +145,20 @@ DepositionReaderModule::DepositionReaderModule(Configuration& config, Messenger*
     unit_time_ = config_.get<std::string>("unit_time");
     unit_energy_ = config_.get<std::string>("unit_energy");
 
+    length_factor_ = Units::get(1.0, unit_length_);
+    time_factor_ = Units::get(1.0, unit_time_);
+    energy_factor_ = Units::get(1.0, unit_energy_);
+
     require_sequential_events_ = config_.get<bool>("require_sequential_events");
     time_available_ = config_.get<bool>("assign_timestamps");
     create_mcparticles_ = config.get<bool>("create_mcparticles");
 
     output_plots_ = config_.get<bool>("output_plots");
+
+    // Events of binary files can be read in any order and in parallel
+    if(file_model_ == FileModel::BINARY) {
+        waive_sequence_requirement();
+    }
 }
 
 void DepositionReaderModule::initialize() {
@@ -79,6 +178,14 @@ void DepositionReaderModule::initialize() {
         if(!input_file_->is_open()) {
             throw InvalidValueError(config_, "file_name", "could not open input file");
         }
+    } else if(file_model_ == FileModel::BINARY) {
+        // Map the file, the event index is read once the detectors are known
+        auto file_path = config_.getPathWithExtension("file_name", "bin", true);
+        try {
+            input_file_binary_ = std::make_unique<MappedFile>(file_path);
+        } catch(const std::runtime_error& e) {
+            throw InvalidValueError(config_, "file_name", "could not map input file: " + std::string(e.what()));
+        }
     } else if(file_model_ == FileModel::ROOT) {
         auto file_path = config_.getPathWithExtension("file_name", "root", true);
         input_file_root_ = std::make_unique<TFile>(file_path.c_str(), "READ");
@@ -181,6 +288,15 @@ void DepositionReaderModule::initialize() {
         }
     }
 
+    // Cache the detectors and build lookup by name for the deposits read
+    detectors_ = geo_manager_->getDetectors();
+    for(size_t i = 0; i < detectors_.size(); i++) {
+        detector_index_[detectors_[i]->getName()] = i;
+    }
+    if(file_model_ == FileModel::BINARY) {
+        read_binary_index();
+    }
+
     // Calculate ionization energies and Fano factors:
     for(auto& detector : geo_manager_->getDetectors()) {
         auto model = detector->getModel();
@@ -195,6 +311,86 @@ void DepositionReaderModule::initialize() {
     }
 }
 
+/**
+ * Binary files start with a header holding the file identifier, the format version, the number of detector names, the number
+ * of events and the offset of the event index. The header is followed by the detector names, each prefixed by its length,
+ * and the deposits of all events. The event index at the end of the file lists the event number, the offset of the first
+ * deposit and the number of deposits for every event.
+ */
+void DepositionReaderModule::read_binary_index() {
+    const auto* data = input_file_binary_->data();
+    auto size = static_cast<uint64_t>(input_file_binary_->size());
+
+    // Helper to copy a value from the file, checking the file boundaries
+    auto read_value = [&](uint64_t offset, auto& value) {
+        if(offset > size || size - offset < sizeof(value)) {
+            throw InvalidValueError(config_, "file_name", "binary input file is truncated");
+        }
+        std::memcpy(&value, data + offset, sizeof(value));
+        return offset + sizeof(value);
+    };
+
+    std::array<char, 8> identifier{};
+    uint32_t version = 0, detector_count = 0;
+    uint64_t event_count = 0, index_offset = 0;
+    auto offset = read_value(0, identifier);
+    if(std::string(identifier.begin(), identifier.end()) != binary_file_identifier) {
+        throw InvalidValueError(config_, "file_name", "not a binary deposition file");
+    }
+    offset = read_value(offset, version);
+    if(version != binary_file_version) {
+        throw InvalidValueError(config_, "file_name", "unsupported binary file version " + std::to_string(version));
+    }
+    offset = read_value(offset, detector_count);
+    offset = read_value(offset, event_count);
+    offset = read_value(offset, index_offset);
+
+    // Map the volume names of the file to the detectors of the simulation
+    binary_detectors_.clear();
+    for(uint32_t i = 0; i < detector_count; i++) {
+        uint32_t length = 0;
+        offset = read_value(offset, length);
+        if(size - offset < length) {
+            throw InvalidValueError(config_, "file_name", "binary input file is truncated");
+        }
+        std::string volume(data + offset, length);
+        offset += length;
+
+        // Trim detector name if requested:
+        if(volume_chars_ != 0) {
+            volume = volume.substr(0, std::min(volume_chars_, volume.size()));
+        }
+        auto index = detector_index_.find(volume);
+        if(index == detector_index_.end()) {
+            LOG(DEBUG) << "Ignoring volume \"" << volume << "\", not found in current simulation";
+            binary_detectors_.push_back(no_detector);
+        } else {
+            binary_detectors_.push_back(index->second);
+        }
+    }
+
+    // Read the event index
+    binary_index_.clear();
+    binary_events_ = 0;
+    for(uint64_t i = 0; i < event_count; i++) {
+        uint64_t event_number = 0;
+        BinaryEvent entry{};
+        auto entry_offset = read_value(index_offset + i * 3 * sizeof(uint64_t), event_number);
+        entry_offset = read_value(entry_offset, entry.offset);
+        read_value(entry_offset, entry.count);
+        if(entry.offset > size || (size - entry.offset) / sizeof(BinaryDeposit) < entry.count) {
+            throw InvalidValueError(config_, "file_name", "binary input file is truncated");
+        }
+        if(!binary_index_.emplace(event_number, entry).second) {
+            throw InvalidValueError(
+                config_, "file_name", "event " + std::to_string(event_number) + " found twice in binary input file");
+        }
+        binary_events_ = std::max(binary_events_, event_number + 1);
+    }
+    LOG(INFO) << "Indexed " << binary_index_.size() << " events with deposits in " << binary_detectors_.size()
+              << " volumes for random access";
+}
+
 template <typename T>
 void DepositionReaderModule::create_tree_reader(std::shared_ptr<T>& branch_ptr, const std::string& name) {
     branch_ptr = std::make_shared<T>(*tree_reader_, name.c_str());
@@ -210,20 +406,23 @@ template <typename T> void DepositionReaderModule::check_tree_reader(std::shared
 void DepositionReaderModule::run(Event* event) {
     auto event_num = event->number;
 
-    // Set of deposited charges in this event
-    std::map<std::shared_ptr<Detector>, std::vector<ROOT::Math::XYZPoint>> deposit_position;
-    std::map<std::shared_ptr<Detector>, std::vector<unsigned int>> deposit_charge;
-    std::map<std::shared_ptr<Detector>, std::vector<double>> deposit_time;
-
-    std::map<std::shared_ptr<Detector>, std::vector<ROOT::Math::XYZPoint>> mc_particle_start;
-    std::map<std::shared_ptr<Detector>, std::vector<ROOT::Math::XYZPoint>> mc_particle_end;
-    std::map<std::shared_ptr<Detector>, std::vector<int>> mc_particle_code;
-    std::map<std::shared_ptr<Detector>, std::vector<double>> mc_particle_time;
-    std::map<std::shared_ptr<Detector>, std::vector<int>> mc_particle_parent;
-    std::map<std::shared_ptr<Detector>, std::vector<unsigned int>> mc_particle_charge;
+    // Set of deposited charges and MCParticles in this event, stored per detector
+    std::vector<DetectorDeposits> detector_deposits(detectors_.size());
 
-    std::map<std::shared_ptr<Detector>, std::vector<int>> particles_to_deposits;
-    std::map<std::shared_ptr<Detector>, std::map<int, size_t>> track_id_to_mcparticle;
+    // Deposits of this event in binary files, events without deposits do not need to be listed in the file
+    const char* binary_record = nullptr;
+    const char* binary_end = nullptr;
+    if(file_model_ == FileModel::BINARY) {
+        if(event_num > binary_events_) {
+            throw EndOfRunException("Requesting end of run, binary file only contains data for " +
+                                    std::to_string(binary_events_) + " events");
+        }
+        auto entry = binary_index_.find(event_num - 1);
+        if(entry != binary_index_.end()) {
+            binary_record = input_file_binary_->data() + entry->second.offset;
+            binary_end = binary_record + entry->second.count * sizeof(BinaryDeposit);
+        }
+    }
 
     LOG(DEBUG) << "Start reading event " << event_num;
     int64_t curr_event_id = -1;
@@ -236,9 +435,13 @@ void DepositionReaderModule::run(Event* event) {
         std::string volume;
         double energy = NAN, time = NAN;
         int pdg_code = 0, track_id = 0, parent_id = 0;
+        size_t detector_index = no_detector;
 
         try {
-            if(file_model_ == FileModel::CSV) {
+            if(file_model_ == FileModel::BINARY) {
+                read_status = read_binary(
+                    binary_record, binary_end, detector_index, global_position, time, energy, pdg_code, track_id, parent_id);
+            } else if(file_model_ == FileModel::CSV) {
                 read_status = read_csv(event_num, volume, global_position, time, energy, pdg_code, track_id, parent_id);
             } else if(file_model_ == FileModel::ROOT) {
                 read_status = read_root(
@@ -253,22 +456,25 @@ void DepositionReaderModule::run(Event* event) {
             break;
         }
 
-        // Trim detector name if requested:
-        if(volume_chars_ != 0) {
-            volume = volume.substr(0, std::min(volume_chars_, volume.size()));
-            LOG(TRACE) << "Truncated detector name: " << volume;
-        }
+        // Binary files provide the detector directly, otherwise look it up by name
+        if(file_model_ != FileModel::BINARY) {
+            // Trim detector name if requested:
+            if(volume_chars_ != 0) {
+                volume = volume.substr(0, std::min(volume_chars_, volume.size()));
+                LOG(TRACE) << "Truncated detector name: " << volume;
+            }
 
-        auto detectors = geo_manager_->getDetectors();
-        auto pos = std::find_if(detectors.begin(), detectors.end(), [volume](const std::shared_ptr<Detector>& d) {
-            return d->getName() == volume;
-        });
-        if(pos == detectors.end()) {
-            LOG(TRACE) << "Ignored detector \"" << volume << "\", not found in current simulation";
-            continue;
+            auto index = detector_index_.find(volume);
+            if(index == detector_index_.end()) {
+                LOG(TRACE) << "Ignored detector \"" << volume << "\", not found in current simulation";
+                continue;
+            }
+            detector_index = index->second;
         }
+
         // Assign detector
-        auto detector = (*pos);
+        const auto& detector = detectors_[detector_index];
+        auto& deposits = detector_deposits[detector_index];
         LOG(DEBUG) << "Found detector \"" << detector->getName() << "\"";
 
         auto local_position = detector->getLocalPosition(global_position);
@@ -280,8 +486,9 @@ void DepositionReaderModule::run(Event* event) {
 
         // Calculate number of electron hole pairs produced, taking into account fluctuations between ionization and lattice
         // excitations via the Fano factor. We assume Gaussian statistics here.
-        auto mean_charge = energy / charge_creation_energy_[detector];
-        allpix::normal_distribution<double> charge_fluctuation(mean_charge, std::sqrt(mean_charge * fano_factor_[detector]));
+        auto mean_charge = energy / charge_creation_energy_.at(detector);
+        allpix::normal_distribution<double> charge_fluctuation(mean_charge,
+                                                               std::sqrt(mean_charge * fano_factor_.at(detector)));
         auto charge = static_cast<unsigned int>(charge_fluctuation(event->getRandomEngine()));
 
         LOG(DEBUG) << "Found deposition of " << charge << " e/h pairs inside sensor at "
@@ -290,9 +497,9 @@ void DepositionReaderModule::run(Event* event) {
                    << Units::display(time, {"ns", "us"});
 
         // Store information about deposited charge carriers
-        deposit_position[detector].push_back(global_position);
-        deposit_charge[detector].push_back(charge);
-        deposit_time[detector].push_back(time);
+        deposits.deposit_position.push_back(global_position);
+        deposits.deposit_charge.push_back(charge);
+        deposits.deposit_time.push_back(time);
 
         // No MCParticle creation requested:
         if(!create_mcparticles_) {
@@ -300,24 +507,24 @@ void DepositionReaderModule::run(Event* event) {
         }
 
         // MCParticle:
-        auto iter = track_id_to_mcparticle[detector].find(track_id);
-        if(iter == track_id_to_mcparticle[detector].end()) {
+        auto iter = deposits.track_id_to_mcparticle.find(track_id);
+        if(iter == deposits.track_id_to_mcparticle.end()) {
             // We have not yet seen this MCParticle, let's store it and keep track of the track id
             LOG(DEBUG) << "Adding new MCParticle, track id " << track_id << ", PDG code " << pdg_code;
-            mc_particle_start[detector].push_back(global_position);
-            mc_particle_end[detector].push_back(global_position);
-            mc_particle_time[detector].push_back(time);
-            mc_particle_code[detector].push_back(pdg_code);
-            mc_particle_parent[detector].push_back(parent_id);
-            mc_particle_charge[detector].push_back(charge);
-            track_id_to_mcparticle[detector][track_id] = (mc_particle_start[detector].size() - 1);
+            deposits.mc_particle_start.push_back(global_position);
+            deposits.mc_particle_end.push_back(global_position);
+            deposits.mc_particle_time.push_back(time);
+            deposits.mc_particle_code.push_back(pdg_code);
+            deposits.mc_particle_parent.push_back(parent_id);
+            deposits.mc_particle_charge.push_back(charge);
+            deposits.track_id_to_mcparticle[track_id] = (deposits.mc_particle_start.size() - 1);
         } else {
             LOG(DEBUG) << "Found MCParticle with track id " << track_id << ", updating position";
-            mc_particle_end[detector].at(iter->second) = global_position;
-            mc_particle_charge[detector].at(iter->second) += charge;
+            deposits.mc_particle_end.at(iter->second) = global_position;
+            deposits.mc_particle_charge.at(iter->second) += charge;
         }
 
-        particles_to_deposits[detector].push_back(track_id);
+        deposits.deposit_track_id.push_back(track_id);
     } while(true);
 
     LOG(INFO) << "Finished reading event " << event;
@@ -325,38 +532,40 @@ void DepositionReaderModule::run(Event* event) {
     double time_reference = 0;
 
     // Loop over all known detectors and dispatch messages for them
-    for(const auto& detector : geo_manager_->getDetectors()) {
+    for(size_t d = 0; d < detectors_.size(); d++) {
+        const auto& detector = detectors_[d];
+        auto& deposits = detector_deposits[d];
 
-        if(!mc_particle_time[detector].empty()) {
-            time_reference = *std::min_element(mc_particle_time[detector].begin(), mc_particle_time[detector].end());
+        if(!deposits.mc_particle_time.empty()) {
+            time_reference = *std::min_element(deposits.mc_particle_time.begin(), deposits.mc_particle_time.end());
             LOG(DEBUG) << "Earliest MCParticle arrived on detector " << detector->getName() << " at "
                        << Units::display(time_reference, {"ns", "ps"}) << " global";
         }
 
-        auto mc_particle_size = mc_particle_start[detector].size();
+        auto mc_particle_size = deposits.mc_particle_start.size();
         std::vector<MCParticle> mc_particles;
         mc_particles.reserve(mc_particle_size);
 
         for(size_t i = 0; i < mc_particle_size; i++) {
-            auto start_global = mc_particle_start[detector].at(i);
+            auto start_global = deposits.mc_particle_start.at(i);
             auto start_local = detector->getLocalPosition(start_global);
-            auto end_global = mc_particle_end[detector].at(i);
+            auto end_global = deposits.mc_particle_end.at(i);
             auto end_local = detector->getLocalPosition(end_global);
 
-            auto pdg_code = mc_particle_code[detector].at(i);
-            auto time = mc_particle_time[detector].at(i);
+            auto pdg_code = deposits.mc_particle_code.at(i);
+            auto time = deposits.mc_particle_time.at(i);
 
             mc_particles.emplace_back(
                 start_local, start_global, end_local, end_global, pdg_code, time - time_reference, time);
             // Count electrons and holes:
-            mc_particles.back().setTotalDepositedCharge(2 * mc_particle_charge[detector].at(i));
+            mc_particles.back().setTotalDepositedCharge(2 * deposits.mc_particle_charge.at(i));
         }
 
         for(size_t i = 0; i < mc_particle_size; i++) {
             // Check if we know the parent - and set it:
-            auto parent_id = mc_particle_parent[detector].at(i);
-            auto parent = track_id_to_mcparticle[detector].find(parent_id);
-            if(parent == track_id_to_mcparticle[detector].end()) {
+            auto parent_id = deposits.mc_particle_parent.at(i);
+            auto parent = deposits.track_id_to_mcparticle.find(parent_id);
+            if(parent == deposits.track_id_to_mcparticle.end()) {
                 LOG(DEBUG) << "Parent MCParticle is unknown, parent track id " << parent_id;
             } else if(i == parent->second) {
                 LOG(DEBUG) << "Parent MCParticle is same as current particle, not adding relation";
@@ -373,38 +582,36 @@ void DepositionReaderModule::run(Event* event) {
             messenger_->dispatchMessage(this, mc_particle_message, event);
         }
 
-        if(!deposit_position[detector].empty()) {
-            std::map<std::shared_ptr<Detector>, std::vector<DepositedCharge>> deposits;
+        if(!deposits.deposit_position.empty()) {
+            std::vector<DepositedCharge> charges;
+            charges.reserve(2 * deposits.deposit_position.size());
             double total_deposits = 0;
 
-            for(size_t i = 0; i < deposit_position[detector].size(); i++) {
-                auto global_position = deposit_position[detector].at(i);
+            for(size_t i = 0; i < deposits.deposit_position.size(); i++) {
+                const auto& global_position = deposits.deposit_position[i];
                 auto local_position = detector->getLocalPosition(global_position);
-                auto time = deposit_time[detector].at(i);
-                auto charge = deposit_charge[detector].at(i);
+                auto time = deposits.deposit_time[i];
+                auto charge = deposits.deposit_charge[i];
                 total_deposits += 2 * charge;
 
-                // Deposit electron
-                deposits[detector].emplace_back(
-                    local_position, global_position, CarrierType::ELECTRON, charge, time - time_reference, time);
-
+                const MCParticle* mc_particle = nullptr;
                 if(create_mcparticles_) {
-                    deposits[detector].back().setMCParticle(&mc_particle_message->getData().at(
-                        track_id_to_mcparticle[detector].at(particles_to_deposits[detector].at(i))));
+                    mc_particle = &mc_particle_message->getData().at(
+                        deposits.track_id_to_mcparticle.at(deposits.deposit_track_id[i]));
                 }
 
+                // Deposit electron
+                charges.emplace_back(
+                    local_position, global_position, CarrierType::ELECTRON, charge, time - time_reference, time, mc_particle);
+
                 // Deposit hole
-                deposits[detector].emplace_back(
-                    local_position, global_position, CarrierType::HOLE, charge, time - time_reference, time);
-                if(create_mcparticles_) {
-                    deposits[detector].back().setMCParticle(&mc_particle_message->getData().at(
-                        track_id_to_mcparticle[detector].at(particles_to_deposits[detector].at(i))));
-                }
+                charges.emplace_back(
+                    local_position, global_position, CarrierType::HOLE, charge, time - time_reference, time, mc_particle);
             }
 
             // Create a new charge deposit message
-            LOG(DEBUG) << "Detector " << detector->getName() << " has " << deposits[detector].size() << " deposits";
-            auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(deposits[detector]), detector);
+            LOG(DEBUG) << "Detector " << detector->getName() << " has " << charges.size() << " deposits";
+            auto deposit_message = std::make_shared<DepositedChargeMessage>(std::move(charges), detector);
 
             // Dispatch the message
             messenger_->dispatchMessage(this, deposit_message, event);
@@ -412,7 +619,7 @@ void DepositionReaderModule::run(Event* event) {
             // Fill output plots if requested:
             if(output_plots_) {
                 double charge = static_cast<double>(Units::convert(total_deposits, "ke"));
-                charge_per_event_[detector]->Fill(charge);
+                charge_per_event_.at(detector)->Fill(charge);
             }
         }
     }
@@ -432,6 +639,43 @@ void DepositionReaderModule::finalize() {
         }
     }
 }
+
+bool DepositionReaderModule::read_binary(const char*& record,
+                                         const char* end,
+                                         size_t& detector_index,
+                                         ROOT::Math::XYZPoint& position,
+                                         double& time,
+                                         double& energy,
+                                         int& pdg_code,
+                                         int& track_id,
+                                         int& parent_id) {
+    static_assert(sizeof(BinaryDeposit) == 56, "binary deposits are stored without padding");
+
+    while(record != end) {
+        // Copy the deposit since records are not necessarily aligned in the file
+        BinaryDeposit deposit{};
+        std::memcpy(&deposit, record, sizeof(deposit));
+        record += sizeof(deposit);
+
+        detector_index = (deposit.detector < binary_detectors_.size() ? binary_detectors_[deposit.detector] : no_detector);
+        if(detector_index == no_detector) {
+            LOG(TRACE) << "Ignored deposit in volume " << deposit.detector << ", not found in current simulation";
+            continue;
+        }
+
+        // Interpret in framework units
+        position = ROOT::Math::XYZPoint(deposit.x * length_factor_, deposit.y * length_factor_, deposit.z * length_factor_);
+        time = (time_available_ ? deposit.time * time_factor_ : 0);
+        energy = deposit.energy * energy_factor_;
+        pdg_code = deposit.pdg_code;
+        track_id = deposit.track_id;
+        parent_id = deposit.parent_id;
+        return true;
+    }
+
+    return false;
+}
+
 bool DepositionReaderModule::read_root(uint64_t event_num,
                                        int64_t& curr_event_id,
                                        std::string& volume,
@@ -527,35 +771,24 @@ bool DepositionReaderModule::read_csv(uint64_t event_num,
         }
     } while(line.empty() || line.front() == '#' || line.front() == 'E');
 
-    std::istringstream ls(line);
-    double px = NAN, py = NAN, pz = NAN;
-
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> pdg_code;
-
+    // Parse the comma-separated fields directly from the line buffer
+    size_t pos = 0;
+    pdg_code = parse_field<int>(line, pos);
     if(time_available_) {
-        std::getline(ls, tmp, ',');
-        std::istringstream(tmp) >> time;
+        time = parse_field<double>(line, pos);
     }
+    energy = parse_field<double>(line, pos);
+    auto px = parse_field<double>(line, pos);
+    auto py = parse_field<double>(line, pos);
+    auto pz = parse_field<double>(line, pos);
 
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> energy;
-
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> px;
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> py;
-    std::getline(ls, tmp, ',');
-    std::istringstream(tmp) >> pz;
-
-    std::getline(ls, volume, ',');
-    volume = allpix::trim(volume);
+    auto volume_end = std::min(line.find(',', pos), line.size());
+    volume = allpix::trim(line.substr(pos, volume_end - pos));
+    pos = std::min(volume_end + 1, line.size());
 
     if(create_mcparticles_) {
-        std::getline(ls, tmp, ',');
-        std::istringstream(tmp) >> track_id;
-        std::getline(ls, tmp, ',');
-        std::istringstream(tmp) >> parent_id;
+        track_id = parse_field<int>(line, pos);
+        parent_id = parse_field<int>(line, pos);
     }
 
     // Calculate the charge deposit at a global position and convert the proper units
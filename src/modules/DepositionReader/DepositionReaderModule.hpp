@@ -14,9 +14,14 @@
  * Refer to the User's Manual for more details.
  */
 
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <functional>
+#include <limits>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <TFile.h>
 #include <TH1D.h>
@@ -44,8 +49,9 @@ namespace allpix {
          * @brief Different implemented file models
          */
         enum class FileModel {
-            ROOT, ///< ROOT Trees
-            CSV,  ///< Comma-separated value files
+            ROOT,   ///< ROOT Trees
+            CSV,    ///< Comma-separated value files
+            BINARY, ///< Binary files with event index
         };
 
     public:
@@ -73,13 +79,103 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Read-only memory mapping of an input file
+         */
+        class MappedFile {
+        public:
+            /**
+             * @brief Map a file into memory
+             * @param file_path Path of the file
+             * @throws std::runtime_error If the file cannot be opened or mapped
+             */
+            explicit MappedFile(const std::filesystem::path& file_path);
+            ~MappedFile();
+
+            /// @{
+            /**
+             * @brief Copying or moving the mapping is not allowed
+             */
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            MappedFile(MappedFile&&) = delete;
+            MappedFile& operator=(MappedFile&&) = delete;
+            /// @}
+
+            const char* data() const { return data_; }
+            size_t size() const { return size_; }
+
+        private:
+            char* data_{};
+            size_t size_{};
+        };
+
+        /**
+         * @brief Single energy deposit as stored in binary input files
+         */
+        struct BinaryDeposit {
+            double time;
+            double energy;
+            double x;
+            double y;
+            double z;
+            int32_t pdg_code;
+            int32_t track_id;
+            int32_t parent_id;
+            uint32_t detector;
+        };
+
+        /**
+         * @brief Location of the deposits of one event in binary input files
+         */
+        struct BinaryEvent {
+            uint64_t offset;
+            uint64_t count;
+        };
+
+        // Index marking detectors of the input file not present in the simulation
+        static constexpr size_t no_detector = std::numeric_limits<size_t>::max();
+
+        /**
+         * @brief Flat storage of all information read for a single detector in one event
+         */
+        struct DetectorDeposits {
+            std::vector<ROOT::Math::XYZPoint> deposit_position;
+            std::vector<unsigned int> deposit_charge;
+            std::vector<double> deposit_time;
+            std::vector<int> deposit_track_id;
+
+            std::vector<ROOT::Math::XYZPoint> mc_particle_start;
+            std::vector<ROOT::Math::XYZPoint> mc_particle_end;
+            std::vector<int> mc_particle_code;
+            std::vector<double> mc_particle_time;
+            std::vector<int> mc_particle_parent;
+            std::vector<unsigned int> mc_particle_charge;
+            std::unordered_map<int, size_t> track_id_to_mcparticle;
+        };
+
         // General module members
         GeometryManager* geo_manager_;
         Messenger* messenger_;
 
+        // Detectors of the setup and lookup of their index by name
+        std::vector<std::shared_ptr<Detector>> detectors_;
+        std::unordered_map<std::string, size_t> detector_index_;
+
         // File containing the input data
         std::unique_ptr<std::ifstream> input_file_;
         std::unique_ptr<TFile> input_file_root_;
+        std::unique_ptr<MappedFile> input_file_binary_;
+
+        // Event index of binary input files and lookup of the detectors named in the file
+        std::unordered_map<uint64_t, BinaryEvent> binary_index_;
+        uint64_t binary_events_{};
+        std::vector<size_t> binary_detectors_;
+
+        /**
+         * @brief Read the header and event index of the mapped binary input file
+         */
+        void read_binary_index();
 
         // Helper to create and check tree branches
         template <typename T> void create_tree_reader(std::shared_ptr<T>& branch_ptr, const std::string& name);
@@ -103,6 +199,7 @@ namespace allpix {
         FileModel file_model_;
         size_t volume_chars_{};
         std::string unit_length_{}, unit_time_{}, unit_energy_{};
+        double length_factor_{}, time_factor_{}, energy_factor_{};
         bool output_plots_{};
 
         bool require_sequential_events_{}, create_mcparticles_{}, time_available_{};
@@ -115,6 +212,15 @@ namespace allpix {
                       int& pdg_code,
                       int& track_id,
                       int& parent_id);
+        bool read_binary(const char*& record,
+                         const char* end,
+                         size_t& detector_index,
+                         ROOT::Math::XYZPoint& position,
+                         double& time,
+                         double& energy,
+                         int& pdg_code,
+                         int& track_id,
+                         int& parent_id);
         bool read_root(uint64_t event_num,
                        int64_t& curr_event_id,
                        std::string& volume,
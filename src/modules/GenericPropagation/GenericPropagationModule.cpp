@@ -12,6 +12,7 @@
 
 #include "GenericPropagationModule.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <map>
@@ -29,6 +30,7 @@
 #include "core/messenger/Messenger.hpp"
 #include "core/utils/distributions.h"
 #include "core/utils/log.h"
+#include "core/utils/text.h"
 #include "core/utils/unit.h"
 #include "tools/ROOT.h"
 #include "tools/runge_kutta.h"
@@ -54,6 +56,7 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
 
     // Set default value for config variables
     config_.setDefault<double>("spatial_precision", Units::get(0.25, "nm"));
+    config_.setDefault<std::string>("integration_method", "rkf45");
     config_.setDefault<double>("timestep_start", Units::get(0.01, "ns"));
     config_.setDefault<double>("timestep_min", Units::get(0.001, "ns"));
     config_.setDefault<double>("timestep_max", Units::get(0.5, "ns"));
@@ -67,6 +70,7 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     config_.setDefault<std::string>("recombination_model", "none");
     config_.setDefault<std::string>("trapping_model", "none");
     config_.setDefault<std::string>("detrapping_model", "none");
+    config_.setDefault<bool>("sample_lifetimes", false);
 
     config_.setDefault<bool>("output_linegraphs", false);
     config_.setDefault<bool>("output_linegraphs_collected", false);
@@ -93,19 +97,28 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     }
 
     config_.setDefault<bool>("ignore_magnetic_field", false);
+    config_.setDefault<bool>("precompute_velocity", false);
 
     // Set defaults for charge carrier multiplication
     config_.setDefault<std::string>("multiplication_model", "none");
     config_.setDefault<double>("multiplication_threshold", 1e-2);
     config_.setDefault<unsigned int>("max_multiplication_level", 5);
+    config_.setDefault<bool>("shower_transport", false);
+    config_.setDefault<unsigned int>("shower_merge_threshold", 20);
+    config_.setDefault<double>("shower_merge_distance", Units::get(1, "um"));
 
     // Copy some variables from configuration to avoid lookups:
     temperature_ = config_.get<double>("temperature");
+    integration_method_ = allpix::transform(config_.get<std::string>("integration_method"), ::tolower);
+    if(integration_method_ != "rkf45" && integration_method_ != "dopri5") {
+        throw InvalidValueError(config_, "integration_method", "Integration method must be either 'rkf45' or 'dopri5'");
+    }
     timestep_min_ = config_.get<double>("timestep_min");
     timestep_max_ = config_.get<double>("timestep_max");
     timestep_start_ = config_.get<double>("timestep_start");
     integration_time_ = config_.get<double>("integration_time");
     target_spatial_precision_ = config_.get<double>("spatial_precision");
+    sample_lifetimes_ = config_.get<bool>("sample_lifetimes");
     output_plots_ = config_.get<bool>("output_plots");
     output_linegraphs_ = config_.get<bool>("output_linegraphs");
     output_linegraphs_collected_ = config_.get<bool>("output_linegraphs_collected");
@@ -118,6 +131,9 @@ GenericPropagationModule::GenericPropagationModule(Configuration& config,
     charge_per_step_ = config_.get<unsigned int>("charge_per_step");
     max_charge_groups_ = config_.get<unsigned int>("max_charge_groups");
     max_multiplication_level_ = config.get<unsigned int>("max_multiplication_level");
+    shower_transport_ = config_.get<bool>("shower_transport");
+    shower_merge_threshold_ = config_.get<unsigned int>("shower_merge_threshold");
+    shower_merge_distance_ = config_.get<double>("shower_merge_distance");
 
     // Enable multithreading of this module if multithreading is enabled and no per-event output plots are requested:
     // FIXME: Review if this is really the case or we can still use multithreading
@@ -305,6 +321,9 @@ void GenericPropagationModule::initialize() {
     // Prepare mobility model
     mobility_ = Mobility(config_, model_->getSensorMaterial(), detector_->hasDopingProfile());
 
+    // Precompute drift velocity and diffusion constant on the electric field grid for both carrier types if requested
+    drift_maps_ = DriftMaps(config_, *detector_, mobility_, boltzmann_kT_, has_magnetic_field_);
+
     // Prepare recombination model
     recombination_ = Recombination(config_, detector_->hasDopingProfile());
 
@@ -345,6 +364,7 @@ void GenericPropagationModule::run(Event* event) {
     unsigned int recombined_charges_count = 0;
     unsigned int trapped_charges_count = 0;
     unsigned int step_count = 0;
+    unsigned int shower_groups_count = 0;
     long double total_time = 0;
     for(const auto& deposit : deposits_message->getData()) {
 
@@ -386,24 +406,48 @@ void GenericPropagationModule::run(Event* event) {
             }
             charges_remaining -= charge_per_step;
 
-            // Propagate a single charge deposit
-            auto [recombined, trapped, propagated, steps, time] = propagate(event,
-                                                                            deposit,
-                                                                            deposit.getLocalPosition(),
-                                                                            deposit.getType(),
-                                                                            charge_per_step,
-                                                                            deposit.getLocalTime(),
-                                                                            deposit.getGlobalTime(),
-                                                                            0,
-                                                                            propagated_charges,
-                                                                            output_plot_points);
-
-            // Update statistical information
-            recombined_charges_count += recombined;
-            trapped_charges_count += trapped;
-            propagated_charges_count += propagated;
-            step_count += steps;
-            total_time += time;
+            // Propagate a single set of charge carriers and update statistical information
+            std::vector<ShowerGroup> shower_groups;
+            auto propagate_group = [&](const ShowerGroup& group) {
+                auto propagate_deposit = [&](auto tableau) {
+                    return propagate<decltype(tableau)>(event,
+                                                        deposit,
+                                                        group.position,
+                                                        group.type,
+                                                        group.charge,
+                                                        group.time_local,
+                                                        group.time_global,
+                                                        group.level,
+                                                        shower_groups,
+                                                        propagated_charges,
+                                                        output_plot_points);
+                };
+                auto [recombined, trapped, propagated, steps, time] =
+                    (integration_method_ == "dopri5" ? propagate_deposit(tableau::DormandPrince54())
+                                                     : propagate_deposit(tableau::Fehlberg45()));
+
+                recombined_charges_count += recombined;
+                trapped_charges_count += trapped;
+                propagated_charges_count += propagated;
+                step_count += steps;
+                total_time += time;
+            };
+
+            // Propagate the charge deposit, followed by all secondary charge carriers queued in shower transport mode
+            propagate_group({deposit.getLocalPosition(),
+                             deposit.getType(),
+                             charge_per_step,
+                             deposit.getLocalTime(),
+                             deposit.getGlobalTime(),
+                             0});
+            while(!shower_groups.empty()) {
+                auto group = shower_groups.back();
+                shower_groups.pop_back();
+                LOG(DEBUG) << "Propagating set of " << group.charge << " charge carriers (" << group.type
+                           << ") from impact ionization shower, level " << group.level;
+                propagate_group(group);
+                shower_groups_count++;
+            }
         }
     }
 
@@ -430,6 +474,10 @@ void GenericPropagationModule::run(Event* event) {
               << Units::display(average_time, "ns") << std::endl
               << "Recombined " << recombined_charges_count << " charges during transport" << std::endl
               << "Trapped " << trapped_charges_count << " charges during transport";
+    if(shower_transport_) {
+        LOG(DEBUG) << "Propagated " << shower_groups_count
+                   << " sets of secondary charge carriers from impact ionization showers";
+    }
     total_propagated_charges_ += propagated_charges_count;
     total_steps_ += step_count;
     total_time_picoseconds_ += static_cast<long unsigned int>(total_time * 1e3);
@@ -450,8 +498,10 @@ void GenericPropagationModule::run(Event* event) {
 /**
  * Propagation is simulated using a parameterization for the electron mobility. This is used to calculate the electron
  * velocity at every point with help of the electric field map of the detector. An Runge-Kutta integration is applied in
- * multiple steps, adding a random diffusion to the propagating charge every step.
+ * multiple steps, adding a random diffusion to the propagating charge every step. The tableau of the integration is fixed at
+ * compile time, such that the stages and the velocity calculation can be inlined by the compiler.
  */
+template <typename Tableau>
 std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
 GenericPropagationModule::propagate(Event* event,
                                     const DepositedCharge& deposit,
@@ -461,6 +511,7 @@ GenericPropagationModule::propagate(Event* event,
                                     const double initial_time_local,
                                     const double initial_time_global,
                                     const unsigned int level,
+                                    std::vector<ShowerGroup>& shower_groups,
                                     std::vector<PropagatedCharge>& propagated_charges,
                                     LineGraph::OutputPlotPoints& output_plot_points) const {
 
@@ -491,8 +542,14 @@ GenericPropagationModule::propagate(Event* event,
     const unsigned int initial_charge = charge;
 
     // Define a function to compute the diffusion
-    auto carrier_diffusion = [&](double efield_mag, double doping_concentration, double timestep) -> Eigen::Vector3d {
-        double diffusion_constant = boltzmann_kT_ * mobility_(type, efield_mag, doping_concentration);
+    auto carrier_diffusion = [&](const Eigen::Vector3d& cur_pos,
+                                 double efield_mag,
+                                 double doping_concentration,
+                                 double timestep) -> Eigen::Vector3d {
+        double diffusion_constant =
+            (drift_maps_.enabled()
+                 ? drift_maps_.diffusion(type, static_cast<ROOT::Math::XYZPoint>(cur_pos), efield_mag, doping_concentration)
+                 : boltzmann_kT_ * mobility_(type, efield_mag, doping_concentration));
         double diffusion_std_dev = std::sqrt(2. * diffusion_constant * timestep);
 
         // Compute the independent diffusion in three
@@ -503,30 +560,31 @@ GenericPropagationModule::propagate(Event* event,
         return Eigen::Vector3d(x, y, z);
     };
 
-    // Survival or detrap probability of this charge carrier package, evaluated at every step
+    // Detrapping time and multiplication of this charge carrier package, evaluated when needed
     allpix::uniform_real_distribution<double> uniform_distribution(0, 1);
 
-    // Define lambda functions to compute the charge carrier velocity with or without magnetic field
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_noB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
-        auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-        Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
-        auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+    // Remaining lifetimes of this charge carrier package with respect to recombination and trapping
+    CarrierLifetime recombination_lifetime(event->getRandomEngine(), sample_lifetimes_);
+    CarrierLifetime trapping_lifetime(event->getRandomEngine(), sample_lifetimes_);
 
-        return static_cast<int>(type) * mobility_(type, efield.norm(), doping) * efield;
-    };
+    // Define a function to compute the charge carrier velocity with or without magnetic field
+    auto carrier_velocity = [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
+        if(drift_maps_.enabled()) {
+            auto velocity = drift_maps_.velocity(type, static_cast<ROOT::Math::XYZPoint>(cur_pos));
+            return Eigen::Vector3d(velocity.x(), velocity.y(), velocity.z());
+        }
 
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_withB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
         auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
         Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
+        auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+
+        if(!has_magnetic_field_) {
+            return static_cast<int>(type) * mobility_(type, efield.norm(), doping) * efield;
+        }
 
-        Eigen::Vector3d velocity;
         auto magnetic_field = detector_->getMagneticField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
         Eigen::Vector3d bfield(magnetic_field.x(), magnetic_field.y(), magnetic_field.z());
 
-        auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-
         auto mob = mobility_(type, efield.norm(), doping);
         auto exb = efield.cross(bfield);
 
@@ -540,10 +598,8 @@ GenericPropagationModule::propagate(Event* event,
         return static_cast<int>(type) * mob * (efield + term1 + term2) / rnorm;
     };
 
-    // Create the runge kutta solver with an RKF5 tableau, using different velocity calculators depending on the magnetic
-    // field
-    auto runge_kutta = make_runge_kutta(
-        tableau::RK5, (has_magnetic_field_ ? carrier_velocity_withB : carrier_velocity_noB), timestep_start_, position);
+    // Create the runge kutta solver with the selected tableau
+    auto runge_kutta = make_adaptive_runge_kutta<Tableau>(carrier_velocity, timestep_start_, position);
 
     // Continue propagation until the deposit is outside the sensor
     Eigen::Vector3d last_position = position;
@@ -552,8 +608,8 @@ GenericPropagationModule::propagate(Event* event,
     size_t next_idx = 0;
     auto state = CarrierState::MOTION;
     while(state == CarrierState::MOTION && (initial_time_local + runge_kutta.getTime()) < integration_time_) {
-        // Update output plots if necessary (depending on the plot step)
-        if(output_linegraphs_) {
+        // Update output plots if necessary (depending on the plot step), dense output is filled after the step instead
+        if(output_linegraphs_ && !Tableau::dense) {
             auto time_idx = static_cast<size_t>(runge_kutta.getTime() / output_plots_step_);
             while(next_idx <= time_idx) {
                 output_plot_points.at(output_plot_index).second.push_back(static_cast<ROOT::Math::XYZPoint>(position));
@@ -579,10 +635,24 @@ GenericPropagationModule::propagate(Event* event,
         efield = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(position));
         auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position));
 
-        // Apply diffusion step
-        auto diffusion = carrier_diffusion(std::sqrt(efield.Mag2()), doping, timestep);
+        // Apply diffusion step, the velocity at the end of the drift step is reused as first stage of the next step
+        auto diffusion = carrier_diffusion(position, std::sqrt(efield.Mag2()), doping, timestep);
         position += diffusion;
-        runge_kutta.setValue(position);
+        runge_kutta.displace(diffusion);
+
+        // Interpolate the positions within this step for the output plots, adding the diffusion proportionally
+        if constexpr(Tableau::dense) {
+            if(output_linegraphs_) {
+                while(static_cast<double>(next_idx) * output_plots_step_ <= runge_kutta.getTime()) {
+                    auto fraction =
+                        (static_cast<double>(next_idx) * output_plots_step_ - last_time) / runge_kutta.getLastTimeStep();
+                    auto theta = std::clamp(fraction, 0., 1.);
+                    Eigen::Vector3d point = runge_kutta.interpolate(theta) + theta * diffusion;
+                    output_plot_points.at(output_plot_index).second.push_back(static_cast<ROOT::Math::XYZPoint>(point));
+                    next_idx = output_plot_points.at(output_plot_index).second.size();
+                }
+            }
+        }
 
         // Check if we are still in the sensor and not in an implant:
         if(!model_->isWithinSensor(static_cast<ROOT::Math::XYZPoint>(position)) ||
@@ -591,15 +661,13 @@ GenericPropagationModule::propagate(Event* event,
         }
 
         // Check if charge carrier is still alive:
-        if(recombination_(type,
-                          detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position)),
-                          uniform_distribution(event->getRandomEngine()),
-                          timestep)) {
+        auto recombination_doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position));
+        if(recombination_.recombined(type, recombination_doping, recombination_lifetime, timestep)) {
             state = CarrierState::RECOMBINED;
         }
 
         // Check if the charge carrier has been trapped:
-        if(trapping_(type, uniform_distribution(event->getRandomEngine()), timestep, std::sqrt(efield.Mag2()))) {
+        if(trapping_.trapped(type, std::sqrt(efield.Mag2()), trapping_lifetime, timestep)) {
             if(output_plots_) {
                 trapping_time_histo_->Fill(static_cast<double>(Units::convert(runge_kutta.getTime(), "ns")), charge);
             }
@@ -610,6 +678,9 @@ GenericPropagationModule::propagate(Event* event,
                 // De-trap and advance in time if still below integration time
                 runge_kutta.advanceTime(detrap_time);
 
+                // Sample a new trapping lifetime for the released charge carrier
+                trapping_lifetime.reset();
+
                 if(output_plots_) {
                     detrapping_time_histo_->Fill(static_cast<double>(Units::convert(detrap_time, "ns")), charge);
                 }
@@ -638,12 +709,19 @@ GenericPropagationModule::propagate(Event* event,
                        << Units::display(std::sqrt(last_efield.Mag2()), "kV/cm") << " to "
                        << Units::display(std::sqrt(efield.Mag2()), "kV/cm");
 
-            // For each charge carrier draw a number to determine the number of
-            // secondaries generated in this step
-            double log_prob = 1. / std::log1p(-1. / local_gain);
-            for(unsigned int i_carrier = 0; i_carrier < charge; ++i_carrier) {
-                n_secondaries +=
-                    static_cast<unsigned int>(std::log(uniform_distribution(event->getRandomEngine())) * log_prob);
+            if(shower_transport_) {
+                // The number of secondaries of each charge carrier follows a geometric distribution, their sum over the
+                // full set a negative binomial distribution which is sampled at once
+                allpix::negative_binomial_distribution<unsigned int> secondaries_distribution(charge, 1. / local_gain);
+                n_secondaries = secondaries_distribution(event->getRandomEngine());
+            } else {
+                // For each charge carrier draw a number to determine the number of
+                // secondaries generated in this step
+                double log_prob = 1. / std::log1p(-1. / local_gain);
+                for(unsigned int i_carrier = 0; i_carrier < charge; ++i_carrier) {
+                    n_secondaries +=
+                        static_cast<unsigned int>(std::log(uniform_distribution(event->getRandomEngine())) * log_prob);
+                }
             }
 
             auto inverted_type = invertCarrierType(type);
@@ -663,27 +741,39 @@ GenericPropagationModule::propagate(Event* event,
                     multiplication_depth_histo_->Fill(carrier_pos.z(), n_secondaries);
                 }
 
-                auto [recombined, trapped, propagated, psteps, ptime] =
-                    propagate(event,
-                              deposit,
-                              carrier_pos,
-                              inverted_type,
-                              n_secondaries,
-                              initial_time_local + runge_kutta.getTime(),
-                              initial_time_global + runge_kutta.getTime(),
-                              level + 1,
-                              propagated_charges,
-                              output_plot_points);
-
-                // Update statistics:
-                recombined_charges_count += recombined;
-                trapped_charges_count += trapped;
-                propagated_charges_count += propagated;
-                steps += psteps;
-                total_time += ptime * charge;
-
-                LOG(DEBUG) << "Continuing propagation of charge carrier set (" << type << ") at "
-                           << Units::display(carrier_pos, {"mm", "um"});
+                if(shower_transport_) {
+                    // Defer the propagation of the secondaries until this set has been propagated
+                    queue_shower_group(shower_groups,
+                                       {carrier_pos,
+                                        inverted_type,
+                                        n_secondaries,
+                                        initial_time_local + runge_kutta.getTime(),
+                                        initial_time_global + runge_kutta.getTime(),
+                                        level + 1});
+                } else {
+                    auto [recombined, trapped, propagated, psteps, ptime] =
+                        propagate<Tableau>(event,
+                                           deposit,
+                                           carrier_pos,
+                                           inverted_type,
+                                           n_secondaries,
+                                           initial_time_local + runge_kutta.getTime(),
+                                           initial_time_global + runge_kutta.getTime(),
+                                           level + 1,
+                                           shower_groups,
+                                           propagated_charges,
+                                           output_plot_points);
+
+                    // Update statistics:
+                    recombined_charges_count += recombined;
+                    trapped_charges_count += trapped;
+                    propagated_charges_count += propagated;
+                    steps += psteps;
+                    total_time += ptime * charge;
+
+                    LOG(DEBUG) << "Continuing propagation of charge carrier set (" << type << ") at "
+                               << Units::display(carrier_pos, {"mm", "um"});
+                }
             }
 
             if((charge + n_secondaries) / initial_charge > 50.) {
@@ -705,6 +795,9 @@ GenericPropagationModule::propagate(Event* event,
         // Lower timestep when reaching the sensor edge
         if(std::fabs(model_->getSensorSize().z() / 2.0 - position.z()) < 2 * step.value.z()) {
             timestep *= 0.75;
+        } else if constexpr(Tableau::dense) {
+            // Proportional-integral control of the step size based on the error estimate of this and the previous step
+            timestep = runge_kutta.adaptTimeStep(uncertainty, target_spatial_precision_, timestep_min_, timestep_max_);
         } else {
             if(uncertainty > target_spatial_precision_) {
                 timestep *= 0.75;
@@ -816,6 +909,31 @@ GenericPropagationModule::propagate(Event* event,
     return std::make_tuple(recombined_charges_count, trapped_charges_count, propagated_charges_count, steps, total_time);
 }
 
+void GenericPropagationModule::queue_shower_group(std::vector<ShowerGroup>& shower_groups, const ShowerGroup& group) const {
+    if(shower_groups.size() >= shower_merge_threshold_) {
+        // Search the most recently queued sets first, they are most likely located close to the new set
+        for(auto it = shower_groups.rbegin(); it != shower_groups.rend(); ++it) {
+            auto distance2 = (it->position - group.position).Mag2();
+            if(it->type != group.type || distance2 > shower_merge_distance_ * shower_merge_distance_) {
+                continue;
+            }
+
+            // Merge into a superparticle at the charge-weighted mean position and time
+            auto weight = static_cast<double>(group.charge) / static_cast<double>(it->charge + group.charge);
+            it->position += weight * (group.position - it->position);
+            it->time_local += weight * (group.time_local - it->time_local);
+            it->time_global += weight * (group.time_global - it->time_global);
+            it->charge += group.charge;
+            it->level = std::max(it->level, group.level);
+            LOG(TRACE) << "Merged set of " << group.charge << " charge carriers (" << group.type
+                       << ") into superparticle of " << it->charge << " charge carriers at "
+                       << Units::display(it->position, {"mm", "um"});
+            return;
+        }
+    }
+    shower_groups.push_back(group);
+}
+
 void GenericPropagationModule::finalize() {
     if(output_plots_) {
         group_size_histo_->Get()->GetXaxis()->SetRange(1, group_size_histo_->Get()->GetNbinsX() + 1);
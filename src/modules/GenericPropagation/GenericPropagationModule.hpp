@@ -9,6 +9,7 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <string>
@@ -29,6 +30,7 @@
 #include "objects/PropagatedCharge.hpp"
 
 #include "physics/Detrapping.hpp"
+#include "physics/DriftMaps.hpp"
 #include "physics/ImpactIonization.hpp"
 #include "physics/Mobility.hpp"
 #include "physics/Recombination.hpp"
@@ -79,6 +81,18 @@ namespace allpix {
         std::shared_ptr<const Detector> detector_;
         std::shared_ptr<DetectorModel> model_;
 
+        /**
+         * @brief Set of charge carriers generated by impact ionization, awaiting propagation in shower transport mode
+         */
+        struct ShowerGroup {
+            ROOT::Math::XYZPoint position;
+            CarrierType type;
+            unsigned int charge;
+            double time_local;
+            double time_global;
+            unsigned int level;
+        };
+
         /**
          * @brief Propagate a single set of charges through the sensor
          * @param event               Pointer to current event
@@ -89,11 +103,14 @@ namespace allpix {
          * @param initial_time_local  Initial local time with respect to the start of the event
          * @param initial_time_global Initial global time with respect to the start of the event
          * @param level               Current level depth of the generated shower
+         * @param shower_groups       Reference to the queue of secondary charge carrier sets in shower transport mode
          * @param propagated_charges  Reference to vector with all produced final PropagatedCharge objects
          * @param output_plot_points Reference to vector to hold points for line graph output plots
          *
          * @return Total recombined, trapped and propagated charge for statistics purposes
+         * @tparam Tableau Runge-Kutta tableau used for the integration of the equation of motion
          */
+        template <typename Tableau>
         std::tuple<unsigned int, unsigned int, unsigned int, unsigned int, long double>
         propagate(Event* event,
                   const DepositedCharge& deposit,
@@ -103,18 +120,34 @@ namespace allpix {
                   const double initial_time_local,
                   const double initial_time_global,
                   const unsigned int level,
+                  std::vector<ShowerGroup>& shower_groups,
                   std::vector<PropagatedCharge>& propagated_charges,
                   LineGraph::OutputPlotPoints& output_plot_points) const;
 
+        /**
+         * @brief Add a set of secondary charge carriers to the shower queue
+         * @param shower_groups Reference to the queue of secondary charge carrier sets
+         * @param group         New set of charge carriers
+         *
+         * If the number of queued sets exceeds the merge threshold, the new set is merged into a queued set of the same
+         * carrier type within the merge distance, forming a superparticle at the charge-weighted mean position and time.
+         */
+        void queue_shower_group(std::vector<ShowerGroup>& shower_groups, const ShowerGroup& group) const;
+
         // Local copies of configuration parameters to avoid costly lookup:
+        std::string integration_method_;
         double temperature_{}, timestep_min_{}, timestep_max_{}, timestep_start_{}, integration_time_{},
             target_spatial_precision_{}, output_plots_step_{};
+        bool sample_lifetimes_{};
         bool output_plots_{}, output_linegraphs_{}, output_linegraphs_collected_{}, output_linegraphs_recombined_{},
             output_linegraphs_trapped_{}, output_animations_{};
         bool propagate_electrons_{}, propagate_holes_{};
         unsigned int charge_per_step_{};
         unsigned int max_charge_groups_{};
         unsigned int max_multiplication_level_{};
+        bool shower_transport_{};
+        unsigned int shower_merge_threshold_{};
+        double shower_merge_distance_{};
 
         // Models for electron and hole mobility and lifetime
         Mobility mobility_;
@@ -133,6 +166,9 @@ namespace allpix {
         // Magnetic field
         bool has_magnetic_field_;
 
+        // Precomputed drift velocity and diffusion constant maps
+        DriftMaps drift_maps_;
+
         // Statistical information
         std::atomic<unsigned int> total_propagated_charges_{};
         std::atomic<unsigned int> total_steps_{};
@@ -0,0 +1,361 @@
+/**
+ * @file
+ * @brief Implementation of charge sharing kernel transfer module
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "KernelTransferModule.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "core/geometry/RadialStripDetectorModel.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/utils/distributions.h"
+#include "core/utils/log.h"
+#include "core/utils/unit.h"
+#include "tools/field_parser.h"
+
+using namespace allpix;
+
+KernelTransferModule::KernelTransferModule(Configuration& config, Messenger* messenger, std::shared_ptr<Detector> detector)
+    : Module(config, detector), messenger_(messenger), detector_(std::move(detector)) {
+    // Enable multithreading of this module if multithreading is enabled
+    allow_multithreading();
+
+    // Save detector model
+    model_ = detector_->getModel();
+
+    // Bind deposits message for single detector, either as full objects or as lightweight deposit points
+    messenger_->bindSingle<DepositedChargeMessage>(this);
+    messenger_->bindSingle<DepositPointMessage>(this);
+
+    // Set default value for config variables
+    config_.setDefault<double>("temperature", 293.15);
+    config_.setDefault<double>("integration_time", Units::get(25, "ns"));
+    config_.setDefault<bool>("propagate_holes", false);
+    config_.setDefault<std::string>("mobility_model", "jacoboni");
+    config_.setDefault<std::string>("recombination_model", "none");
+    config_.setDefault<std::string>("trapping_model", "none");
+    config_.setDefaultArray<size_t>("kernel_bins", {20, 20, 50});
+    config_.setDefault<int>("kernel_range", 1);
+
+    type_ = (config_.get<bool>("propagate_holes") ? CarrierType::HOLE : CarrierType::ELECTRON);
+    temperature_ = config_.get<double>("temperature");
+    integration_time_ = config_.get<double>("integration_time");
+
+    auto bins = config_.getArray<size_t>("kernel_bins");
+    if(bins.size() != 3 || std::find(bins.begin(), bins.end(), 0) != bins.end()) {
+        throw InvalidValueError(config_, "kernel_bins", "number of bins in x, y and z required, all larger than zero");
+    }
+    bins_ = {bins[0], bins[1], bins[2]};
+
+    range_ = config_.get<int>("kernel_range");
+    if(range_ < 0) {
+        throw InvalidValueError(config_, "kernel_range", "range of neighboring pixels cannot be negative");
+    }
+}
+
+void KernelTransferModule::initialize() {
+    if(model_->getPixelType() != Pixel::Type::RECTANGLE ||
+       std::dynamic_pointer_cast<RadialStripDetectorModel>(model_) != nullptr) {
+        throw ModuleError("This module can only be used with rectangular pixel grids.");
+    }
+
+    auto field_type = detector_->getElectricFieldType();
+    if(field_type != FieldType::CONSTANT && field_type != FieldType::LINEAR && field_type != FieldType::CUSTOM1D) {
+        throw ModuleError("This module can only be used with electric fields depending only on the sensor depth.");
+    }
+
+    if(detector_->hasDopingProfile() && detector_->getDopingProfileType() != FieldType::CONSTANT) {
+        LOG(WARNING) << "Doping profile is evaluated at the center of the first pixel for the full sensor";
+    }
+
+    if(detector_->hasMagneticField()) {
+        LOG(WARNING) << "A magnetic field is switched on, but is ignored by this module.";
+    }
+
+    // Prepare mobility, recombination and trapping models
+    mobility_ = Mobility(config_, model_->getSensorMaterial(), detector_->hasDopingProfile());
+    recombination_ = Recombination(config_, detector_->hasDopingProfile());
+    trapping_ = Trapping(config_);
+
+    auto width = static_cast<size_t>(2 * range_ + 1);
+    components_ = 1 + width * width;
+
+    // Load the kernel from file if it exists and has been built with the same settings, build it otherwise
+    if(config_.has("kernel_file")) {
+        auto path = config_.getPath("kernel_file");
+        if(std::filesystem::exists(path)) {
+            FieldParser<double> parser(FieldQuantity::SCALAR);
+            auto kernel_data = parser.getByFileName(path);
+            if(kernel_data.getHeader() == kernel_description() &&
+               kernel_data.getDimensions() == std::array<size_t, 3>{bins_[0], bins_[1], bins_[2] * components_}) {
+                kernel_ = *kernel_data.getData();
+                LOG(INFO) << "Loaded charge sharing kernel from " << path;
+                return;
+            }
+            LOG(WARNING) << "Charge sharing kernel in " << path << " has been built with different settings, rebuilding";
+        }
+
+        build_kernel();
+
+        // Store the flattened kernel as scalar field, the components of each cell are consecutive along the third axis
+        auto size = model_->getSensorSize();
+        FieldData<double> kernel_data(kernel_description(),
+                                      {bins_[0], bins_[1], bins_[2] * components_},
+                                      {model_->getPixelSize().x(), model_->getPixelSize().y(), size.z()},
+                                      std::make_shared<std::vector<double>>(kernel_));
+        FieldWriter<double> writer(FieldQuantity::SCALAR);
+        writer.writeFile(kernel_data, path, FileType::APF);
+        LOG(INFO) << "Stored charge sharing kernel in " << path;
+    } else {
+        build_kernel();
+    }
+}
+
+/**
+ * The drift time, the variance of the lateral diffusion and the integrated recombination and trapping rates are obtained by
+ * integrating along the sensor depth from the collection surface towards the backside, using ten integration steps per
+ * kernel bin. Charge carriers starting below a point where the drift velocity does not point towards the collection surface
+ * are never collected. The collected fractions follow from the lateral Gaussian diffusion integrated over the neighboring
+ * pixels, weighted with the survival probability with respect to recombination and trapping. Trapped charge carriers are
+ * considered lost, detrapping is not simulated.
+ */
+void KernelTransferModule::build_kernel() {
+    auto pitch = model_->getPixelSize();
+    auto thickness = model_->getSensorSize().z();
+    auto z_min = model_->getSensorCenter().z() - thickness / 2.;
+    auto center = model_->getPixelCenter(0, 0);
+    auto boltzmann_kT = Units::get(8.6173333e-5, "eV/K") * temperature_;
+
+    // Drift time, diffusion variance and loss exponent from recombination and trapping at the center of each depth bin
+    constexpr size_t substeps = 10;
+    auto dz = thickness / static_cast<double>(bins_[2] * substeps);
+    std::vector<std::array<double, 3>> profile(bins_[2], {std::numeric_limits<double>::infinity(), 0., 0.});
+
+    double time = 0;
+    double variance = 0;
+    double loss = 0;
+    bool collected = true;
+    for(size_t step = bins_[2] * substeps; step-- > 0;) {
+        auto position = ROOT::Math::XYZPoint(center.x(), center.y(), z_min + (static_cast<double>(step) + 0.5) * dz);
+        auto efield = detector_->getElectricField(position);
+        auto doping = detector_->getDopingConcentration(position);
+        auto efield_mag = std::sqrt(efield.Mag2());
+        auto mobility = mobility_(type_, efield_mag, doping);
+
+        // Velocity component towards the collection surface
+        auto velocity = static_cast<int>(type_) * mobility * efield.z();
+        collected = collected && (velocity > std::numeric_limits<double>::epsilon());
+        if(collected) {
+            auto dt = dz / velocity;
+            time += dt;
+            variance += 2. * boltzmann_kT * mobility * dt;
+            loss += (recombination_.rate(type_, doping) + trapping_.rate(type_, efield_mag)) * dt;
+        }
+
+        // Store values when reaching the center of a depth bin
+        if(collected && step % substeps == substeps / 2) {
+            profile[step / substeps] = {time, variance, loss};
+        }
+    }
+
+    // Fraction of a Gaussian distribution with given width between the lower and upper boundary
+    auto fraction = [](double lower, double upper, double sigma) {
+        if(sigma <= 0) {
+            return (lower <= 0 && 0 < upper ? 1. : 0.);
+        }
+        return 0.5 * (std::erf(upper / (M_SQRT2 * sigma)) - std::erf(lower / (M_SQRT2 * sigma)));
+    };
+
+    auto width = static_cast<size_t>(2 * range_ + 1);
+    kernel_.assign(bins_[0] * bins_[1] * bins_[2] * components_, 0.);
+    for(size_t ix = 0; ix < bins_[0]; ++ix) {
+        auto x = ((static_cast<double>(ix) + 0.5) / static_cast<double>(bins_[0]) - 0.5) * pitch.x();
+        for(size_t iy = 0; iy < bins_[1]; ++iy) {
+            auto y = ((static_cast<double>(iy) + 0.5) / static_cast<double>(bins_[1]) - 0.5) * pitch.y();
+            for(size_t iz = 0; iz < bins_[2]; ++iz) {
+                auto [drift_time, diffusion_variance, loss_exponent] = profile[iz];
+                auto* cell = &kernel_[((ix * bins_[1] + iy) * bins_[2] + iz) * components_];
+                cell[0] = drift_time;
+                if(!std::isfinite(drift_time)) {
+                    continue;
+                }
+
+                auto sigma = std::sqrt(diffusion_variance);
+                auto survival = std::exp(-loss_exponent);
+                for(size_t dx = 0; dx < width; ++dx) {
+                    auto offset_x = (static_cast<double>(dx) - range_) * pitch.x() - x;
+                    auto fraction_x = fraction(offset_x - pitch.x() / 2., offset_x + pitch.x() / 2., sigma);
+                    for(size_t dy = 0; dy < width; ++dy) {
+                        auto offset_y = (static_cast<double>(dy) - range_) * pitch.y() - y;
+                        auto fraction_y = fraction(offset_y - pitch.y() / 2., offset_y + pitch.y() / 2., sigma);
+                        cell[1 + dx * width + dy] = survival * fraction_x * fraction_y;
+                    }
+                }
+            }
+        }
+    }
+
+    LOG(INFO) << "Built charge sharing kernel with " << bins_[0] << "x" << bins_[1] << "x" << bins_[2] << " cells and "
+              << width << "x" << width << " pixels";
+}
+
+std::string KernelTransferModule::kernel_description() const {
+    // Probe electric field, doping and trapping rate at the collection surface, the center and the backside of the sensor
+    auto center = model_->getPixelCenter(0, 0);
+    auto z_center = model_->getSensorCenter().z();
+    auto thickness = model_->getSensorSize().z();
+
+    std::stringstream description;
+    description << "Allpix Squared charge sharing kernel for " << type_ << "s with " << components_
+                << " components per cell (drift time and fractions of " << (2 * range_ + 1) << "x" << (2 * range_ + 1)
+                << " pixels), pitch " << Units::display(model_->getPixelSize(), {"um"}) << ", thickness "
+                << Units::display(thickness, {"um"}) << ", temperature " << Units::display(temperature_, {"K"})
+                << ", mobility model " << config_.get<std::string>("mobility_model") << ", recombination model "
+                << config_.get<std::string>("recombination_model") << ", trapping model "
+                << config_.get<std::string>("trapping_model");
+    for(auto z : {z_center + thickness / 2., z_center, z_center - thickness / 2.}) {
+        auto position = ROOT::Math::XYZPoint(center.x(), center.y(), z);
+        auto efield = detector_->getElectricField(position);
+        auto doping = detector_->getDopingConcentration(position);
+        auto trapping_rate = trapping_.rate(type_, std::sqrt(efield.Mag2()));
+        description << ", at " << Units::display(z, {"um"}) << " electric field " << Units::display(efield.z(), {"V/cm"})
+                    << " doping " << Units::display(doping, {"/cm/cm/cm"}) << " trapping rate "
+                    << Units::display(trapping_rate, {"/ns"});
+    }
+    return description.str();
+}
+
+void KernelTransferModule::run(Event* event) {
+    // Fetch deposits, which are provided either as full objects or as lightweight deposit points
+    std::shared_ptr<DepositedChargeMessage> deposits_message;
+    std::shared_ptr<DepositPointMessage> deposit_points_message;
+    try {
+        deposits_message = messenger_->fetchMessage<DepositedChargeMessage>(this, event);
+    } catch(const MessageNotFoundException&) {
+    }
+    try {
+        deposit_points_message = messenger_->fetchMessage<DepositPointMessage>(this, event);
+    } catch(const MessageNotFoundException&) {
+    }
+    if(deposits_message == nullptr && deposit_points_message == nullptr) {
+        return;
+    }
+
+    auto thickness = model_->getSensorSize().z();
+    auto z_min = model_->getSensorCenter().z() - thickness / 2.;
+    auto pitch = model_->getPixelSize();
+    auto width = 2 * range_ + 1;
+
+    // Cell index along one axis of the kernel, clamped to the tabulated range
+    auto cell_index = [](double fraction, size_t bins) {
+        auto index = static_cast<long>(std::floor(fraction * static_cast<double>(bins)));
+        return static_cast<size_t>(std::clamp(index, 0l, static_cast<long>(bins) - 1));
+    };
+
+    std::map<Pixel::Index, long> pixel_map;
+    unsigned long transferred_charges_count = 0;
+    unsigned long lost_charges_count = 0;
+    auto transfer_deposit = [&](const auto& deposit) {
+        if(deposit.getType() != type_) {
+            return;
+        }
+
+        // Find the pixel of the deposit and the in-pixel position
+        auto position = deposit.getLocalPosition();
+        auto [xpixel, ypixel] = model_->getPixelIndex(position);
+        if(!model_->isWithinMatrix(xpixel, ypixel)) {
+            LOG(DEBUG) << "Deposit at " << Units::display(position, {"mm", "um"}) << " outside the pixel matrix";
+            lost_charges_count += deposit.getCharge();
+            return;
+        }
+        auto pixel_center = model_->getPixelCenter(xpixel, ypixel);
+        auto ix = cell_index((position.x() - pixel_center.x()) / pitch.x() + 0.5, bins_[0]);
+        auto iy = cell_index((position.y() - pixel_center.y()) / pitch.y() + 0.5, bins_[1]);
+        auto iz = cell_index((position.z() - z_min) / thickness, bins_[2]);
+        const auto* cell = &kernel_[((ix * bins_[1] + iy) * bins_[2] + iz) * components_];
+
+        // Only transfer charge carriers arriving within the integration time
+        if(!std::isfinite(cell[0]) || deposit.getLocalTime() + cell[0] > integration_time_) {
+            LOG(DEBUG) << "Charge carriers deposited at " << Units::display(position, {"mm", "um"})
+                       << " not collected within integration time";
+            lost_charges_count += deposit.getCharge();
+            return;
+        }
+
+        // Distribute the charge carriers over the neighboring pixels following a multinomial distribution
+        unsigned int remaining = deposit.getCharge();
+        double probability_remaining = 1.;
+        for(size_t component = 1; component < components_ && remaining > 0 && probability_remaining > 0; ++component) {
+            auto probability = cell[component];
+            if(probability <= 0) {
+                continue;
+            }
+
+            allpix::binomial_distribution<unsigned int> binomial(remaining,
+                                                                 std::min(1., probability / probability_remaining));
+            auto charge = binomial(event->getRandomEngine());
+            probability_remaining -= probability;
+            remaining -= charge;
+            if(charge == 0) {
+                continue;
+            }
+
+            auto xneighbor = xpixel + static_cast<int>((component - 1) / static_cast<size_t>(width)) - range_;
+            auto yneighbor = ypixel + static_cast<int>((component - 1) % static_cast<size_t>(width)) - range_;
+            if(!model_->isWithinMatrix(xneighbor, yneighbor)) {
+                lost_charges_count += charge;
+                continue;
+            }
+
+            pixel_map[Pixel::Index(xneighbor, yneighbor)] += static_cast<int>(type_) * static_cast<long>(charge);
+            transferred_charges_count += charge;
+        }
+        lost_charges_count += remaining;
+    };
+
+    if(deposits_message != nullptr) {
+        for(const auto& deposit : deposits_message->getData()) {
+            transfer_deposit(deposit);
+        }
+    }
+    if(deposit_points_message != nullptr) {
+        for(const auto& deposit : deposit_points_message->getData()) {
+            transfer_deposit(deposit);
+        }
+    }
+
+    // Create pixel charges
+    std::vector<PixelCharge> pixel_charges;
+    for(const auto& [index, charge] : pixel_map) {
+        auto pixel = detector_->getPixel(index.x(), index.y());
+        pixel_charges.emplace_back(pixel, charge);
+        LOG(DEBUG) << "Set of " << charge << " charges combined at " << pixel.getIndex();
+    }
+
+    LOG(INFO) << "Transferred " << transferred_charges_count << " charges to " << pixel_map.size() << " pixels, lost "
+              << lost_charges_count;
+    total_transferred_charges_ += transferred_charges_count;
+    total_lost_charges_ += lost_charges_count;
+
+    // Dispatch message of pixel charges
+    auto pixel_message = std::make_shared<PixelChargeMessage>(std::move(pixel_charges), detector_);
+    messenger_->dispatchMessage(this, pixel_message, event);
+}
+
+void KernelTransferModule::finalize() {
+    LOG(INFO) << "Transferred total of " << total_transferred_charges_ << " charges, lost " << total_lost_charges_;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Definition of charge sharing kernel transfer module
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/config/Configuration.hpp"
+#include "core/geometry/DetectorModel.hpp"
+#include "core/messenger/Messenger.hpp"
+#include "core/module/Event.hpp"
+#include "core/module/Module.hpp"
+
+#include "objects/DepositPoint.hpp"
+#include "objects/DepositedCharge.hpp"
+#include "objects/PixelCharge.hpp"
+
+#include "physics/Mobility.hpp"
+#include "physics/Recombination.hpp"
+#include "physics/Trapping.hpp"
+
+namespace allpix {
+    /**
+     * @ingroup Modules
+     * @brief Module to transfer deposited charges directly to pixels using a precomputed charge sharing kernel
+     * @note This module supports multithreading
+     *
+     * For sensors with an electric field depending only on the depth, the fraction of charge carriers collected by each
+     * pixel in the vicinity of a deposit only depends on the position of the deposit within its pixel cell. This module
+     * tabulates these fractions together with the drift time once during initialization on a grid of in-pixel positions
+     * and depths. For every deposit, the charge collected by the neighboring pixels is then sampled directly from the
+     * table, replacing the combination of a propagation and a transfer module.
+     */
+    class KernelTransferModule : public Module {
+    public:
+        /**
+         * @brief Constructor for this detector-specific module
+         * @param config Configuration object for this module as retrieved from the steering file
+         * @param messenger Pointer to the messenger object to allow binding to messages on the bus
+         * @param detector Pointer to the detector for this module instance
+         */
+        KernelTransferModule(Configuration& config, Messenger* messenger, std::shared_ptr<Detector> detector);
+
+        /**
+         * @brief Initialize the physics models and build or load the charge sharing kernel
+         */
+        void initialize() override;
+
+        /**
+         * @brief Sample the pixel charges of all deposits from the kernel
+         */
+        void run(Event*) override;
+
+        /**
+         * @brief Display statistical summary
+         */
+        void finalize() override;
+
+    private:
+        /**
+         * @brief Build the kernel by integrating the drift along the sensor depth
+         */
+        void build_kernel();
+
+        /**
+         * @brief Description of the kernel and the settings it has been built with, stored in the kernel file header
+         * @return Description string
+         */
+        std::string kernel_description() const;
+
+        Messenger* messenger_;
+        std::shared_ptr<Detector> detector_;
+        std::shared_ptr<DetectorModel> model_;
+
+        // Configuration parameters
+        CarrierType type_;
+        double temperature_{};
+        double integration_time_{};
+        std::array<size_t, 3> bins_{};
+        int range_{};
+
+        // Models for charge carrier mobility, lifetime and trapping
+        Mobility mobility_;
+        Recombination recombination_;
+        Trapping trapping_;
+
+        // Kernel data: for every cell, the drift time followed by the collected fraction for each neighboring pixel
+        std::vector<double> kernel_;
+        size_t components_{};
+
+        // Statistical information
+        std::atomic<unsigned long> total_transferred_charges_{};
+        std::atomic<unsigned long> total_lost_charges_{};
+    };
+} // namespace allpix
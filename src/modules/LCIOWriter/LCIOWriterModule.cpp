@@ -102,10 +102,12 @@ LCIOWriterModule::LCIOWriterModule(Configuration& config, Messenger* messenger,
     config_.setDefault("pixel_type", 2);
     config_.setDefault("detector_name", "EUTelescope");
     config_.setDefault("dump_mc_truth", false);
+    config_.setDefault("write_queue_size", 64);
 
     pixel_type_ = config_.get<int>("pixel_type");
     detector_name_ = config_.get<std::string>("detector_name");
     dump_mc_truth_ = config_.get<bool>("dump_mc_truth");
+    write_queue_size_ = config_.get<size_t>("write_queue_size");
     // There are two ways to configure this module - either by providing a "output_collection_name" or a
     // "detector_assignment". Throws an error if both are provided and defaults back to "output_collection_name" if none are
     // provided
@@ -249,6 +251,58 @@ void LCIOWriterModule::initialize() {
     run->setRunNumber(1);
     run->setDetectorName(detector_name_);
     lcWriter_->writeRunHeader(run.get());
+
+    // Start the background writer thread if requested
+    if(write_queue_size_ > 0) {
+        LOG(DEBUG) << "Writing events in background thread, buffering up to " << write_queue_size_ << " events";
+        writer_thread_ = std::thread(&LCIOWriterModule::write_events, this);
+    }
+}
+
+LCIOWriterModule::~LCIOWriterModule() {
+    // Make sure the writer thread is stopped also if the run was not finalized regularly
+    stop_writer();
+}
+
+void LCIOWriterModule::write_events() {
+    while(true) {
+        std::unique_ptr<LCEventImpl> evt;
+        {
+            std::unique_lock<std::mutex> lock{write_mutex_};
+            write_condition_.wait(lock, [this]() { return !write_queue_.empty() || write_queue_closed_; });
+            if(write_queue_.empty()) {
+                return;
+            }
+            evt = std::move(write_queue_.front());
+            write_queue_.pop_front();
+        }
+        // Notify workers waiting for free space in the queue
+        write_condition_.notify_all();
+
+        try {
+            lcWriter_->writeEvent(evt.get());
+            write_cnt_++;
+        } catch(...) {
+            // Store the exception to rethrow it from the framework, and stop accepting further events
+            std::lock_guard<std::mutex> lock{write_mutex_};
+            write_exception_ = std::current_exception();
+            write_queue_closed_ = true;
+            write_queue_.clear();
+            write_condition_.notify_all();
+            return;
+        }
+    }
+}
+
+void LCIOWriterModule::stop_writer() {
+    {
+        std::lock_guard<std::mutex> lock{write_mutex_};
+        write_queue_closed_ = true;
+    }
+    write_condition_.notify_all();
+    if(writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
 }
 
 void LCIOWriterModule::run(Event* event) {
@@ -304,6 +358,13 @@ void LCIOWriterModule::run(Event* event) {
         charges[det.second] = std::vector<float>{};
     }
 
+    // Preallocate the charge vectors with the number of values required for all hits of the respective detector
+    size_t values_per_pixel = (pixel_type_ == 1 ? 3 : (pixel_type_ == 5 ? 7 : 4));
+    for(const auto& hit_msg : pixel_messages) {
+        auto& det_charges = charges[detector_names_to_id_[hit_msg->getDetector()->getName()]];
+        det_charges.reserve(det_charges.capacity() + values_per_pixel * hit_msg->getData().size());
+    }
+
     // Receive all pixel messages, fill charge vectors
     for(const auto& hit_msg : pixel_messages) {
         LOG(DEBUG) << hit_msg->getDetector()->getName();
@@ -450,11 +511,40 @@ void LCIOWriterModule::run(Event* event) {
         evt->addCollection(output_col_vec[i], collection_names_vector_[i]);
     }
 
-    lcWriter_->writeEvent(evt.get()); // write the event to the file
-    write_cnt_++;
+    // Write the event to the file directly if no background writer is used
+    if(write_queue_size_ == 0) {
+        lcWriter_->writeEvent(evt.get());
+        write_cnt_++;
+        return;
+    }
+
+    // Hand the event to the background writer, waiting for free space in the queue. The events arrive in order of their
+    // event number, since the module keeps the sequence requirement. Events could be reordered in the queue instead, as the
+    // framework announces events skipped by this module, but building an event is cheap compared to its serialization.
+    std::unique_lock<std::mutex> lock{write_mutex_};
+    write_condition_.wait(lock, [this]() { return write_queue_.size() < write_queue_size_ || write_queue_closed_; });
+    if(write_exception_) {
+        try {
+            std::rethrow_exception(write_exception_);
+        } catch(const std::exception& e) {
+            throw ModuleError("Failed to write event to LCIO file: " + std::string(e.what()));
+        }
+    }
+    write_queue_.push_back(std::move(evt));
+    lock.unlock();
+    write_condition_.notify_all();
 }
 
 void LCIOWriterModule::finalize() {
+    // Write all remaining events before closing the file
+    stop_writer();
+    if(write_exception_) {
+        try {
+            std::rethrow_exception(write_exception_);
+        } catch(const std::exception& e) {
+            throw ModuleError("Failed to write event to LCIO file: " + std::string(e.what()));
+        }
+    }
     lcWriter_->close();
     // Print statistics
     LOG(STATUS) << "Wrote " << write_cnt_ << " events to file:" << std::endl << lcio_file_name_;
@@ -9,7 +9,12 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "core/config/Configuration.hpp"
@@ -20,6 +25,7 @@
 
 #include "objects/PixelHit.hpp"
 
+#include <IMPL/LCEventImpl.h>
 #include <IO/LCWriter.h>
 
 namespace allpix {
@@ -28,7 +34,8 @@ namespace allpix {
      * @ingroup Modules
      * @brief Module to write hit data to LCIO file
      *
-     * Create LCIO file, compatible to EUTelescope analysis framework.
+     * Create LCIO file, compatible to EUTelescope analysis framework. Events are built in sequence by the workers and
+     * optionally handed to a background thread which serializes them to file.
      */
     class LCIOWriterModule : public SequentialModule {
     public:
@@ -40,7 +47,10 @@ namespace allpix {
          */
         LCIOWriterModule(Configuration& config, Messenger* messenger, GeometryManager* geo_manager);
 
-        ~LCIOWriterModule(){};
+        /**
+         * @brief Destructor, stops the background writer thread if still running
+         */
+        ~LCIOWriterModule() override;
 
         /**
          * @brief Initialize LCIO and GEAR output files
@@ -58,6 +68,16 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Write events from the queue to the LCIO file until the queue is closed and empty
+         */
+        void write_events();
+
+        /**
+         * @brief Close the write queue and wait for the background writer thread to finish
+         */
+        void stop_writer();
+
         Messenger* messenger_;
         GeometryManager* geo_mgr_{};
         std::shared_ptr<IO::LCWriter> lcWriter_{};
@@ -74,5 +94,14 @@ namespace allpix {
         std::string lcio_file_name_;
         std::string geometry_file_name_;
         std::atomic<int> write_cnt_{0};
+
+        // Queue of built events to be written by the background thread
+        size_t write_queue_size_{};
+        std::deque<std::unique_ptr<IMPL::LCEventImpl>> write_queue_;
+        std::mutex write_mutex_;
+        std::condition_variable write_condition_;
+        bool write_queue_closed_{};
+        std::exception_ptr write_exception_;
+        std::thread writer_thread_;
     };
 } // namespace allpix
@@ -12,14 +12,15 @@
 #include "ProjectionPropagationModule.hpp"
 
 #include <cmath>
-#include <functional>
 #include <limits>
 #include <string>
+#include <tuple>
 #include <utility>
 
 #include "core/messenger/Messenger.hpp"
 #include "core/utils/distributions.h"
 #include "core/utils/log.h"
+#include "objects/DepositPoint.hpp"
 #include "objects/DepositedCharge.hpp"
 #include "objects/PropagatedCharge.hpp"
 
@@ -34,8 +35,9 @@ ProjectionPropagationModule::ProjectionPropagationModule(Configuration& config,
     // Save detector model
     model_ = detector_->getModel();
 
-    // Require deposits message for single detector
-    messenger_->bindSingle<DepositedChargeMessage>(this, MsgFlags::REQUIRED);
+    // Bind deposits message for single detector, either as full objects or as lightweight deposit points
+    messenger_->bindSingle<DepositedChargeMessage>(this);
+    messenger_->bindSingle<DepositPointMessage>(this);
 
     // Set default value for config variables
     config_.setDefault<int>("charge_per_step", 10);
@@ -126,6 +128,26 @@ void ProjectionPropagationModule::initialize() {
                "field is wrong!";
     }
 
+    // The linear electric field only depends on z, the field at the collection surface is the same for all carriers
+    efield_mag_top_ = std::sqrt(detector_->getElectricField(ROOT::Math::XYZPoint(0., 0., top_z_)).Mag2());
+
+    // Locate the depletion edge once, i.e. the plane closest to the undepleted region with non-zero electric field
+    auto has_field = [&](double z) {
+        auto efield = detector_->getElectricField(ROOT::Math::XYZPoint(0., 0., z));
+        return std::sqrt(efield.Mag2()) > std::numeric_limits<double>::epsilon();
+    };
+    if(!has_field(-top_z_) && has_field(top_z_)) {
+        double undepleted = -top_z_;
+        double depleted = top_z_;
+        // Stop at a precision of 0.01 um
+        while(std::fabs(depleted - undepleted) > 0.00001) {
+            auto center = (depleted + undepleted) / 2.;
+            (has_field(center) ? depleted : undepleted) = center;
+        }
+        depletion_edge_ = depleted;
+        LOG(DEBUG) << "Depletion edge located at z = " << Units::display(depleted, {"um", "mm"});
+    }
+
     if(output_plots_) {
         // Initialize output plots
         propagation_time_histo_ =
@@ -171,7 +193,20 @@ void ProjectionPropagationModule::initialize() {
 }
 
 void ProjectionPropagationModule::run(Event* event) {
-    auto deposits_message = messenger_->fetchMessage<DepositedChargeMessage>(this, event);
+    // Fetch deposits, which are provided either as full objects or as lightweight deposit points
+    std::shared_ptr<DepositedChargeMessage> deposits_message;
+    std::shared_ptr<DepositPointMessage> deposit_points_message;
+    try {
+        deposits_message = messenger_->fetchMessage<DepositedChargeMessage>(this, event);
+    } catch(const MessageNotFoundException&) {
+    }
+    try {
+        deposit_points_message = messenger_->fetchMessage<DepositPointMessage>(this, event);
+    } catch(const MessageNotFoundException&) {
+    }
+    if(deposits_message == nullptr && deposit_points_message == nullptr) {
+        return;
+    }
 
     // Create vector of propagated charges to output
     std::vector<PropagatedCharge> propagated_charges;
@@ -184,15 +219,16 @@ void ProjectionPropagationModule::run(Event* event) {
     // List of points to plot to plot for output plots
     LineGraph::OutputPlotPoints output_plot_points;
 
-    // Loop over all deposits for propagation
-    for(const auto& deposit : deposits_message->getData()) {
-
+    // Propagate a single deposit, given either as full object or as lightweight deposit point
+    auto propagate_deposit = [&](const auto& deposit,
+                                 const DepositedCharge* deposited_charge,
+                                 const MCParticle* mc_particle) {
         auto type = deposit.getType();
         auto initial_position = deposit.getLocalPosition();
 
         // Selection of charge carrier:
         if(type != propagate_type_) {
-            continue;
+            return;
         }
 
         total_deposits_++;
@@ -202,6 +238,17 @@ void ProjectionPropagationModule::run(Event* event) {
 
         unsigned int projected_charge = 0;
 
+        // The electric field, doping concentration and drift of charge carriers which are not diffused first only depend on
+        // the position of the deposit and are therefore the same for all charge groups
+        auto efield_deposit = detector_->getElectricField(initial_position);
+        double efield_mag_deposit = std::sqrt(efield_deposit.Mag2());
+        double doping = detector_->getDopingConcentration(initial_position);
+        double drift_time_deposit = 0;
+        double diffusion_std_dev_deposit = 0;
+        if(efield_mag_deposit > std::numeric_limits<double>::epsilon()) {
+            std::tie(drift_time_deposit, diffusion_std_dev_deposit) = drift(initial_position, efield_mag_deposit, doping);
+        }
+
         unsigned int charges_remaining = deposit.getCharge();
         total_charge += charges_remaining;
 
@@ -230,12 +277,11 @@ void ProjectionPropagationModule::run(Event* event) {
                 output_plot_points.back().second.push_back(initial_position);
             }
 
-            // Get the electric field at the position of the deposited charge and the top of the sensor:
-            auto efield = detector_->getElectricField(position);
-            double efield_mag = std::sqrt(efield.Mag2());
-            auto efield_top = detector_->getElectricField(ROOT::Math::XYZPoint(0., 0., top_z_));
-            double efield_mag_top = std::sqrt(efield_top.Mag2());
-            double doping = detector_->getDopingConcentration(position);
+            // Start from the electric field and drift of the deposit position
+            double efield_mag = efield_mag_deposit;
+            double recombination_doping = doping;
+            double drift_time = drift_time_deposit;
+            double diffusion_std_dev = diffusion_std_dev_deposit;
             double diffusion_time = 0;
 
             // Only project if within the depleted region (i.e. efield not zero)
@@ -245,10 +291,11 @@ void ProjectionPropagationModule::run(Event* event) {
                     continue;
                 }
                 double diffusion_constant = boltzmann_kT_ * (*mobility_)(type, efield_mag, doping);
-                double diffusion_std_dev = std::sqrt(2. * diffusion_constant * integration_time_);
-                LOG(TRACE) << "Diffusion width of this charge carrier is " << Units::display(diffusion_std_dev, "um");
+                double diffusion_std_dev_undepleted = std::sqrt(2. * diffusion_constant * integration_time_);
+                LOG(TRACE) << "Diffusion width of this charge carrier is "
+                           << Units::display(diffusion_std_dev_undepleted, "um");
 
-                allpix::normal_distribution<double> gauss_distribution(0, diffusion_std_dev);
+                allpix::normal_distribution<double> gauss_distribution(0, diffusion_std_dev_undepleted);
                 double diffusion_x = gauss_distribution(event->getRandomEngine());
                 double diffusion_y = gauss_distribution(event->getRandomEngine());
                 double diffusion_z = gauss_distribution(event->getRandomEngine());
@@ -271,25 +318,11 @@ void ProjectionPropagationModule::run(Event* event) {
                     continue;
                 }
 
-                std::function<ROOT::Math::XYZPoint(const ROOT::Math::XYZPoint&, const ROOT::Math::XYZPoint&)> interval;
-                interval = [this, &interval](const ROOT::Math::XYZPoint& start,
-                                             const ROOT::Math::XYZPoint& stop) -> ROOT::Math::XYZPoint {
-                    // Break nested intervals at a precision of 0.01 um
-                    if(std::sqrt((stop - ROOT::Math::XYZVector(start)).Mag2()) < 0.00001) {
-                        return stop;
-                    }
-                    auto efield_center = detector_->getElectricField((stop + ROOT::Math::XYZVector(start)) / 2.);
-                    double efield_center_mag = std::sqrt(efield_center.Mag2());
-                    if(efield_center_mag > std::numeric_limits<double>::epsilon()) {
-                        return interval(start, (stop + ROOT::Math::XYZVector(start)) / 2.);
-                    } else {
-                        return interval((stop + ROOT::Math::XYZVector(start)) / 2., stop);
-                    }
-                };
-
-                position = interval(position, local_position_diffusion);
-                efield = detector_->getElectricField(position);
-                efield_mag = std::sqrt(efield.Mag2());
+                // Find the point where the charge carrier enters the electric field
+                position = depletion_crossing(position, local_position_diffusion);
+                efield_mag = std::sqrt(detector_->getElectricField(position).Mag2());
+                recombination_doping = detector_->getDopingConcentration(position);
+                std::tie(drift_time, diffusion_std_dev) = drift(position, efield_mag, doping);
                 diffusion_time = integration_time_ * std::sqrt((position - initial_position).Mag2() /
                                                                (local_position_diffusion - initial_position).Mag2());
 
@@ -316,28 +349,8 @@ void ProjectionPropagationModule::run(Event* event) {
             }
 
             LOG(TRACE) << "Electric field at carrier position / top of the sensor: "
-                       << Units::display(efield_mag_top, "V/cm") << " , " << Units::display(efield_mag, "V/cm");
-
-            auto slope_efield = (efield_mag_top - efield_mag) / (std::abs(top_z_ - position.z()));
-
-            // Calculate the drift time
-            auto calc_drift_time = [&]() {
-                if(position.z() == top_z_) {
-                    return 0.;
-                }
+                       << Units::display(efield_mag_top_, "V/cm") << " , " << Units::display(efield_mag, "V/cm");
 
-                double Ec = (type == CarrierType::ELECTRON ? electron_Ec_ : hole_Ec_);
-
-                return ((log(efield_mag_top) - log(efield_mag)) / slope_efield + std::abs(top_z_ - position.z()) / Ec) /
-                       (*mobility_)(type, 0, doping);
-            };
-            LOG(TRACE) << "Electric field is " << Units::display(efield_mag, "V/cm");
-
-            // Assume linear electric field over the depleted part of the sensor
-            double diffusion_constant =
-                boltzmann_kT_ * ((*mobility_)(type, efield_mag, doping) + (*mobility_)(type, efield_mag_top, doping)) / 2.;
-
-            double drift_time = calc_drift_time();
             double propagation_time = drift_time + diffusion_time;
             LOG(TRACE) << "Drift time is " << Units::display(drift_time, "ns");
 
@@ -349,13 +362,11 @@ void ProjectionPropagationModule::run(Event* event) {
                 }
             }
 
-            double diffusion_std_dev = std::sqrt(2. * diffusion_constant * drift_time);
             LOG(TRACE) << "Diffusion width is " << Units::display(diffusion_std_dev, "um");
 
             // Check if charge carrier is still alive via its survival probability, evaluated once
             allpix::uniform_real_distribution<double> survival(0, 1);
-            if(recombination_(
-                   type, detector_->getDopingConcentration(position), survival(event->getRandomEngine()), drift_time)) {
+            if(recombination_(type, recombination_doping, survival(event->getRandomEngine()), drift_time)) {
                 LOG(DEBUG) << "Recombined " << charge_per_step << " charge carriers (" << type << ") at "
                            << Units::display(position, {"mm", "um"});
                 recombined_charges_count += charge_per_step;
@@ -408,7 +419,8 @@ void ProjectionPropagationModule::run(Event* event) {
                                             local_time,
                                             global_time,
                                             CarrierState::HALTED,
-                                            &deposit);
+                                            deposited_charge,
+                                            mc_particle);
 
             LOG(DEBUG) << "Propagated " << charge_per_step << " " << type << " to "
                        << Units::display(local_position, {"mm", "um"}) << " in " << Units::display(global_time, "ns")
@@ -417,7 +429,20 @@ void ProjectionPropagationModule::run(Event* event) {
             projected_charge += charge_per_step;
         }
         total_projected_charge += projected_charge;
+    };
+
+    // Loop over all deposits for propagation
+    if(deposits_message != nullptr) {
+        for(const auto& deposit : deposits_message->getData()) {
+            propagate_deposit(deposit, &deposit, nullptr);
+        }
+    }
+    if(deposit_points_message != nullptr) {
+        for(const auto& deposit : deposit_points_message->getData()) {
+            propagate_deposit(deposit, nullptr, deposit_points_message->getMCParticle(deposit));
+        }
     }
+
     charge_lost = total_charge - total_projected_charge;
 
     LOG(INFO) << "Total charge: " << total_charge << " (lost: " << charge_lost << ", "
@@ -441,6 +466,59 @@ void ProjectionPropagationModule::run(Event* event) {
     messenger_->dispatchMessage(this, propagated_charge_message, event);
 }
 
+/**
+ * The drift time is calculated analytically assuming a linear electric field between the carrier position and the
+ * collection surface, the diffusion width from the average diffusion constant at both ends.
+ */
+std::pair<double, double>
+ProjectionPropagationModule::drift(const ROOT::Math::XYZPoint& position, double efield_mag, double doping) const {
+    if(position.z() == top_z_) {
+        return {0., 0.};
+    }
+
+    auto type = propagate_type_;
+    auto slope_efield = (efield_mag_top_ - efield_mag) / (std::abs(top_z_ - position.z()));
+
+    // Calculate the drift time
+    double Ec = (type == CarrierType::ELECTRON ? electron_Ec_ : hole_Ec_);
+    double drift_time = ((log(efield_mag_top_) - log(efield_mag)) / slope_efield + std::abs(top_z_ - position.z()) / Ec) /
+                        (*mobility_)(type, 0, doping);
+    LOG(TRACE) << "Electric field is " << Units::display(efield_mag, "V/cm");
+
+    // Assume linear electric field over the depleted part of the sensor
+    double diffusion_constant =
+        boltzmann_kT_ * ((*mobility_)(type, efield_mag, doping) + (*mobility_)(type, efield_mag_top_, doping)) / 2.;
+
+    return {drift_time, std::sqrt(2. * diffusion_constant * drift_time)};
+}
+
+/**
+ * Within the pixel matrix the linear electric field only depends on z, the crossing point is then found as intersection with
+ * the depletion edge located during initialization. Otherwise, the crossing is found by nested intervals along the path.
+ */
+ROOT::Math::XYZPoint ProjectionPropagationModule::depletion_crossing(const ROOT::Math::XYZPoint& start,
+                                                                    const ROOT::Math::XYZPoint& stop) const {
+    if(depletion_edge_.has_value() && model_->isWithinMatrix(start) && model_->isWithinMatrix(stop) &&
+       (start.z() - depletion_edge_.value()) * (stop.z() - depletion_edge_.value()) < 0) {
+        auto fraction = (depletion_edge_.value() - start.z()) / (stop.z() - start.z());
+        auto crossing = start + (stop - start) * fraction;
+        return {crossing.x(), crossing.y(), depletion_edge_.value()};
+    }
+
+    auto from = start;
+    auto to = stop;
+    // Break nested intervals at a precision of 0.01 um
+    while(std::sqrt((to - from).Mag2()) >= 0.00001) {
+        auto center = (to + ROOT::Math::XYZVector(from)) / 2.;
+        if(std::sqrt(detector_->getElectricField(center).Mag2()) > std::numeric_limits<double>::epsilon()) {
+            to = center;
+        } else {
+            from = center;
+        }
+    }
+    return to;
+}
+
 void ProjectionPropagationModule::finalize() {
     if(output_plots_) {
         group_size_histo_->Get()->GetXaxis()->SetRange(1, group_size_histo_->Get()->GetNbinsX() + 1);
@@ -13,7 +13,9 @@
  * Refer to the User's Manual for more details.
  */
 
+#include <optional>
 #include <string>
+#include <utility>
 
 #include <TH1D.h>
 
@@ -67,6 +69,23 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Calculate drift time and diffusion width of charge carriers drifting to the collection surface
+         * @param position   Position at which the drift starts
+         * @param efield_mag Magnitude of the electric field at this position
+         * @param doping     Doping concentration
+         * @return Pair of drift time and standard deviation of the diffusion
+         */
+        std::pair<double, double> drift(const ROOT::Math::XYZPoint& position, double efield_mag, double doping) const;
+
+        /**
+         * @brief Find the point where a path from the undepleted region enters the electric field
+         * @param start Starting point of the path without electric field
+         * @param stop  End point of the path within the electric field
+         * @return First point along the path with non-zero electric field
+         */
+        ROOT::Math::XYZPoint depletion_crossing(const ROOT::Math::XYZPoint& start, const ROOT::Math::XYZPoint& stop) const;
+
         Messenger* messenger_;
         std::shared_ptr<const Detector> detector_;
         std::shared_ptr<DetectorModel> model_;
@@ -82,6 +101,10 @@ namespace allpix {
         CarrierType propagate_type_;
         // Side to propagate too
         double top_z_;
+        // Electric field magnitude at the collection surface
+        double efield_mag_top_{};
+        // Position of the depletion edge along z, if the sensor is not fully depleted
+        std::optional<double> depletion_edge_;
 
         // Precalculated values for electron and hole critical fields
         double hole_Ec_;
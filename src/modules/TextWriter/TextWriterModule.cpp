@@ -12,12 +12,14 @@
 #include "TextWriterModule.hpp"
 
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <utility>
 
 #include <TBranchElement.h>
 #include <TClass.h>
 
+#include "core/config/ConfigManager.hpp"
 #include "core/config/ConfigReader.hpp"
 #include "core/utils/log.h"
 #include "core/utils/type.h"
@@ -34,6 +36,15 @@ TextWriterModule::TextWriterModule(Configuration& config, Messenger* messenger,
 
     // Bind to all messages with filter
     messenger_->registerFilter(this, &TextWriterModule::filter);
+
+    config_.setDefault("require_sequence", true);
+    config_.setDefault("buffer_size", 1048576);
+
+    // Events are always formatted in parallel, the event order is restored when appending them to the output buffer
+    waive_sequence_requirement();
+    require_sequence_ = config_.get<bool>("require_sequence");
+
+    buffer_size_ = config_.get<size_t>("buffer_size");
 }
 
 void TextWriterModule::initialize() {
@@ -43,6 +54,9 @@ void TextWriterModule::initialize() {
 
     *output_file_ << "# Allpix Squared ASCII data - https://cern.ch/allpix-squared" << std::endl << std::endl;
 
+    // The first event to be written depends on the number of skipped events
+    next_event_ = getConfigManager()->getGlobalConfiguration().get<uint64_t>("skip_events", 0) + 1;
+
     // Read include and exclude list
     if(config_.has("include") && config_.has("exclude")) {
         throw InvalidValueError(config_, "exclude", "include and exclude parameter are mutually exclusive");
@@ -98,31 +112,74 @@ bool TextWriterModule::filter(const std::shared_ptr<BaseMessage>& message, const
 
 void TextWriterModule::run(Event* event) {
     auto messages = messenger_->fetchFilteredMessages(this, event);
-    LOG(TRACE) << "Writing new objects to text file";
+    LOG(TRACE) << "Formatting new objects for text file";
+
+    // Format the full event into a local buffer without flushing after every line
+    std::ostringstream event_buffer;
 
     // Print the current event:
-    *output_file_ << "=== " << event->number << " ===" << std::endl;
+    event_buffer << "=== " << event->number << " ===\n";
 
     for(auto& pair : messages) {
         auto& message = pair.first;
 
         // Print the current detector:
         if(message->getDetector() != nullptr) {
-            *output_file_ << "--- " << message->getDetector()->getName() << " ---" << std::endl;
+            event_buffer << "--- " << message->getDetector()->getName() << " ---\n";
         } else {
-            *output_file_ << "--- <global> ---" << std::endl;
+            event_buffer << "--- <global> ---\n";
         }
         for(auto& object : message->getObjectArray()) {
             // Print the object's ASCII representation:
-            *output_file_ << object << std::endl;
+            event_buffer << object << '\n';
             write_cnt_++;
         }
         msg_cnt_++;
     }
+
+    append_event(event->number, event_buffer.str());
+}
+
+void TextWriterModule::skip_event(uint64_t event_num) {
+    // Nothing will be written for this event, but subsequent events should not wait for it
+    append_event(event_num, std::string());
+}
+
+void TextWriterModule::append_event(uint64_t event_num, std::string formatted_event) {
+    std::lock_guard<std::mutex> lock{buffer_mutex_};
+    if(require_sequence_) {
+        // Keep the event until all its predecessors have been appended
+        pending_events_.emplace(event_num, std::move(formatted_event));
+        while(!pending_events_.empty() && pending_events_.begin()->first == next_event_) {
+            buffer_ += pending_events_.begin()->second;
+            pending_events_.erase(pending_events_.begin());
+            next_event_++;
+        }
+    } else {
+        buffer_ += formatted_event;
+    }
+
+    if(buffer_.size() >= buffer_size_) {
+        LOG(TRACE) << "Writing " << buffer_.size() << " bytes to text file";
+        output_file_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
 }
 
 void TextWriterModule::finalize() {
-    // Finish writing to output file
+    // Events following an interrupted event cannot be written in sequence, append them in order of their event number
+    if(!pending_events_.empty()) {
+        LOG(WARNING) << "Appending " << pending_events_.size() << " events without their predecessor events "
+                     << next_event_ << " to " << (pending_events_.begin()->first - 1);
+        for(auto& pending : pending_events_) {
+            buffer_ += pending.second;
+        }
+        pending_events_.clear();
+    }
+
+    // Write remaining buffered events and finish writing to output file
+    output_file_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
     *output_file_ << "# " << write_cnt_ << " objects from " << msg_cnt_ << " messages" << std::endl;
 
     // Print statistics
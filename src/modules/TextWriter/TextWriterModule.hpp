@@ -12,6 +12,7 @@
 #include <atomic>
 #include <fstream>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "core/config/Configuration.hpp"
@@ -25,7 +26,10 @@ namespace allpix {
      * @ingroup Modules
      * @brief Module to write object data to simple ASCII text files
      *
-     * Listens to all objects dispatched in the framework and stores an ASCII representation of every object to file.
+     * Listens to all objects dispatched in the framework and stores an ASCII representation of every object to file. The
+     * representation of each event is formatted into a separate buffer in parallel on all workers. Only appending the
+     * formatted events to the output buffer is serialized, either in order of their event number or in order of completion,
+     * and the output buffer is written to file in batches.
      */
     class TextWriterModule : public SequentialModule {
     public:
@@ -61,7 +65,21 @@ namespace allpix {
         void finalize() override;
 
     private:
+        /**
+         * @brief Append a formatted event to the output buffer and write the buffer to file once it is full
+         * @param event_num Number of the event
+         * @param formatted_event Text representation of the event
+         */
+        void append_event(uint64_t event_num, std::string formatted_event);
+
+        /**
+         * @brief Release the slot of events which have not been processed by this module
+         * @param event_num Number of the skipped event
+         */
+        void skip_event(uint64_t event_num) override;
+
         Messenger* messenger_;
+        bool require_sequence_{};
 
         // Object names to include or exclude from writing
         std::set<std::string> include_;
@@ -71,6 +89,13 @@ namespace allpix {
         std::string output_file_name_{};
         std::unique_ptr<std::ofstream> output_file_;
 
+        // Formatted events not yet written to the output file, and events waiting for their predecessors to be formatted
+        std::mutex buffer_mutex_;
+        std::string buffer_;
+        size_t buffer_size_{};
+        std::map<uint64_t, std::string> pending_events_;
+        uint64_t next_event_{1};
+
         // Statistical information about number of objects
         std::atomic<unsigned long> write_cnt_{};
         std::atomic<unsigned long> msg_cnt_{};
@@ -20,6 +20,7 @@
 
 #include "core/utils/distributions.h"
 #include "core/utils/log.h"
+#include "core/utils/text.h"
 #include "objects/exceptions.h"
 #include "tools/runge_kutta.h"
 
@@ -39,6 +40,7 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
 
     // Set default value for config variables
     config_.setDefault<double>("timestep", Units::get(0.01, "ns"));
+    config_.setDefault<std::string>("integration_method", "rkf45");
     config_.setDefault<double>("integration_time", Units::get(25, "ns"));
     config_.setDefault<unsigned int>("charge_per_step", 10);
     config_.setDefault<unsigned int>("max_charge_groups", 1000);
@@ -48,10 +50,12 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
     config_.setDefault<std::string>("recombination_model", "none");
     config_.setDefault<std::string>("trapping_model", "none");
     config_.setDefault<std::string>("detrapping_model", "none");
+    config_.setDefault<bool>("sample_lifetimes", false);
 
     config_.setDefault<double>("temperature", 293.15);
     config_.setDefault<unsigned int>("distance", 1);
     config_.setDefault<bool>("ignore_magnetic_field", false);
+    config_.setDefault<bool>("precompute_velocity", false);
 
     // Set defaults for charge carrier multiplication
     config_.setDefault<double>("multiplication_threshold", 1e-2);
@@ -75,6 +79,10 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
     // Copy some variables from configuration to avoid lookups:
     temperature_ = config_.get<double>("temperature");
     timestep_ = config_.get<double>("timestep");
+    integration_method_ = allpix::transform(config_.get<std::string>("integration_method"), ::tolower);
+    if(integration_method_ != "rkf45" && integration_method_ != "dopri5") {
+        throw InvalidValueError(config_, "integration_method", "Integration method must be either 'rkf45' or 'dopri5'");
+    }
     integration_time_ = config_.get<double>("integration_time");
     distance_ = config_.get<unsigned int>("distance");
     charge_per_step_ = config_.get<unsigned int>("charge_per_step");
@@ -83,6 +91,7 @@ TransientPropagationModule::TransientPropagationModule(Configuration& config,
 
     max_multiplication_level_ = config.get<unsigned int>("max_multiplication_level");
 
+    sample_lifetimes_ = config_.get<bool>("sample_lifetimes");
     output_plots_ = config_.get<bool>("output_plots");
     output_linegraphs_ = config_.get<bool>("output_linegraphs");
     output_linegraphs_collected_ = config_.get<bool>("output_linegraphs_collected");
@@ -151,6 +160,9 @@ void TransientPropagationModule::initialize() {
         }
     }
 
+    // Precompute drift velocity and diffusion constant on the electric field grid for both carrier types if requested
+    drift_maps_ = DriftMaps(config_, *detector_, mobility_, boltzmann_kT_, has_magnetic_field_);
+
     if(output_plots_) {
 
         auto pitch_x = static_cast<double>(Units::convert(model_->getPixelSize().x(), "um"));
@@ -438,16 +450,21 @@ void TransientPropagationModule::run(Event* event) {
             charges_remaining -= charge_per_step;
 
             // Get position and propagate through sensor
-            auto [recombined, trapped, propagated] = propagate(event,
-                                                               deposit,
-                                                               deposit.getLocalPosition(),
-                                                               deposit.getType(),
-                                                               charge_per_step,
-                                                               deposit.getLocalTime(),
-                                                               deposit.getGlobalTime(),
-                                                               0,
-                                                               propagated_charges,
-                                                               output_plot_points);
+            auto propagate_deposit = [&](auto tableau) {
+                return propagate<decltype(tableau)>(event,
+                                                    deposit,
+                                                    deposit.getLocalPosition(),
+                                                    deposit.getType(),
+                                                    charge_per_step,
+                                                    deposit.getLocalTime(),
+                                                    deposit.getGlobalTime(),
+                                                    0,
+                                                    propagated_charges,
+                                                    output_plot_points);
+            };
+            auto [recombined, trapped, propagated] =
+                (integration_method_ == "dopri5" ? propagate_deposit(tableau::DormandPrince54())
+                                                 : propagate_deposit(tableau::Fehlberg45()));
 
             // Update statistics:
             recombined_charges_count += recombined;
@@ -493,8 +510,9 @@ void TransientPropagationModule::run(Event* event) {
 /**
  * Propagation is simulated using a parameterization for the electron mobility. This is used to calculate the electron
  * velocity at every point with help of the electric field map of the detector. A Runge-Kutta integration is applied in
- * multiple steps, adding a random diffusion to the propagating charge every step.
+ * multiple steps with a fixed time step, adding a random diffusion to the propagating charge every step.
  */
+template <typename Tableau>
 std::tuple<unsigned int, unsigned int, unsigned int>
 TransientPropagationModule::propagate(Event* event,
                                       const DepositedCharge& deposit,
@@ -531,8 +549,12 @@ TransientPropagationModule::propagate(Event* event,
     const unsigned int initial_charge = charge;
 
     // Define a function to compute the diffusion
-    auto carrier_diffusion = [&](double efield_mag, double doping, double timestep) -> Eigen::Vector3d {
-        double diffusion_constant = boltzmann_kT_ * mobility_(type, efield_mag, doping);
+    auto carrier_diffusion =
+        [&](const Eigen::Vector3d& cur_pos, double efield_mag, double doping, double timestep) -> Eigen::Vector3d {
+        double diffusion_constant =
+            (drift_maps_.enabled()
+                 ? drift_maps_.diffusion(type, static_cast<ROOT::Math::XYZPoint>(cur_pos), efield_mag, doping)
+                 : boltzmann_kT_ * mobility_(type, efield_mag, doping));
         double diffusion_std_dev = std::sqrt(2. * diffusion_constant * timestep);
 
         // Compute the independent diffusion in three
@@ -543,31 +565,31 @@ TransientPropagationModule::propagate(Event* event,
         return Eigen::Vector3d(x, y, z);
     };
 
-    // Survival probability of this charge carrier package, evaluated at every step
+    // Detrapping time and multiplication of this charge carrier package, evaluated when needed
     allpix::uniform_real_distribution<double> uniform_distribution(0, 1);
 
-    // Define lambda functions to compute the charge carrier velocity with or without magnetic field
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_noB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
-        auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-        Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
+    // Remaining lifetimes of this charge carrier package with respect to recombination and trapping
+    CarrierLifetime recombination_lifetime(event->getRandomEngine(), sample_lifetimes_);
+    CarrierLifetime trapping_lifetime(event->getRandomEngine(), sample_lifetimes_);
 
-        auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-
-        return static_cast<int>(type) * mobility_(type, efield.norm(), doping) * efield;
-    };
+    // Define a function to compute the charge carrier velocity with or without magnetic field
+    auto carrier_velocity = [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
+        if(drift_maps_.enabled()) {
+            auto velocity = drift_maps_.velocity(type, static_cast<ROOT::Math::XYZPoint>(cur_pos));
+            return Eigen::Vector3d(velocity.x(), velocity.y(), velocity.z());
+        }
 
-    std::function<Eigen::Vector3d(double, const Eigen::Vector3d&)> carrier_velocity_withB =
-        [&](double, const Eigen::Vector3d& cur_pos) -> Eigen::Vector3d {
         auto raw_field = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
         Eigen::Vector3d efield(raw_field.x(), raw_field.y(), raw_field.z());
+        auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(cur_pos));
+
+        if(!has_magnetic_field_) {
+            return static_cast<int>(type) * mobility_(type, efield.norm(), doping) * efield;
+        }
 
-        Eigen::Vector3d velocity;
         auto magnetic_field = detector_->getMagneticField(static_cast<ROOT::Math::XYZPoint>(cur_pos));
         Eigen::Vector3d bfield(magnetic_field.x(), magnetic_field.y(), magnetic_field.z());
 
-        auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(cur_pos));
-
         auto mob = mobility_(type, efield.norm(), doping);
         auto exb = efield.cross(bfield);
 
@@ -581,9 +603,8 @@ TransientPropagationModule::propagate(Event* event,
         return static_cast<int>(type) * mob * (efield + term1 + term2) / rnorm;
     };
 
-    // Create the runge kutta solver with an RKF5 tableau
-    auto runge_kutta = make_runge_kutta(
-        tableau::RK5, (has_magnetic_field_ ? carrier_velocity_withB : carrier_velocity_noB), timestep_, position);
+    // Create the runge kutta solver with the selected tableau
+    auto runge_kutta = make_adaptive_runge_kutta<Tableau>(carrier_velocity, timestep_, position);
 
     // Continue propagation until the deposit is outside the sensor
     Eigen::Vector3d last_position = position;
@@ -614,21 +635,19 @@ TransientPropagationModule::propagate(Event* event,
         efield = detector_->getElectricField(static_cast<ROOT::Math::XYZPoint>(position));
         auto doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position));
 
-        // Apply diffusion step
-        auto diffusion = carrier_diffusion(std::sqrt(efield.Mag2()), doping, timestep_);
+        // Apply diffusion step, the velocity at the end of the drift step is reused as first stage of the next step
+        auto diffusion = carrier_diffusion(position, std::sqrt(efield.Mag2()), doping, timestep_);
         position += diffusion;
-        runge_kutta.setValue(position);
+        runge_kutta.displace(diffusion);
 
         // Check if charge carrier is still alive:
-        if(recombination_(type,
-                          detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position)),
-                          uniform_distribution(event->getRandomEngine()),
-                          timestep_)) {
+        auto recombination_doping = detector_->getDopingConcentration(static_cast<ROOT::Math::XYZPoint>(position));
+        if(recombination_.recombined(type, recombination_doping, recombination_lifetime, timestep_)) {
             state = CarrierState::RECOMBINED;
         }
 
         // Check if the charge carrier has been trapped:
-        if(trapping_(type, uniform_distribution(event->getRandomEngine()), timestep_, std::sqrt(efield.Mag2()))) {
+        if(trapping_.trapped(type, std::sqrt(efield.Mag2()), trapping_lifetime, timestep_)) {
             if(output_plots_) {
                 trapping_time_histo_->Fill(runge_kutta.getTime(), charge);
             }
@@ -639,6 +658,9 @@ TransientPropagationModule::propagate(Event* event,
                 LOG(TRACE) << "De-trapping charge carrier after " << Units::display(detrap_time, {"ns", "us"});
                 runge_kutta.advanceTime(detrap_time);
 
+                // Sample a new trapping lifetime for the released charge carrier
+                trapping_lifetime.reset();
+
                 if(output_plots_) {
                     detrapping_time_histo_->Fill(static_cast<double>(Units::convert(detrap_time, "ns")), charge);
                 }
@@ -681,16 +703,16 @@ TransientPropagationModule::propagate(Event* event,
                     multiplication_depth_histo_->Fill(carrier_pos.z(), n_secondaries);
                 }
 
-                auto [recombined, trapped, propagated] = propagate(event,
-                                                                   deposit,
-                                                                   carrier_pos,
-                                                                   inverted_type,
-                                                                   n_secondaries,
-                                                                   initial_time_local + runge_kutta.getTime(),
-                                                                   initial_time_global + runge_kutta.getTime(),
-                                                                   level + 1,
-                                                                   propagated_charges,
-                                                                   output_plot_points);
+                auto [recombined, trapped, propagated] = propagate<Tableau>(event,
+                                                                            deposit,
+                                                                            carrier_pos,
+                                                                            inverted_type,
+                                                                            n_secondaries,
+                                                                            initial_time_local + runge_kutta.getTime(),
+                                                                            initial_time_global + runge_kutta.getTime(),
+                                                                            level + 1,
+                                                                            propagated_charges,
+                                                                            output_plot_points);
 
                 // Update statistics:
                 recombined_charges_count += recombined;
@@ -9,6 +9,7 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <array>
 #include <string>
 
 #include <Math/DisplacementVector2D.h>
@@ -27,6 +28,7 @@
 #include "objects/Pulse.hpp"
 
 #include "physics/Detrapping.hpp"
+#include "physics/DriftMaps.hpp"
 #include "physics/ImpactIonization.hpp"
 #include "physics/Mobility.hpp"
 #include "physics/Recombination.hpp"
@@ -91,7 +93,9 @@ namespace allpix {
          * @param output_plot_points Reference to vector to hold points for line graph output plots
          *
          * @return Total recombined, trapped and propagated charge for statistics purposes
+         * @tparam Tableau Runge-Kutta tableau used for the integration of the equation of motion
          */
+        template <typename Tableau>
         std::tuple<unsigned int, unsigned int, unsigned int>
         propagate(Event* event,
                   const DepositedCharge& deposit,
@@ -105,7 +109,9 @@ namespace allpix {
                   LineGraph::OutputPlotPoints& output_plot_points) const;
 
         // Local copies of configuration parameters to avoid costly lookup:
+        std::string integration_method_;
         double temperature_{}, timestep_{}, integration_time_{}, output_plots_step_{};
+        bool sample_lifetimes_{};
         bool output_plots_{}, output_linegraphs_{}, output_linegraphs_collected_{}, output_linegraphs_recombined_{},
             output_linegraphs_trapped_{};
         unsigned int distance_{};
@@ -131,6 +137,9 @@ namespace allpix {
         // Magnetic field
         bool has_magnetic_field_{};
 
+        // Precomputed drift velocity and diffusion constant maps
+        DriftMaps drift_maps_;
+
         // Deposit statistics
         std::atomic<unsigned int> total_deposits_{}, deposits_exceeding_max_groups_{};
 
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Definition of lightweight charge deposits and the message carrying them
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_DEPOSIT_POINT_H
+#define ALLPIX_DEPOSIT_POINT_H
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Math/Point3D.h>
+
+#include "core/messenger/Message.hpp"
+
+#include "DepositedCharge.hpp"
+#include "MCParticle.hpp"
+
+namespace allpix {
+    /**
+     * @ingroup Objects
+     * @brief Lightweight charge deposit in sensor of detector
+     *
+     * Plain data alternative to \ref DepositedCharge for sources producing many deposits per event. Instead of a reference,
+     * the related Monte-Carlo particle is identified by its index in the MCParticle message dispatched together with the
+     * deposits. The accessors mirror those of \ref SensorCharge.
+     */
+    struct DepositPoint {
+        /**
+         * @brief Index marking deposits without related Monte-Carlo particle
+         */
+        static constexpr size_t no_mc_particle = std::numeric_limits<size_t>::max();
+
+        ROOT::Math::XYZPoint local_position;
+        ROOT::Math::XYZPoint global_position;
+        CarrierType type{};
+        unsigned int charge{};
+        double local_time{};
+        double global_time{};
+        size_t mc_particle{no_mc_particle};
+
+        ROOT::Math::XYZPoint getLocalPosition() const { return local_position; }
+        ROOT::Math::XYZPoint getGlobalPosition() const { return global_position; }
+        CarrierType getType() const { return type; }
+        unsigned int getCharge() const { return charge; }
+        double getLocalTime() const { return local_time; }
+        double getGlobalTime() const { return global_time; }
+    };
+
+    /**
+     * @brief Message carrying lightweight deposits
+     *
+     * Consumers read the deposits directly from \ref getData. Full \ref DepositedCharge objects are only created when
+     * requested through \ref getObjectArray, e.g. by output writers, and are linked to the Monte-Carlo particles of the
+     * message passed at construction.
+     */
+    class DepositPointMessage : public Message<DepositPoint> {
+    public:
+        /**
+         * @brief Construct a message bound to a detector containing the supplied deposits
+         * @param data List of deposits
+         * @param detector Linked detector
+         * @param mc_particle_message Optional message holding the Monte-Carlo particles indexed by the deposits
+         */
+        DepositPointMessage(std::vector<DepositPoint> data,
+                            const std::shared_ptr<const Detector>& detector,
+                            std::shared_ptr<MCParticleMessage> mc_particle_message = nullptr)
+            : Message<DepositPoint>(std::move(data), detector), mc_particle_message_(std::move(mc_particle_message)) {}
+
+        /**
+         * @brief Get the Monte-Carlo particle related to a deposit
+         * @param deposit Deposit from this message
+         * @return Pointer to the Monte-Carlo particle, or nullptr if the deposit has none
+         */
+        const MCParticle* getMCParticle(const DepositPoint& deposit) const {
+            if(mc_particle_message_ == nullptr || deposit.mc_particle >= mc_particle_message_->getData().size()) {
+                return nullptr;
+            }
+            return &mc_particle_message_->getData()[deposit.mc_particle];
+        }
+
+        /**
+         * @brief Get the deposits as full objects, creating them on first access
+         * @return List of deposited charges
+         */
+        const std::vector<DepositedCharge>& getDepositedCharges() {
+            std::call_once(materialized_, [this]() {
+                deposited_charges_.reserve(getData().size());
+                for(const auto& deposit : getData()) {
+                    deposited_charges_.emplace_back(deposit.local_position,
+                                                    deposit.global_position,
+                                                    deposit.type,
+                                                    deposit.charge,
+                                                    deposit.local_time,
+                                                    deposit.global_time,
+                                                    getMCParticle(deposit));
+                    // Cleanup is handled by this message, see Message::skip_object_cleanup
+                    deposited_charges_.back().ResetBit(kMustCleanup);
+                }
+            });
+            return deposited_charges_;
+        }
+
+        /**
+         * @brief Get the deposits as list of objects, creating them on first access
+         * @return List of object references to the deposited charges
+         */
+        std::vector<std::reference_wrapper<Object>> getObjectArray() override {
+            getDepositedCharges();
+            return {deposited_charges_.begin(), deposited_charges_.end()};
+        }
+
+    private:
+        std::shared_ptr<MCParticleMessage> mc_particle_message_;
+
+        std::once_flag materialized_;
+        std::vector<DepositedCharge> deposited_charges_;
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_DEPOSIT_POINT_H */
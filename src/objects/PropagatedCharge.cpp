@@ -25,12 +25,15 @@ PropagatedCharge::PropagatedCharge(ROOT::Math::XYZPoint local_position,
                                    double local_time,
                                    double global_time,
                                    CarrierState state,
-                                   const DepositedCharge* deposited_charge)
+                                   const DepositedCharge* deposited_charge,
+                                   const MCParticle* mc_particle)
     : SensorCharge(std::move(local_position), std::move(global_position), type, charge, local_time, global_time),
       state_(state) {
     deposited_charge_ = PointerWrapper<DepositedCharge>(deposited_charge);
     if(deposited_charge != nullptr) {
         mc_particle_ = deposited_charge->mc_particle_;
+    } else {
+        mc_particle_ = PointerWrapper<MCParticle>(mc_particle);
     }
 }
 
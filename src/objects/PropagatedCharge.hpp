@@ -51,6 +51,7 @@ namespace allpix {
          * @param global_time Total time of propagation arrival after event start, global reference frame
          * @param state State of the charge carrier when reaching its position
          * @param deposited_charge Optional pointer to related deposited charge
+         * @param mc_particle Optional pointer to related MC particle, only used without deposited charge
          */
         PropagatedCharge(ROOT::Math::XYZPoint local_position,
                          ROOT::Math::XYZPoint global_position,
@@ -59,7 +60,8 @@ namespace allpix {
                          double local_time,
                          double global_time,
                          CarrierState state = CarrierState::UNKNOWN,
-                         const DepositedCharge* deposited_charge = nullptr);
+                         const DepositedCharge* deposited_charge = nullptr,
+                         const MCParticle* mc_particle = nullptr);
 
         /**
          * @brief Construct a set of propagated charges
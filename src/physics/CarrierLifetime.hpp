@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Definition of the remaining lifetime of a charge carrier with respect to recombination or trapping
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_CARRIER_LIFETIME_H
+#define ALLPIX_CARRIER_LIFETIME_H
+
+#include <cmath>
+
+#include "core/utils/distributions.h"
+#include "core/utils/prng.h"
+
+namespace allpix {
+
+    /**
+     * @ingroup Models
+     * @brief Remaining lifetime of a single charge carrier with respect to a process with a local lifetime tau(x)
+     *
+     * By default, the process is evaluated at every step by comparing a uniformly distributed random number with the
+     * probability 1 - exp(-dt/tau) of the process to occur within the step. Alternatively, the remaining lifetime of the
+     * charge carrier in units of the local lifetime can be sampled once from an exponential distribution. It is then reduced
+     * by the integrated rate dt/tau at every step, and the process occurs once it is exhausted. Both methods are
+     * statistically equivalent, but the latter requires neither a random number nor an exponential function per step.
+     */
+    class CarrierLifetime {
+    public:
+        /**
+         * @brief Constructs the lifetime of a new charge carrier
+         * @param random_engine Random number generator of the current event
+         * @param sampled       Boolean to select whether the remaining lifetime is sampled once
+         */
+        CarrierLifetime(RandomNumberGenerator& random_engine, bool sampled)
+            : random_engine_(random_engine), sampled_(sampled) {
+            reset();
+        }
+
+        /**
+         * @brief Check if the remaining lifetime is sampled once instead of evaluating the process at every step
+         * @return True if the remaining lifetime is sampled
+         */
+        bool sampled() const { return sampled_; }
+
+        /**
+         * @brief Draw a uniformly distributed random number for the evaluation of the process at the current step
+         * @return Random number between zero and one
+         */
+        double draw() { return uniform_distribution_(random_engine_); }
+
+        /**
+         * @brief Reduce the sampled remaining lifetime by the integrated rate of the current step
+         * @param rate     Local rate of the process, i.e. the inverse lifetime
+         * @param timestep Length of the step
+         * @return True if the remaining lifetime is exhausted and the process occurred, false otherwise
+         */
+        bool elapse(double rate, double timestep) {
+            remaining_ -= rate * timestep;
+            return remaining_ <= 0;
+        }
+
+        /**
+         * @brief Sample a new remaining lifetime, e.g. after a trapped charge carrier has been released
+         */
+        void reset() {
+            if(sampled_) {
+                remaining_ = -std::log1p(-draw());
+            }
+        }
+
+    private:
+        RandomNumberGenerator& random_engine_;
+        allpix::uniform_real_distribution<double> uniform_distribution_{0, 1};
+        bool sampled_;
+        double remaining_{};
+    };
+
+} // namespace allpix
+
+#endif
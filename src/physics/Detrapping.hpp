@@ -20,6 +20,7 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "physics/ModelVariant.hpp"
 
 namespace allpix {
 
@@ -99,11 +100,11 @@ namespace allpix {
                 auto model = config.get<std::string>("detrapping_model", "none");
 
                 if(model == "constant") {
-                    model_ = std::make_unique<ConstantDetrapping>(config.get<double>("detrapping_time_electron"),
-                                                                  config.get<double>("detrapping_time_hole"));
+                    model_.emplace<ConstantDetrapping>(config.get<double>("detrapping_time_electron"),
+                                                       config.get<double>("detrapping_time_hole"));
                 } else if(model == "none") {
                     LOG(INFO) << "No charge carrier detrapping model chosen, no detrapping simulated";
-                    model_ = std::make_unique<NoDetrapping>();
+                    model_.emplace<NoDetrapping>();
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -117,11 +118,11 @@ namespace allpix {
          * @return Detrapping time
          */
         template <class... ARGS> double operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+            return model_(std::forward<ARGS>(args)...);
         }
 
     private:
-        std::unique_ptr<DetrappingModel> model_{};
+        ModelVariant<NoDetrapping, ConstantDetrapping> model_;
     };
 
 } // namespace allpix
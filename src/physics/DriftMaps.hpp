@@ -0,0 +1,138 @@
+/**
+ * @file
+ * @brief Definition of precomputed drift velocity and diffusion constant maps
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_DRIFT_MAPS_H
+#define ALLPIX_DRIFT_MAPS_H
+
+#include <array>
+#include <cmath>
+
+#include <Math/Point3D.h>
+#include <Math/Vector3D.h>
+
+#include "core/config/Configuration.hpp"
+#include "core/config/exceptions.h"
+#include "core/geometry/Detector.hpp"
+#include "core/utils/log.h"
+#include "objects/SensorCharge.hpp"
+#include "physics/Mobility.hpp"
+
+namespace allpix {
+
+    /**
+     * @ingroup Models
+     * @brief Drift velocity and diffusion constant of electrons and holes, precomputed on the electric field grid
+     *
+     * If requested via the parameter `precompute_velocity`, the mobility model is evaluated once for every cell of the
+     * electric field map of the detector, and the drift velocity and diffusion constant are stored in maps with the same
+     * binning and mapping as the electric field. This replaces the electric field lookup, the doping lookup and the mobility
+     * evaluation per step by a single lookup. The doping concentration is sampled at the cell centers of the field map.
+     *
+     * Outside the thickness domain and the grid bounds of the field map, the maps return zero values. The drift velocity
+     * vanishes there as the electric field does, but charge carriers still diffuse, e.g. in the undepleted region of a
+     * partially depleted sensor. The diffusion constant therefore falls back to the mobility model at these positions.
+     */
+    class DriftMaps {
+    public:
+        /**
+         * Default constructor, no maps are precomputed
+         */
+        DriftMaps() = default;
+
+        /**
+         * Drift maps constructor
+         * @param config Configuration of the calling module
+         * @param detector Detector to compute the maps for
+         * @param mobility Mobility model of the charge carriers
+         * @param boltzmann_kT Product of the Boltzmann constant and the temperature
+         * @param magnetic_field Boolean to indicate whether the detector sees a magnetic field
+         */
+        DriftMaps(const Configuration& config,
+                  const Detector& detector,
+                  const Mobility& mobility,
+                  double boltzmann_kT,
+                  bool magnetic_field)
+            : mobility_(&mobility), boltzmann_kT_(boltzmann_kT) {
+            if(!config.get<bool>("precompute_velocity", false)) {
+                return;
+            }
+
+            if(magnetic_field) {
+                throw InvalidValueError(
+                    config, "precompute_velocity", "velocity maps cannot be used in the presence of a magnetic field");
+            }
+            if(detector.getElectricFieldType() != FieldType::GRID) {
+                LOG(WARNING) << "Velocity maps can only be precomputed for electric field maps, computing velocity per step";
+                return;
+            }
+            if(mobility.dependsOnDoping() && detector.hasDopingProfile()) {
+                LOG(INFO) << "Doping concentration for velocity maps is sampled at the cell centers of the field map";
+            }
+
+            for(auto type : {CarrierType::ELECTRON, CarrierType::HOLE}) {
+                velocity_[index(type)] = detector.deriveFromElectricField<ROOT::Math::XYZVector, 3>(
+                    [&](const ROOT::Math::XYZVector& efield, const ROOT::Math::XYZPoint& pos) {
+                        auto doping = detector.getDopingConcentration(pos);
+                        return static_cast<int>(type) * mobility(type, std::sqrt(efield.Mag2()), doping) * efield;
+                    });
+                diffusion_[index(type)] = detector.deriveFromElectricField<double, 1>(
+                    [&](const ROOT::Math::XYZVector& efield, const ROOT::Math::XYZPoint& pos) {
+                        auto doping = detector.getDopingConcentration(pos);
+                        return boltzmann_kT * mobility(type, std::sqrt(efield.Mag2()), doping);
+                    });
+            }
+            enabled_ = true;
+            LOG(INFO) << "Precomputed drift velocity and diffusion constant maps for electrons and holes";
+        }
+
+        /**
+         * @brief Check if the maps have been precomputed
+         * @return True if the maps should be used instead of evaluating the mobility model per step
+         */
+        bool enabled() const { return enabled_; }
+
+        /**
+         * Precomputed drift velocity
+         * @param type Type of charge carrier (electron or hole)
+         * @param pos Position in local coordinates of the detector
+         * @return Drift velocity of the charge carrier, zero outside the electric field
+         */
+        ROOT::Math::XYZVector velocity(const CarrierType& type, const ROOT::Math::XYZPoint& pos) const {
+            return velocity_[index(type)].get(pos);
+        }
+
+        /**
+         * Precomputed diffusion constant
+         * @param type Type of charge carrier (electron or hole)
+         * @param pos Position in local coordinates of the detector
+         * @param efield_mag Magnitude of the electric field at the position, used outside the maps
+         * @param doping Doping concentration at the position, used outside the maps
+         * @return Diffusion constant of the charge carrier
+         */
+        double diffusion(const CarrierType& type, const ROOT::Math::XYZPoint& pos, double efield_mag, double doping) const {
+            // The mobility is strictly positive, a vanishing value indicates a position outside the maps
+            auto diffusion = diffusion_[index(type)].get(pos);
+            return (diffusion > 0 ? diffusion : boltzmann_kT_ * (*mobility_)(type, efield_mag, doping));
+        }
+
+    private:
+        static size_t index(const CarrierType& type) { return (type == CarrierType::ELECTRON ? 0 : 1); }
+
+        bool enabled_{false};
+        const Mobility* mobility_{};
+        double boltzmann_kT_{};
+        std::array<DetectorField<ROOT::Math::XYZVector, 3>, 2> velocity_;
+        std::array<DetectorField<double, 1>, 2> diffusion_;
+    };
+
+} // namespace allpix
+
+#endif
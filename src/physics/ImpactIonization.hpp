@@ -23,6 +23,8 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "physics/ModelVariant.hpp"
+#include "physics/Tabulation.hpp"
 
 namespace allpix {
 
@@ -301,19 +303,35 @@ namespace allpix {
         CustomGain(const Configuration& config, double threshold) : ImpactIonizationModel(threshold) {
             electron_gain_ = configure_gain(config, CarrierType::ELECTRON);
             hole_gain_ = configure_gain(config, CarrierType::HOLE);
+
+            Tabulation tabulation(config);
+            if(tabulation.enabled()) {
+                electron_table_ = tabulate(tabulation, *electron_gain_);
+                hole_table_ = tabulate(tabulation, *hole_gain_);
+            }
         };
 
         double gain_factor(const CarrierType& type, double efield_mag) const override {
             if(type == CarrierType::ELECTRON) {
-                return electron_gain_->Eval(efield_mag);
+                return (electron_table_ ? (*electron_table_)(efield_mag) : electron_gain_->Eval(efield_mag));
             } else {
-                return hole_gain_->Eval(efield_mag);
+                return (hole_table_ ? (*hole_table_)(efield_mag) : hole_gain_->Eval(efield_mag));
             }
         };
 
     private:
         std::unique_ptr<TFormula> electron_gain_;
         std::unique_ptr<TFormula> hole_gain_;
+        std::unique_ptr<TabulatedFunction> electron_table_;
+        std::unique_ptr<TabulatedFunction> hole_table_;
+
+        static std::unique_ptr<TabulatedFunction> tabulate(const Tabulation& tabulation, const TFormula& formula) {
+            auto table = std::make_unique<TabulatedFunction>([&](double efield) { return formula.Eval(efield); },
+                                                             tabulation.field(),
+                                                             TabulatedFunction::Precision{tabulation.precision()});
+            tabulation.report(formula.GetName(), std::to_string(table->bins()) + " bins", table->error());
+            return table;
+        }
 
         std::unique_ptr<TFormula> configure_gain(const Configuration& config, const CarrierType type) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
@@ -370,24 +388,24 @@ namespace allpix {
                 auto threshold = config.get<double>("multiplication_threshold");
 
                 if(model == "massey") {
-                    model_ = std::make_unique<Massey>(temperature, threshold);
+                    model_.emplace<Massey>(temperature, threshold);
                 } else if(model == "massey_optimized") {
-                    model_ = std::make_unique<MasseyOptimized>(temperature, threshold);
+                    model_.emplace<MasseyOptimized>(temperature, threshold);
                 } else if(model == "overstraeten") {
-                    model_ = std::make_unique<VanOverstraetenDeMan>(temperature, threshold);
+                    model_.emplace<VanOverstraetenDeMan>(temperature, threshold);
                 } else if(model == "overstraeten_optimized") {
-                    model_ = std::make_unique<VanOverstraetenDeManOptimized>(temperature, threshold);
+                    model_.emplace<VanOverstraetenDeManOptimized>(temperature, threshold);
                 } else if(model == "okuto") {
-                    model_ = std::make_unique<OkutoCrowell>(temperature, threshold);
+                    model_.emplace<OkutoCrowell>(temperature, threshold);
                 } else if(model == "okuto_optimized") {
-                    model_ = std::make_unique<OkutoCrowellOptimized>(temperature, threshold);
+                    model_.emplace<OkutoCrowellOptimized>(temperature, threshold);
                 } else if(model == "bologna") {
-                    model_ = std::make_unique<Bologna>(temperature, threshold);
+                    model_.emplace<Bologna>(temperature, threshold);
                 } else if(model == "none") {
                     LOG(INFO) << "No impact ionization model chosen, charge multiplication not simulated";
-                    model_ = std::make_unique<NoImpactIonization>();
+                    model_.emplace<NoImpactIonization>();
                 } else if(model == "custom") {
-                    model_ = std::make_unique<CustomGain>(config, threshold);
+                    model_.emplace<CustomGain>(config, threshold);
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -402,7 +420,7 @@ namespace allpix {
          * @return Gain
          */
         template <class... ARGS> double operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+            return model_(std::forward<ARGS>(args)...);
         }
 
         /**
@@ -411,10 +429,19 @@ namespace allpix {
          *     if(model->is<MyModel>()) { }
          * @return Boolean indication whether this model is of the given type or not
          */
-        template <class T> bool is() const { return dynamic_cast<T*>(model_.get()) != nullptr; }
+        template <class T> bool is() const { return model_.template is<T>(); }
 
     private:
-        std::unique_ptr<ImpactIonizationModel> model_{};
+        ModelVariant<NoImpactIonization,
+                     Massey,
+                     MasseyOptimized,
+                     VanOverstraetenDeMan,
+                     VanOverstraetenDeManOptimized,
+                     OkutoCrowell,
+                     OkutoCrowellOptimized,
+                     Bologna,
+                     CustomGain>
+            model_;
     };
 
 } // namespace allpix
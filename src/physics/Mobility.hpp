@@ -12,6 +12,8 @@
 #ifndef ALLPIX_MOBILITY_MODELS_H
 #define ALLPIX_MOBILITY_MODELS_H
 
+#include <optional>
+
 #include <TFormula.h>
 
 #include "exceptions.h"
@@ -21,6 +23,8 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "physics/ModelVariant.hpp"
+#include "physics/Tabulation.hpp"
 #include "tools/tabulated_pow.h"
 
 namespace allpix {
@@ -49,6 +53,12 @@ namespace allpix {
          * @return Mobility of the charge carrier
          */
         virtual double operator()(const CarrierType& type, double efield_mag, double doping) const = 0;
+
+        /**
+         * Indicate whether the mobility depends on the doping concentration
+         * @return True if the model is doping-dependent, false if it only depends on the electric field
+         */
+        virtual bool dependsOnDoping() const { return false; }
     };
 
     /**
@@ -255,6 +265,8 @@ namespace allpix {
             }
         }
 
+        bool dependsOnDoping() const override { return true; }
+
         double operator()(const CarrierType& type, double, double doping) const override {
             if(type == CarrierType::ELECTRON) {
                 return electron_mu0_ +
@@ -335,6 +347,8 @@ namespace allpix {
             }
         }
 
+        bool dependsOnDoping() const override { return true; }
+
         double operator()(const CarrierType& type, double, double doping) const override {
             if(type == CarrierType::ELECTRON) {
                 return electron_mumin_ + electron_mu0_ / (1 + std::pow(std::fabs(doping) / electron_nref_, alpha_));
@@ -485,6 +499,8 @@ namespace allpix {
             }
         }
 
+        bool dependsOnDoping() const override { return true; }
+
         double operator()(const CarrierType& type, double temperature, double doping) const override {
             if(type == CarrierType::ELECTRON) {
                 double B =
@@ -530,6 +546,94 @@ namespace allpix {
         double hole_mobility_;
     };
 
+    /**
+     * @ingroup Models
+     * @brief Lookup table of a mobility function
+     *
+     * The function is tabulated on the electric field magnitude only, or on the electric field magnitude and the doping
+     * concentration if the mobility is doping-dependent. The table is refined until the requested precision is reached.
+     */
+    class MobilityTable {
+    public:
+        /**
+         * Mobility table constructor
+         * @param function   Mobility function, callable with electric field magnitude and doping concentration
+         * @param tabulation Tabulation settings
+         * @param doping     Boolean to indicate whether the doping concentration should be tabulated
+         * @param name       Name of the function for logging
+         */
+        template <typename F>
+        MobilityTable(const F& function, const Tabulation& tabulation, bool doping, const std::string& name) {
+            if(doping) {
+                field_doping_ = std::make_unique<TabulatedFunction2D>(
+                    function, tabulation.field(), tabulation.doping(), tabulation.precision());
+                tabulation.report(name, std::to_string(field_doping_->size()) + " entries", field_doping_->error());
+            } else {
+                field_ = std::make_unique<TabulatedFunction>([&](double efield) { return function(efield, 0.); },
+                                                             tabulation.field(),
+                                                             TabulatedFunction::Precision{tabulation.precision()});
+                tabulation.report(name, std::to_string(field_->bins()) + " bins", field_->error());
+            }
+        }
+
+        /**
+         * Interpolated mobility value
+         * @param efield_mag Magnitude of the electric field
+         * @param doping (Effective) doping concentration
+         * @return Mobility of the charge carrier
+         */
+        double operator()(double efield_mag, double doping) const {
+            return (field_ ? (*field_)(efield_mag) : (*field_doping_)(efield_mag, doping));
+        }
+
+        /**
+         * Maximum relative interpolation error of the table
+         * @return Maximum relative error
+         */
+        double error() const { return (field_ ? field_->error() : field_doping_->error()); }
+
+    private:
+        std::unique_ptr<TabulatedFunction> field_;
+        std::unique_ptr<TabulatedFunction2D> field_doping_;
+    };
+
+    /**
+     * @ingroup Models
+     * @brief Tabulated version of an arbitrary mobility model
+     *
+     * The mobility model is evaluated once at construction and replaced by lookup tables for electrons and holes, trading a
+     * bounded interpolation error for faster evaluation of models with several powers or exponentials.
+     */
+    class TabulatedMobility : public MobilityModel {
+    public:
+        TabulatedMobility(const MobilityModel& model, const Tabulation& tabulation, bool doping)
+            : doping_(doping && model.dependsOnDoping()),
+              electron_table_(tabulate(model, CarrierType::ELECTRON, tabulation, doping_)),
+              hole_table_(tabulate(model, CarrierType::HOLE, tabulation, doping_)) {
+            LOG(INFO) << "This mobility model uses tabulated values with a maximum relative error of "
+                      << std::max(electron_table_.error(), hole_table_.error());
+        }
+
+        double operator()(const CarrierType& type, double efield_mag, double doping) const override {
+            return (type == CarrierType::ELECTRON ? electron_table_(efield_mag, doping) : hole_table_(efield_mag, doping));
+        };
+
+        bool dependsOnDoping() const override { return doping_; }
+
+    private:
+        bool doping_;
+        MobilityTable electron_table_;
+        MobilityTable hole_table_;
+
+        static MobilityTable
+        tabulate(const MobilityModel& model, const CarrierType type, const Tabulation& tabulation, bool doping) {
+            return {[&](double efield, double doping_conc) { return model(type, efield, doping_conc); },
+                    tabulation,
+                    doping,
+                    (type == CarrierType::ELECTRON ? "electron mobility" : "hole mobility")};
+        }
+    };
+
     /**
      * @ingroup Models
      * @brief Custom mobility model for charge carriers
@@ -539,19 +643,40 @@ namespace allpix {
         Custom(const Configuration& config, bool doping) {
             electron_mobility_ = configure_mobility(config, CarrierType::ELECTRON, doping);
             hole_mobility_ = configure_mobility(config, CarrierType::HOLE, doping);
+
+            Tabulation tabulation(config);
+            if(tabulation.enabled()) {
+                electron_table_ = tabulate(tabulation, *electron_mobility_);
+                hole_table_ = tabulate(tabulation, *hole_mobility_);
+            }
         };
 
         double operator()(const CarrierType& type, double efield_mag, double doping) const override {
             if(type == CarrierType::ELECTRON) {
-                return electron_mobility_->Eval(efield_mag, doping);
+                return (electron_table_ ? (*electron_table_)(efield_mag, doping)
+                                        : electron_mobility_->Eval(efield_mag, doping));
             } else {
-                return hole_mobility_->Eval(efield_mag, doping);
+                return (hole_table_ ? (*hole_table_)(efield_mag, doping) : hole_mobility_->Eval(efield_mag, doping));
             }
         };
 
+        bool dependsOnDoping() const override {
+            return electron_mobility_->GetNdim() == 2 || hole_mobility_->GetNdim() == 2;
+        }
+
     private:
         std::unique_ptr<TFormula> electron_mobility_;
         std::unique_ptr<TFormula> hole_mobility_;
+        std::unique_ptr<MobilityTable> electron_table_;
+        std::unique_ptr<MobilityTable> hole_table_;
+
+        static std::unique_ptr<MobilityTable> tabulate(const Tabulation& tabulation, const TFormula& formula) {
+            return std::make_unique<MobilityTable>(
+                [&](double efield, double doping) { return formula.Eval(efield, doping); },
+                tabulation,
+                formula.GetNdim() == 2,
+                formula.GetName());
+        }
 
         std::unique_ptr<TFormula> configure_mobility(const Configuration& config, const CarrierType type, bool doping) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
@@ -610,35 +735,54 @@ namespace allpix {
             try {
                 auto model = config.get<std::string>("mobility_model");
                 auto temperature = config.get<double>("temperature");
-                if(model == "jacoboni") {
-                    model_ = std::make_unique<JacoboniCanali>(material, temperature);
-                } else if(model == "canali") {
-                    model_ = std::make_unique<Canali>(material, temperature);
-                } else if(model == "canali_fast") {
-                    model_ = std::make_unique<CanaliFast>(material, temperature);
-                } else if(model == "hamburg") {
-                    model_ = std::make_unique<Hamburg>(material, temperature);
-                } else if(model == "hamburg_highfield") {
-                    model_ = std::make_unique<HamburgHighField>(material, temperature);
-                } else if(model == "masetti") {
-                    model_ = std::make_unique<Masetti>(
-                        material, temperature, doping, config.get<Dopant>("dopant_n", Dopant::PHOSPHORUS));
-                } else if(model == "masetti_canali") {
-                    model_ = std::make_unique<MasettiCanali>(
-                        material, temperature, doping, config.get<Dopant>("dopant_n", Dopant::PHOSPHORUS));
-                } else if(model == "arora") {
-                    model_ = std::make_unique<Arora>(material, temperature, doping);
-                } else if(model == "ruch_kino") {
-                    model_ = std::make_unique<RuchKino>(material);
-                } else if(model == "quay") {
-                    model_ = std::make_unique<Quay>(material, temperature);
-                } else if(model == "levinshtein") {
-                    model_ = std::make_unique<Levinshtein>(material, temperature, doping);
-                } else if(model == "constant") {
-                    model_ = std::make_unique<ConstantMobility>(config.get<double>("mobility_electron"),
-                                                                config.get<double>("mobility_hole"));
-                } else if(model == "custom") {
-                    model_ = std::make_unique<Custom>(config, doping);
+
+                // Models with the suffix "_fast" are replaced by lookup tables, except for the dedicated CanaliFast model
+                std::optional<Tabulation> tabulation;
+                auto name = model;
+                const std::string suffix = "_fast";
+                if(model != "canali_fast" && model.size() > suffix.size() &&
+                   model.compare(model.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                    tabulation.emplace(config);
+                    name = model.substr(0, model.size() - suffix.size());
+                }
+
+                if(name == "jacoboni") {
+                    create<JacoboniCanali>(tabulation, doping, material, temperature);
+                } else if(name == "canali") {
+                    create<Canali>(tabulation, doping, material, temperature);
+                } else if(name == "canali_fast") {
+                    create<CanaliFast>(tabulation, doping, material, temperature);
+                } else if(name == "hamburg") {
+                    create<Hamburg>(tabulation, doping, material, temperature);
+                } else if(name == "hamburg_highfield") {
+                    create<HamburgHighField>(tabulation, doping, material, temperature);
+                } else if(name == "masetti") {
+                    create<Masetti>(tabulation,
+                                    doping,
+                                    material,
+                                    temperature,
+                                    doping,
+                                    config.get<Dopant>("dopant_n", Dopant::PHOSPHORUS));
+                } else if(name == "masetti_canali") {
+                    create<MasettiCanali>(tabulation,
+                                          doping,
+                                          material,
+                                          temperature,
+                                          doping,
+                                          config.get<Dopant>("dopant_n", Dopant::PHOSPHORUS));
+                } else if(name == "arora") {
+                    create<Arora>(tabulation, doping, material, temperature, doping);
+                } else if(name == "ruch_kino") {
+                    create<RuchKino>(tabulation, doping, material);
+                } else if(name == "quay") {
+                    create<Quay>(tabulation, doping, material, temperature);
+                } else if(name == "levinshtein") {
+                    create<Levinshtein>(tabulation, doping, material, temperature, doping);
+                } else if(name == "constant") {
+                    create<ConstantMobility>(
+                        tabulation, doping, config.get<double>("mobility_electron"), config.get<double>("mobility_hole"));
+                } else if(name == "custom") {
+                    create<Custom>(tabulation, doping, config, doping);
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -653,11 +797,48 @@ namespace allpix {
          * @return Mobility value
          */
         template <class... ARGS> double operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+            return model_(std::forward<ARGS>(args)...);
+        }
+
+        /**
+         * Check whether the selected mobility model takes the doping concentration into account
+         * @return True if the mobility depends on the doping concentration, false otherwise
+         */
+        bool dependsOnDoping() const {
+            return model_.visit([](const auto& model) { return model.dependsOnDoping(); });
         }
 
     private:
-        std::unique_ptr<MobilityModel> model_{};
+        /**
+         * Create the model, or a lookup table of the model if tabulation settings are provided
+         * @param tabulation Optional tabulation settings
+         * @param doping     Boolean to indicate presence of doping profile information
+         * @param args       Arguments forwarded to the model constructor
+         */
+        template <class Model, class... ARGS>
+        void create(const std::optional<Tabulation>& tabulation, bool doping, ARGS&&... args) {
+            if(tabulation.has_value()) {
+                model_.emplace<TabulatedMobility>(Model(std::forward<ARGS>(args)...), tabulation.value(), doping);
+            } else {
+                model_.emplace<Model>(std::forward<ARGS>(args)...);
+            }
+        }
+
+        ModelVariant<JacoboniCanali,
+                     Canali,
+                     CanaliFast,
+                     Hamburg,
+                     HamburgHighField,
+                     Masetti,
+                     MasettiCanali,
+                     Arora,
+                     RuchKino,
+                     Quay,
+                     Levinshtein,
+                     ConstantMobility,
+                     Custom,
+                     TabulatedMobility>
+            model_;
     };
 
 } // namespace allpix
@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Definition of statically dispatched storage for physics models
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_MODEL_VARIANT_H
+#define ALLPIX_MODEL_VARIANT_H
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "exceptions.h"
+
+namespace allpix {
+
+    /**
+     * @ingroup Models
+     * @brief Storage for one model out of a closed set of model types
+     *
+     * The model wrapper classes select their model at run time from the configuration, but the set of available models is
+     * known at compile time. Storing the model in a std::variant instead of a pointer to the polymorphic base class allows
+     * to dispatch once via a jump table and to call the model functions non-virtually, such that the compiler can inline
+     * them into the propagation loop.
+     */
+    template <typename... Models> class ModelVariant {
+    public:
+        /**
+         * @brief Construct a model of the given type in place, replacing the currently stored model
+         * @param args Arguments forwarded to the model constructor
+         */
+        template <class Model, class... ARGS> void emplace(ARGS&&... args) {
+            model_.template emplace<Model>(std::forward<ARGS>(args)...);
+        }
+
+        /**
+         * @brief Call a function with the stored model as argument
+         * @param function Function to be called, needs to accept all model types and return the same type for all of them
+         * @return Return value of the function
+         * @throws UninitializedModelError If no model has been stored
+         */
+        template <class F> auto visit(F&& function) const {
+            using R = std::invoke_result_t<F, const std::tuple_element_t<0, std::tuple<Models...>>&>;
+            return std::visit(
+                [&](const auto& model) -> R {
+                    if constexpr(std::is_same_v<std::decay_t<decltype(model)>, std::monostate>) {
+                        throw UninitializedModelError();
+                    } else {
+                        return function(model);
+                    }
+                },
+                model_);
+        }
+
+        /**
+         * @brief Call the function call operator of the stored model, bypassing the virtual function table
+         * @param args Arguments forwarded to the function call operator
+         * @return Return value of the model
+         */
+        template <class... ARGS> auto operator()(ARGS&&... args) const {
+            return visit([&](const auto& model) {
+                using Model = std::decay_t<decltype(model)>;
+                return model.Model::operator()(std::forward<ARGS>(args)...);
+            });
+        }
+
+        /**
+         * @brief Helper method to determine if the stored model is of a given type or derived from it
+         * @return Boolean indication whether this model is of the given type or not
+         */
+        template <class T> bool is() const {
+            return std::visit([](const auto& model) { return std::is_base_of_v<T, std::decay_t<decltype(model)>>; },
+                              model_);
+        }
+
+    private:
+        std::variant<std::monostate, Models...> model_;
+    };
+
+} // namespace allpix
+
+#endif /* ALLPIX_MODEL_VARIANT_H */
@@ -20,6 +20,9 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "physics/CarrierLifetime.hpp"
+#include "physics/ModelVariant.hpp"
+#include "physics/Tabulation.hpp"
 
 namespace allpix {
 
@@ -49,6 +52,14 @@ namespace allpix {
          * @return Recombination status, true if charge carrier has recombined, false if it still is alive
          */
         virtual bool operator()(const CarrierType& type, double doping, double survival_prob, double timestep) const = 0;
+
+        /**
+         * Recombination rate, i.e. the inverse lifetime, for the given carrier and doping concentration
+         * @param type Type of charge carrier (electron or hole)
+         * @param doping (Effective) doping concentration
+         * @return Recombination rate, zero if the charge carrier does not recombine
+         */
+        virtual double rate(const CarrierType& type, double doping) const = 0;
     };
 
     /**
@@ -59,6 +70,8 @@ namespace allpix {
     class None : virtual public RecombinationModel {
     public:
         bool operator()(const CarrierType&, double, double, double) const override { return false; };
+
+        double rate(const CarrierType&, double) const override { return 0; };
     };
 
     /**
@@ -86,6 +99,8 @@ namespace allpix {
             return survival_prob < (1 - std::exp(-1. * timestep / lifetime(type, doping)));
         };
 
+        double rate(const CarrierType& type, double doping) const override { return 1. / lifetime(type, doping); };
+
     protected:
         double lifetime(const CarrierType& type, double doping) const {
             return (type == CarrierType::ELECTRON ? electron_lifetime_reference_ : hole_lifetime_reference_) /
@@ -124,6 +139,11 @@ namespace allpix {
                                          : (survival_prob < (1 - std::exp(-1. * timestep / lifetime(type, doping)))));
         };
 
+        double rate(const CarrierType& type, double doping) const override {
+            auto minorityType = (doping > 0 ? CarrierType::HOLE : CarrierType::ELECTRON);
+            return (minorityType != type ? 0. : 1. / lifetime(type, doping));
+        };
+
     protected:
         double lifetime(const CarrierType&, double doping) const { return 1. / (auger_coefficient_ * doping * doping); }
 
@@ -152,6 +172,11 @@ namespace allpix {
                 return survival_prob < (1 - std::exp(-1. * timestep / combined_lifetime));
             }
         };
+
+        double rate(const CarrierType& type, double doping) const override {
+            // Rates of both processes add up, Auger only contributes for minority charge carriers
+            return ShockleyReadHall::rate(type, doping) + Auger::rate(type, doping);
+        };
     };
 
     /**
@@ -168,6 +193,10 @@ namespace allpix {
                    (1 - std::exp(-1. * timestep / (type == CarrierType::ELECTRON ? electron_lifetime_ : hole_lifetime_)));
         };
 
+        double rate(const CarrierType& type, double) const override {
+            return 1. / (type == CarrierType::ELECTRON ? electron_lifetime_ : hole_lifetime_);
+        };
+
     private:
         double electron_lifetime_;
         double hole_lifetime_;
@@ -182,17 +211,41 @@ namespace allpix {
         CustomRecombination(const Configuration& config, bool doping) {
             electron_lifetime_ = configure_lifetime(config, CarrierType::ELECTRON, doping);
             hole_lifetime_ = configure_lifetime(config, CarrierType::HOLE, doping);
+
+            Tabulation tabulation(config);
+            if(tabulation.enabled() && doping) {
+                electron_table_ = tabulate(tabulation, *electron_lifetime_);
+                hole_table_ = tabulate(tabulation, *hole_lifetime_);
+            }
         };
 
         bool operator()(const CarrierType& type, double doping, double survival_prob, double timestep) const override {
-            return survival_prob < (1 - std::exp(-1. * timestep /
-                                                 (type == CarrierType::ELECTRON ? electron_lifetime_->Eval(doping)
-                                                                                : hole_lifetime_->Eval(doping))));
+            return survival_prob < (1 - std::exp(-1. * timestep / lifetime(type, doping)));
         };
 
+        double rate(const CarrierType& type, double doping) const override { return 1. / lifetime(type, doping); };
+
     private:
         std::unique_ptr<TFormula> electron_lifetime_;
         std::unique_ptr<TFormula> hole_lifetime_;
+        std::unique_ptr<TabulatedFunction> electron_table_;
+        std::unique_ptr<TabulatedFunction> hole_table_;
+
+        double lifetime(const CarrierType& type, double doping) const {
+            if(type == CarrierType::ELECTRON) {
+                return (electron_table_ ? (*electron_table_)(doping) : electron_lifetime_->Eval(doping));
+            } else {
+                return (hole_table_ ? (*hole_table_)(doping) : hole_lifetime_->Eval(doping));
+            }
+        }
+
+        static std::unique_ptr<TabulatedFunction> tabulate(const Tabulation& tabulation, const TFormula& formula) {
+            auto table = std::make_unique<TabulatedFunction>([&](double doping) { return formula.Eval(doping); },
+                                                             tabulation.doping(),
+                                                             TabulatedFunction::Precision{tabulation.precision()});
+            tabulation.report(formula.GetName(), std::to_string(table->bins()) + " bins", table->error());
+            return table;
+        }
 
         std::unique_ptr<TFormula> configure_lifetime(const Configuration& config, const CarrierType type, bool doping) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
@@ -251,19 +304,19 @@ namespace allpix {
                 auto model = config.get<std::string>("recombination_model");
                 auto temperature = config.get<double>("temperature");
                 if(model == "srh") {
-                    model_ = std::make_unique<ShockleyReadHall>(temperature, doping);
+                    model_.emplace<ShockleyReadHall>(temperature, doping);
                 } else if(model == "auger") {
-                    model_ = std::make_unique<Auger>(doping);
+                    model_.emplace<Auger>(doping);
                 } else if(model == "combined" || model == "srh_auger") {
-                    model_ = std::make_unique<ShockleyReadHallAuger>(temperature, doping);
+                    model_.emplace<ShockleyReadHallAuger>(temperature, doping);
                 } else if(model == "constant") {
-                    model_ = std::make_unique<ConstantLifetime>(config.get<double>("lifetime_electron"),
-                                                                config.get<double>("lifetime_hole"));
+                    model_.emplace<ConstantLifetime>(config.get<double>("lifetime_electron"),
+                                                     config.get<double>("lifetime_hole"));
                 } else if(model == "none") {
                     LOG(INFO) << "No charge carrier recombination model chosen, finite lifetime not simulated";
-                    model_ = std::make_unique<None>();
+                    model_.emplace<None>();
                 } else if(model == "custom") {
-                    model_ = std::make_unique<CustomRecombination>(config, doping);
+                    model_.emplace<CustomRecombination>(config, doping);
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -278,11 +331,37 @@ namespace allpix {
          * @return Recombination value
          */
         template <class... ARGS> bool operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+            return model_(std::forward<ARGS>(args)...);
+        }
+
+        /**
+         * Recombination rate forwarded to the recombination model
+         * @return Recombination rate
+         */
+        template <class... ARGS> double rate(ARGS&&... args) const {
+            return model_.visit([&](const auto& model) {
+                using Model = std::decay_t<decltype(model)>;
+                return model.Model::rate(std::forward<ARGS>(args)...);
+            });
+        }
+
+        /**
+         * Recombination status of a charge carrier after a step, evaluated from its remaining lifetime
+         * @param type Type of charge carrier (electron or hole)
+         * @param doping (Effective) doping concentration at the current position
+         * @param lifetime Remaining lifetime of the charge carrier, either sampled once or evaluated at every step
+         * @param timestep Length of the step
+         * @return Recombination status, true if charge carrier has recombined, false if it still is alive
+         */
+        bool recombined(const CarrierType& type, double doping, CarrierLifetime& lifetime, double timestep) const {
+            if(lifetime.sampled()) {
+                return lifetime.elapse(rate(type, doping), timestep);
+            }
+            return model_(type, doping, lifetime.draw(), timestep);
         }
 
     private:
-        std::unique_ptr<RecombinationModel> model_{};
+        ModelVariant<None, ShockleyReadHall, Auger, ShockleyReadHallAuger, ConstantLifetime, CustomRecombination> model_;
     };
 
 } // namespace allpix
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief Definition of the tabulation settings for custom physics models
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_MODEL_TABULATION_H
+#define ALLPIX_MODEL_TABULATION_H
+
+#include <string>
+
+#include "core/config/Configuration.hpp"
+#include "core/utils/log.h"
+#include "core/utils/unit.h"
+#include "tools/tabulated_function.h"
+
+namespace allpix {
+
+    /**
+     * @ingroup Models
+     * @brief Settings for replacing model functions by lookup tables
+     *
+     * Custom models are defined via ROOT::TFormula expressions, which are comparatively slow to evaluate. If requested,
+     * these expressions are evaluated once for the relevant range of electric field strengths and doping concentrations,
+     * and replaced by lookup tables with a maximum relative interpolation error.
+     */
+    class Tabulation {
+    public:
+        /**
+         * Tabulation settings constructor
+         * @param config Configuration of the calling module
+         */
+        explicit Tabulation(const Configuration& config)
+            : enabled_(config.get<bool>("tabulate_custom_models", false)),
+              precision_(config.get<double>("tabulation_precision", 1e-4)),
+              max_field_(config.get<double>("tabulation_max_field", Units::get(1000., "kV/cm"))),
+              max_doping_(config.get<double>("tabulation_max_doping", Units::get(1e21, "/cm/cm/cm"))) {}
+
+        /**
+         * @brief Check if tabulation of model functions is requested
+         * @return True if functions should be tabulated, false otherwise
+         */
+        bool enabled() const { return enabled_; }
+
+        /**
+         * @brief Requested maximum relative interpolation error
+         * @return Precision of the lookup tables
+         */
+        double precision() const { return precision_; }
+
+        /**
+         * @brief Axis for the electric field magnitude, ranging from zero to the maximum field configured
+         * @return Tabulation axis
+         */
+        TabulationAxis field() const { return {0., max_field_}; }
+
+        /**
+         * @brief Axis for the signed doping concentration, logarithmic above 1e10/cm^3 in either direction
+         * @return Tabulation axis
+         */
+        TabulationAxis doping() const {
+            return {-max_doping_, max_doping_, TabulationAxis::Scale::ASINH, Units::get(1e10, "/cm/cm/cm")};
+        }
+
+        /**
+         * @brief Report the result of tabulating a function, warning if the requested precision has not been reached
+         * @param name Name of the tabulated function
+         * @param size Description of the table size, e.g. number of bins or entries
+         * @param error Maximum relative interpolation error of the table
+         */
+        void report(const std::string& name, const std::string& size, double error) const {
+            LOG(DEBUG) << "Tabulated " << name << " with " << size << ", maximum relative error " << error;
+            if(error > precision_) {
+                LOG(WARNING) << "Lookup table for " << name << " reached its maximum size of " << size
+                             << " with a maximum relative error of " << error << " above the requested precision of "
+                             << precision_;
+            }
+        }
+
+    private:
+        bool enabled_;
+        double precision_;
+        double max_field_;
+        double max_doping_;
+    };
+
+} // namespace allpix
+
+#endif
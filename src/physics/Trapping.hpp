@@ -20,6 +20,9 @@
 #include "core/utils/log.h"
 #include "core/utils/unit.h"
 #include "objects/SensorCharge.hpp"
+#include "physics/CarrierLifetime.hpp"
+#include "physics/ModelVariant.hpp"
+#include "physics/Tabulation.hpp"
 
 namespace allpix {
 
@@ -52,6 +55,16 @@ namespace allpix {
                    (1 - std::exp(-1. * timestep / (type == CarrierType::ELECTRON ? tau_eff_electron_ : tau_eff_hole_)));
         };
 
+        /**
+         * Trapping rate, i.e. the inverse effective trapping time, for the given carrier
+         * @param type Type of charge carrier (electron or hole)
+         * additional possible parameter: efield_mag Magnitude of the electric field
+         * @return Trapping rate, zero if the charge carrier is not trapped
+         */
+        virtual double rate(const CarrierType& type, double) const {
+            return 1. / (type == CarrierType::ELECTRON ? tau_eff_electron_ : tau_eff_hole_);
+        };
+
     protected:
         double tau_eff_electron_{std::numeric_limits<double>::max()};
         double tau_eff_hole_{std::numeric_limits<double>::max()};
@@ -64,6 +77,8 @@ namespace allpix {
     class NoTrapping : virtual public TrappingModel {
     public:
         bool operator()(const CarrierType&, double, double, double) const override { return false; };
+
+        double rate(const CarrierType&, double) const override { return 0; };
     };
 
     /**
@@ -150,17 +165,42 @@ namespace allpix {
         explicit CustomTrapping(const Configuration& config) {
             tf_tau_eff_electron_ = configure_tau_eff(config, CarrierType::ELECTRON);
             tf_tau_eff_hole_ = configure_tau_eff(config, CarrierType::HOLE);
+
+            Tabulation tabulation(config);
+            if(tabulation.enabled()) {
+                tau_eff_electron_table_ = tabulate(tabulation, *tf_tau_eff_electron_);
+                tau_eff_hole_table_ = tabulate(tabulation, *tf_tau_eff_hole_);
+            }
         };
 
         bool operator()(const CarrierType& type, double probability, double timestep, double efield_mag) const override {
-            return probability < (1 - std::exp(-1. * timestep /
-                                               (type == CarrierType::ELECTRON ? tf_tau_eff_electron_->Eval(efield_mag)
-                                                                              : tf_tau_eff_hole_->Eval(efield_mag))));
+            return probability < (1 - std::exp(-1. * timestep / tau_eff(type, efield_mag)));
         };
 
+        double rate(const CarrierType& type, double efield_mag) const override { return 1. / tau_eff(type, efield_mag); };
+
     private:
         std::unique_ptr<TFormula> tf_tau_eff_electron_;
         std::unique_ptr<TFormula> tf_tau_eff_hole_;
+        std::unique_ptr<TabulatedFunction> tau_eff_electron_table_;
+        std::unique_ptr<TabulatedFunction> tau_eff_hole_table_;
+
+        double tau_eff(const CarrierType& type, double efield_mag) const {
+            if(type == CarrierType::ELECTRON) {
+                return (tau_eff_electron_table_ ? (*tau_eff_electron_table_)(efield_mag)
+                                                : tf_tau_eff_electron_->Eval(efield_mag));
+            } else {
+                return (tau_eff_hole_table_ ? (*tau_eff_hole_table_)(efield_mag) : tf_tau_eff_hole_->Eval(efield_mag));
+            }
+        }
+
+        static std::unique_ptr<TabulatedFunction> tabulate(const Tabulation& tabulation, const TFormula& formula) {
+            auto table = std::make_unique<TabulatedFunction>([&](double efield) { return formula.Eval(efield); },
+                                                             tabulation.field(),
+                                                             TabulatedFunction::Precision{tabulation.precision()});
+            tabulation.report(formula.GetName(), std::to_string(table->bins()) + " bins", table->error());
+            return table;
+        }
 
         std::unique_ptr<TFormula> configure_tau_eff(const Configuration& config, const CarrierType type) {
             std::string name = (type == CarrierType::ELECTRON ? "electrons" : "holes");
@@ -222,21 +262,21 @@ namespace allpix {
                 }
 
                 if(model == "ljubljana" || model == "kramberger") {
-                    model_ = std::make_unique<Ljubljana>(temperature, fluence);
+                    model_.emplace<Ljubljana>(temperature, fluence);
                 } else if(model == "dortmund" || model == "krasel") {
-                    model_ = std::make_unique<Dortmund>(fluence);
+                    model_.emplace<Dortmund>(fluence);
                 } else if(model == "cmstracker") {
-                    model_ = std::make_unique<CMSTracker>(fluence);
+                    model_.emplace<CMSTracker>(fluence);
                 } else if(model == "mandic") {
-                    model_ = std::make_unique<Mandic>(fluence);
+                    model_.emplace<Mandic>(fluence);
                 } else if(model == "constant") {
-                    model_ = std::make_unique<ConstantTrapping>(config.get<double>("trapping_time_electron"),
-                                                                config.get<double>("trapping_time_hole"));
+                    model_.emplace<ConstantTrapping>(config.get<double>("trapping_time_electron"),
+                                                     config.get<double>("trapping_time_hole"));
                 } else if(model == "none") {
                     LOG(INFO) << "No charge carrier trapping model chosen, no trapping simulated";
-                    model_ = std::make_unique<NoTrapping>();
+                    model_.emplace<NoTrapping>();
                 } else if(model == "custom") {
-                    model_ = std::make_unique<CustomTrapping>(config);
+                    model_.emplace<CustomTrapping>(config);
                 } else {
                     throw InvalidModelError(model);
                 }
@@ -251,11 +291,37 @@ namespace allpix {
          * @return Trapping state
          */
         template <class... ARGS> bool operator()(ARGS&&... args) const {
-            return model_->operator()(std::forward<ARGS>(args)...);
+            return model_(std::forward<ARGS>(args)...);
+        }
+
+        /**
+         * Trapping rate forwarded to the trapping model
+         * @return Trapping rate
+         */
+        template <class... ARGS> double rate(ARGS&&... args) const {
+            return model_.visit([&](const auto& model) {
+                using Model = std::decay_t<decltype(model)>;
+                return model.Model::rate(std::forward<ARGS>(args)...);
+            });
+        }
+
+        /**
+         * Trapping status of a charge carrier after a step, evaluated from its remaining lifetime
+         * @param type Type of charge carrier (electron or hole)
+         * @param efield_mag Magnitude of the electric field at the current position
+         * @param lifetime Remaining lifetime of the charge carrier, either sampled once or evaluated at every step
+         * @param timestep Length of the step
+         * @return Trapping state, true if charge carrier has been trapped
+         */
+        bool trapped(const CarrierType& type, double efield_mag, CarrierLifetime& lifetime, double timestep) const {
+            if(lifetime.sampled()) {
+                return lifetime.elapse(rate(type, efield_mag), timestep);
+            }
+            return model_(type, lifetime.draw(), timestep, efield_mag);
         }
 
     private:
-        std::unique_ptr<TrappingModel> model_{};
+        ModelVariant<NoTrapping, Ljubljana, Dortmund, CMSTracker, Mandic, ConstantTrapping, CustomTrapping> model_;
     };
 
 } // namespace allpix
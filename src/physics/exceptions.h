@@ -52,6 +52,18 @@ namespace allpix {
             error_message_ = "Model not suitable for this simulation: " + reason;
         }
     };
+
+    /**
+     * @ingroup Exceptions
+     * @brief Notifies of a model being used before it has been selected
+     */
+    class UninitializedModelError : public ModelError {
+    public:
+        /**
+         * @brief Construct an error for a model wrapper without model
+         */
+        UninitializedModelError() { error_message_ = "Model has not been initialized"; }
+    };
 } // namespace allpix
 
 #endif /* ALLPIX_MODEL_EXCEPTIONS_H */
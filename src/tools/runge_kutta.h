@@ -12,6 +12,8 @@
 #ifndef ALLPIX_RUNGE_KUTTA_H
 #define ALLPIX_RUNGE_KUTTA_H
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 
 #include <Eigen/Core>
@@ -203,9 +205,255 @@ namespace allpix {
             -8.0/27, 2, -3544.0/2565, 1859.0/4104, -11.0/40, 0,
             16.0/135, 0, 6656.0/12825, 28561.0/56430, -9.0/50, 2.0/55,
             25.0/216, 0, 1408.0/2565, 2197.0/4104, -1.0/5, 0).finished());
+
+        /**
+         * @brief Runge-Kutta-Fehlberg method with coefficients known at compile time, equivalent to \ref RK5
+         */
+        struct Fehlberg45 {
+            static constexpr int stages = 6;
+            static constexpr int error_order = 4;
+            static constexpr bool fsal = false;
+            static constexpr bool dense = false;
+            static constexpr double c[stages] = {0, 1.0/4, 3.0/8, 12.0/13, 1, 1.0/2};
+            static constexpr double a[stages][stages] = {
+                {0, 0, 0, 0, 0, 0},
+                {1.0/4, 0, 0, 0, 0, 0},
+                {3.0/32, 9.0/32, 0, 0, 0, 0},
+                {1932.0/2197, -7200.0/2197, 7296.0/2197, 0, 0, 0},
+                {439.0/216, -8, 3680.0/513, -845.0/4104, 0, 0},
+                {-8.0/27, 2, -3544.0/2565, 1859.0/4104, -11.0/40, 0}};
+            static constexpr double b[stages] = {16.0/135, 0, 6656.0/12825, 28561.0/56430, -9.0/50, 2.0/55};
+            static constexpr double b_hat[stages] = {25.0/216, 0, 1408.0/2565, 2197.0/4104, -1.0/5, 0};
+        };
+
+        /**
+         * @brief Dormand-Prince 5(4) method
+         *
+         * The last stage is evaluated at the end point of the step and can be reused as first stage of the following step
+         * (first same as last), and a continuous extension of fourth order provides dense output within the step. The
+         * coefficients of the dense output are taken from Hairer, Norsett & Wanner, Solving Ordinary Differential
+         * Equations I, Section II.6.
+         */
+        struct DormandPrince54 {
+            static constexpr int stages = 7;
+            static constexpr int error_order = 4;
+            static constexpr bool fsal = true;
+            static constexpr bool dense = true;
+            static constexpr double c[stages] = {0, 1.0/5, 3.0/10, 4.0/5, 8.0/9, 1, 1};
+            static constexpr double a[stages][stages] = {
+                {0, 0, 0, 0, 0, 0, 0},
+                {1.0/5, 0, 0, 0, 0, 0, 0},
+                {3.0/40, 9.0/40, 0, 0, 0, 0, 0},
+                {44.0/45, -56.0/15, 32.0/9, 0, 0, 0, 0},
+                {19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729, 0, 0, 0},
+                {9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176, -5103.0/18656, 0, 0},
+                {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84, 0}};
+            static constexpr double b[stages] = {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84, 0};
+            static constexpr double b_hat[stages] = {
+                5179.0/57600, 0, 7571.0/16695, 393.0/640, -92097.0/339200, 187.0/2100, 1.0/40};
+            static constexpr double d[stages] = {-12715105075.0/11282082432, 0, 87487479700.0/32700410799,
+                -10690763975.0/1880347072, 701980252875.0/199316789632, -1453857185.0/822651844, 69997945.0/29380423};
+        };
     }
     // clang-format on
 
+    /**
+     * @brief Class to perform adaptive Runge-Kutta integration with a tableau known at compile time
+     *
+     * In contrast to \ref RungeKutta, the coefficients of the tableau and the step function are known at compile time,
+     * which allows the compiler to unroll the stages and to inline the step function. For tableaus with the first same as
+     * last property, the last stage of a step is reused as first stage of the next step unless the value has been replaced
+     * or the time has been advanced in between, while small displacements applied via \ref displace keep the last stage.
+     * Tableaus supporting dense output allow to interpolate the solution within the last step. The time step can be adapted
+     * with a proportional-integral controller based on the error estimate of the embedded method.
+     */
+    template <typename Tableau, typename F, int D = 3> class AdaptiveRungeKutta {
+    public:
+        using Vector = Eigen::Matrix<double, D, 1>;
+        using Step = typename RungeKutta<double, Tableau::stages, D>::Step;
+
+        /**
+         * @brief Construct an adaptive Runge-Kutta integrator
+         * @param function Step function to perform integration, callable with the time and the current value
+         * @param step_size Time step of the integration
+         * @param initial_y Start values of the vector to perform integration on
+         * @param initial_t Initial time at the start of the integration
+         */
+        AdaptiveRungeKutta(F function, double step_size, Vector initial_y, double initial_t = 0)
+            : function_(std::move(function)), h_(step_size), y_(std::move(initial_y)), t_(initial_t) {
+            error_.setZero();
+        }
+
+        /**
+         * @brief Changes the time step
+         * @param step_size New time step of the integration
+         */
+        void setTimeStep(double step_size) { h_ = step_size; }
+        /**
+         * @brief Return the time step
+         * @return Current time step of the integration
+         */
+        double getTimeStep() const { return h_; }
+        /**
+         * @brief Return the time step of the last integration step
+         * @return Time step of the last step, zero if no step has been performed yet
+         */
+        double getLastTimeStep() const { return h_last_; }
+
+        /**
+         * @brief Changes the current value during integration
+         * @note Can be used to add additional processes during the integration, invalidates the reuse of the last stage
+         */
+        void setValue(Vector y) {
+            y_ = std::move(y);
+            fsal_valid_ = false;
+        }
+        /**
+         * @brief Displace the current value by a small offset, keeping the last stage for reuse in the next step
+         * @param delta Offset to add to the current value
+         *
+         * In contrast to \ref setValue, the last stage of a tableau with the first same as last property remains valid. The
+         * first stage of the next step is then the derivative at the end point of the integrated step instead of the
+         * displaced point, which is an approximation of first order in the offset. This is appropriate for stochastic
+         * displacements such as diffusion, which are small compared to the length scale on which the derivative changes
+         * and whose own error is far larger than the one introduced by this approximation.
+         */
+        void displace(const Vector& delta) { y_ += delta; }
+        /**
+         * @brief Get the value to integrate
+         * @return Current value
+         */
+        Vector getValue() const { return y_; }
+        /**
+         * @brief Get the total integration error
+         * @return Total integrated error
+         */
+        Vector getError() const { return error_; }
+        /**
+         * @brief Get the time during integration
+         * @return Current time
+         */
+        double getTime() const { return t_; }
+        /**
+         * @brief Advance the time of the integration
+         * @param t Time step to advance the integration by
+         */
+        void advanceTime(double t) {
+            t_ += t;
+            fsal_valid_ = false;
+        }
+
+        /**
+         * @brief Execute a single time step of the integration
+         * @return Combination of the current value and the error in this single step
+         */
+        Step step() {
+            Vector ys = Vector::Zero();
+            Vector yse = Vector::Zero();
+
+            for(int i = 0; i < Tableau::stages; ++i) {
+                if(i == 0 && Tableau::fsal && fsal_valid_) {
+                    // First same as last: the first stage is the last stage of the previous step
+                    k_.col(0) = k_.col(Tableau::stages - 1);
+                } else {
+                    Vector yt = y_;
+                    for(int j = 0; j < i; ++j) {
+                        yt += h_ * Tableau::a[i][j] * k_.col(j);
+                    }
+                    k_.col(i) = function_(t_ + Tableau::c[i] * h_, yt);
+                }
+
+                ys += h_ * Tableau::b[i] * k_.col(i);
+                yse += h_ * Tableau::b_hat[i] * k_.col(i);
+            }
+
+            // Store start of the step for dense output
+            y_last_ = y_;
+            h_last_ = h_;
+
+            // Update values with new step
+            y_ += ys;
+            t_ += h_;
+            error_ += ys - yse;
+            fsal_valid_ = true;
+
+            Step step;
+            step.value = ys;
+            step.error = ys - yse;
+            return step;
+        }
+
+        /**
+         * @brief Interpolate the solution within the last step
+         * @param theta Fraction of the last step, ranging from zero (start) to one (end of the step)
+         * @return Interpolated value of the integrated vector
+         * @note The interpolation only takes the integration into account, not any changes applied via \ref setValue
+         */
+        Vector interpolate(double theta) const {
+            static_assert(Tableau::dense, "Tableau does not provide dense output");
+            Vector y_next = y_last_;
+            Vector dense = Vector::Zero();
+            for(int i = 0; i < Tableau::stages; ++i) {
+                y_next += h_last_ * Tableau::b[i] * k_.col(i);
+                dense += h_last_ * Tableau::d[i] * k_.col(i);
+            }
+
+            Vector diff = y_next - y_last_;
+            Vector bspl = h_last_ * k_.col(0) - diff;
+            Vector cont = diff - h_last_ * k_.col(Tableau::stages - 1) - bspl;
+            double theta1 = 1. - theta;
+            return y_last_ + theta * (diff + theta1 * (bspl + theta * (cont + theta1 * dense)));
+        }
+
+        /**
+         * @brief Adapt the time step with a proportional-integral controller
+         * @param error     Error estimate of the last step
+         * @param tolerance Target error per step
+         * @param min       Minimum time step
+         * @param max       Maximum time step
+         * @return New time step of the integration
+         *
+         * The controller takes into account the error of the last and the previous step to avoid oscillations of the step
+         * size, using the parameters suggested by Hairer & Wanner for methods with an error estimator of order q.
+         */
+        double adaptTimeStep(double error, double tolerance, double min, double max) {
+            constexpr double exponent = 1. / (Tableau::error_order + 1);
+            constexpr double beta = 0.4 * exponent;
+            constexpr double alpha = exponent - 0.75 * beta;
+
+            auto normalized = std::max(error / tolerance, 1e-10);
+            auto factor = 0.9 * std::pow(normalized, -alpha) * std::pow(error_previous_, beta);
+            factor = std::clamp(factor, 0.2, (normalized > 1. ? 1. : 5.));
+            error_previous_ = std::max(normalized, 1e-4);
+
+            h_ = std::clamp(h_ * factor, min, max);
+            return h_;
+        }
+
+    private:
+        F function_;
+        // Step size
+        double h_;
+
+        // Vector to integrate
+        Vector y_;
+        // Total error vector
+        Vector error_;
+        // Current time
+        double t_;
+
+        // Stages of the last step
+        Eigen::Matrix<double, D, Tableau::stages> k_;
+        bool fsal_valid_{false};
+
+        // Start value and step size of the last step for dense output
+        Vector y_last_;
+        double h_last_{};
+
+        // Normalized error of the previous step for the step size controller
+        double error_previous_{1e-4};
+    };
+
     /**
      * @brief Utility function to create RungeKutta class using template deduction
      * @param tableau One of the possible Runge-Kutta tableaus (see \ref allpix::tableau)
@@ -216,6 +464,17 @@ namespace allpix {
     RungeKutta<T, S, D> make_runge_kutta(const Eigen::Matrix<T, S + 2, S>& tableau, Args&&... args) {
         return RungeKutta<T, S, D>(tableau, std::forward<Args>(args)...);
     }
+
+    /**
+     * @brief Utility function to create AdaptiveRungeKutta class using template deduction for the step function
+     * @param function Step function to perform integration
+     * @param args Other forwarded arguments to the \ref AdaptiveRungeKutta::AdaptiveRungeKutta constructor
+     * @return Instantiation of \ref AdaptiveRungeKutta class with the forwarded arguments
+     */
+    template <typename Tableau, int D = 3, typename F, class... Args>
+    AdaptiveRungeKutta<Tableau, F, D> make_adaptive_runge_kutta(F function, Args&&... args) {
+        return AdaptiveRungeKutta<Tableau, F, D>(std::move(function), std::forward<Args>(args)...);
+    }
 } // namespace allpix
 
 #endif /* ALLPIX_RUNGE_KUTTA_H */
@@ -0,0 +1,345 @@
+/**
+ * @file
+ * @brief Utility to replace expensive functions of one or two variables by tabulated data with bounded interpolation error
+ *
+ * @copyright Copyright (c) 2023 CERN and the Allpix Squared authors.
+ * This software is distributed under the terms of the MIT License, copied verbatim in the file "LICENSE.md".
+ * In applying this license, CERN does not waive the privileges and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef ALLPIX_TABULATED_FUNCTION_H
+#define ALLPIX_TABULATED_FUNCTION_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace allpix {
+    /**
+     * @brief Axis of a lookup table, mapping function arguments onto an equidistant grid
+     *
+     * Besides a linear mapping, the axis supports an inverse hyperbolic sine mapping u = asinh(x / x_ref). This mapping is
+     * logarithmic for |x| >> x_ref while remaining linear around zero, and is therefore suited for quantities spanning many
+     * orders of magnitude with either sign, such as doping concentrations.
+     */
+    class TabulationAxis {
+    public:
+        /**
+         * @brief Scale of the axis
+         */
+        enum class Scale {
+            LINEAR, ///< Equidistant grid in x
+            ASINH,  ///< Equidistant grid in asinh(x / x_ref)
+        };
+
+        /**
+         * @brief Constructs a new axis
+         * @param min       Lower boundary of the tabulated range
+         * @param max       Upper boundary of the tabulated range
+         * @param scale     Scale of the axis
+         * @param reference Reference value x_ref for the inverse hyperbolic sine scale
+         */
+        TabulationAxis(double min, double max, Scale scale = Scale::LINEAR, double reference = 1.)
+            : scale_(scale), reference_(reference), u_min_(transform(min)), u_max_(transform(max)) {
+            assert(min < max);
+            assert(reference > 0);
+        }
+
+        /**
+         * @brief Map a function argument onto the axis coordinate
+         * @param x Function argument
+         * @return Axis coordinate
+         */
+        inline double transform(double x) const noexcept {
+            return (scale_ == Scale::ASINH ? std::asinh(x / reference_) : x);
+        }
+
+        /**
+         * @brief Map an axis coordinate back onto the function argument
+         * @param u Axis coordinate
+         * @return Function argument
+         */
+        inline double inverse(double u) const noexcept { return (scale_ == Scale::ASINH ? reference_ * std::sinh(u) : u); }
+
+        /**
+         * @brief Get the lower boundary of the axis coordinate
+         * @return Lower boundary
+         */
+        double min() const noexcept { return u_min_; }
+
+        /**
+         * @brief Get the upper boundary of the axis coordinate
+         * @return Upper boundary
+         */
+        double max() const noexcept { return u_max_; }
+
+    private:
+        Scale scale_;
+        double reference_;
+        double u_min_;
+        double u_max_;
+    };
+
+    /**
+     * @brief Tabulated version of an arbitrary function of one variable
+     *
+     * The function is evaluated at the nodes of an equidistant grid along the provided axis, values in between are obtained
+     * by linear interpolation. The grid is refined by successively doubling the number of bins until the maximum relative
+     * interpolation error, probed at the bin centers, is below the requested precision or the maximum number of bins is
+     * reached. Values outside the tabulated range are extrapolated linearly from the first and last bin, respectively.
+     */
+    class TabulatedFunction {
+    public:
+        /**
+         * @brief Tag selecting a grid refined until the requested precision is reached
+         */
+        struct Precision {
+            double value;               ///< Requested maximum relative interpolation error
+            size_t max_bins = 1u << 16; ///< Maximum number of bins the grid is refined to
+        };
+
+        /**
+         * @brief Tag selecting a grid with a fixed number of bins
+         */
+        struct Bins {
+            size_t value; ///< Number of bins of the grid
+        };
+
+        /**
+         * @brief Constructs a new tabulated function, refining the grid until the requested precision is reached
+         * @param function  Function to tabulate, callable with a single double argument
+         * @param axis      Axis defining the tabulated range
+         * @param precision Requested maximum relative interpolation error and maximum number of bins
+         */
+        template <typename F>
+        TabulatedFunction(const F& function, TabulationAxis axis, Precision precision) : axis_(axis) {
+            for(size_t bins = 16;; bins *= 2) {
+                tabulate(function, bins);
+                if(error_ <= precision.value || 2 * bins > precision.max_bins) {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * @brief Constructs a new tabulated function with a fixed number of bins
+         * @param function  Function to tabulate, callable with a single double argument
+         * @param axis      Axis defining the tabulated range
+         * @param bins      Number of bins of the grid
+         */
+        template <typename F> TabulatedFunction(const F& function, TabulationAxis axis, Bins bins) : axis_(axis) {
+            assert(bins.value >= 2);
+            tabulate(function, bins.value);
+        }
+
+        /**
+         * @brief Get the interpolated function value
+         * @param x Function argument
+         * @return Interpolated value of the function
+         */
+        inline double operator()(double x) const noexcept {
+            // Calculate position on the pre-calculated table
+            double pos = (axis_.transform(x) - axis_.min()) * inv_du_;
+
+            // Map NaN arguments to the first node, converting them to an index is undefined behavior
+            if(std::isnan(pos)) {
+                pos = 0.;
+            }
+
+            // Calculate left index, clamping to the pre-calculated range to extrapolate from the outermost bins
+            auto idx = static_cast<size_t>(std::clamp(pos, 0., static_cast<double>(table_.size() - 2)));
+
+            // Linear interpolation between left and right node
+            double tmp = pos - static_cast<double>(idx);
+            return table_[idx] * (1 - tmp) + tmp * table_[idx + 1];
+        }
+
+        /**
+         * @brief Get the number of bins of the table
+         * @return Number of bins
+         */
+        size_t bins() const noexcept { return table_.size() - 1; }
+
+        /**
+         * @brief Get the maximum relative interpolation error found when building the table
+         * @return Maximum relative error
+         */
+        double error() const noexcept { return error_; }
+
+    private:
+        template <typename F> void tabulate(const F& function, size_t bins) {
+            double du = (axis_.max() - axis_.min()) / static_cast<double>(bins);
+            inv_du_ = 1. / du;
+
+            table_.resize(bins + 1);
+            double max_abs = 0;
+            for(size_t idx = 0; idx <= bins; ++idx) {
+                table_[idx] = function(axis_.inverse(axis_.min() + du * static_cast<double>(idx)));
+                max_abs = std::max(max_abs, std::fabs(table_[idx]));
+            }
+
+            // Probe the interpolation error at the bin centers, relative errors are limited for values close to zero
+            double floor = std::max(1e-9 * max_abs, std::numeric_limits<double>::min());
+            error_ = 0;
+            for(size_t idx = 0; idx < bins; ++idx) {
+                double exact = function(axis_.inverse(axis_.min() + du * (static_cast<double>(idx) + 0.5)));
+                double interpolated = 0.5 * (table_[idx] + table_[idx + 1]);
+                error_ = std::max(error_, std::fabs(interpolated - exact) / std::max(std::fabs(exact), floor));
+            }
+        }
+
+        TabulationAxis axis_;
+        std::vector<double> table_;
+        double inv_du_{};
+        double error_{};
+    };
+
+    /**
+     * @brief Tabulated version of an arbitrary function of two variables
+     *
+     * Equivalent of TabulatedFunction for functions of two variables using bilinear interpolation. Both axes are refined
+     * independently: the number of bins along an axis is doubled as long as the relative interpolation error probed at the
+     * bin centers along this axis exceeds the requested precision, and the total number of table entries stays below the
+     * maximum.
+     */
+    class TabulatedFunction2D {
+    public:
+        /**
+         * @brief Constructs a new tabulated function
+         * @param function  Function to tabulate, callable with two double arguments
+         * @param axis_x    Axis defining the tabulated range of the first argument
+         * @param axis_y    Axis defining the tabulated range of the second argument
+         * @param precision Requested maximum relative interpolation error
+         * @param max_size  Maximum number of table entries the grid is refined to
+         */
+        template <typename F>
+        TabulatedFunction2D(
+            const F& function, TabulationAxis axis_x, TabulationAxis axis_y, double precision, size_t max_size = 1u << 20)
+            : axis_x_(axis_x), axis_y_(axis_y) {
+            size_t bins_x = 16;
+            size_t bins_y = 16;
+            while(true) {
+                auto [error_x, error_y] = tabulate(function, bins_x, bins_y);
+                error_ = std::max(error_x, error_y);
+                if(error_ <= precision) {
+                    break;
+                }
+
+                // Refine the axes which do not yet reach the requested precision
+                auto refine_x = (error_x > precision);
+                auto refine_y = (error_y > precision);
+                auto new_size = (bins_x * (refine_x ? 2 : 1) + 1) * (bins_y * (refine_y ? 2 : 1) + 1);
+                if(new_size > max_size) {
+                    break;
+                }
+                bins_x *= (refine_x ? 2 : 1);
+                bins_y *= (refine_y ? 2 : 1);
+            }
+        }
+
+        /**
+         * @brief Get the interpolated function value
+         * @param x First function argument
+         * @param y Second function argument
+         * @return Interpolated value of the function
+         */
+        inline double operator()(double x, double y) const noexcept {
+            double pos_x = (axis_x_.transform(x) - axis_x_.min()) * inv_du_x_;
+            double pos_y = (axis_y_.transform(y) - axis_y_.min()) * inv_du_y_;
+
+            // Map NaN arguments to the first node, converting them to an index is undefined behavior
+            if(std::isnan(pos_x)) {
+                pos_x = 0.;
+            }
+            if(std::isnan(pos_y)) {
+                pos_y = 0.;
+            }
+
+            auto idx_x = static_cast<size_t>(std::clamp(pos_x, 0., static_cast<double>(nodes_x_ - 2)));
+            auto idx_y = static_cast<size_t>(std::clamp(pos_y, 0., static_cast<double>(nodes_y_ - 2)));
+
+            double tx = pos_x - static_cast<double>(idx_x);
+            double ty = pos_y - static_cast<double>(idx_y);
+
+            const double* row0 = &table_[idx_x * nodes_y_ + idx_y];
+            const double* row1 = row0 + nodes_y_;
+            return (row0[0] * (1 - ty) + row0[1] * ty) * (1 - tx) + (row1[0] * (1 - ty) + row1[1] * ty) * tx;
+        }
+
+        /**
+         * @brief Get the number of table entries
+         * @return Number of entries
+         */
+        size_t size() const noexcept { return table_.size(); }
+
+        /**
+         * @brief Get the maximum relative interpolation error found when building the table
+         * @return Maximum relative error
+         */
+        double error() const noexcept { return error_; }
+
+    private:
+        template <typename F> std::pair<double, double> tabulate(const F& function, size_t bins_x, size_t bins_y) {
+            double du_x = (axis_x_.max() - axis_x_.min()) / static_cast<double>(bins_x);
+            double du_y = (axis_y_.max() - axis_y_.min()) / static_cast<double>(bins_y);
+            inv_du_x_ = 1. / du_x;
+            inv_du_y_ = 1. / du_y;
+            nodes_x_ = bins_x + 1;
+            nodes_y_ = bins_y + 1;
+
+            auto coordinate_x = [&](double idx) { return axis_x_.inverse(axis_x_.min() + du_x * idx); };
+            auto coordinate_y = [&](double idx) { return axis_y_.inverse(axis_y_.min() + du_y * idx); };
+
+            table_.resize(nodes_x_ * nodes_y_);
+            double max_abs = 0;
+            for(size_t ix = 0; ix < nodes_x_; ++ix) {
+                for(size_t iy = 0; iy < nodes_y_; ++iy) {
+                    auto& value = table_[ix * nodes_y_ + iy];
+                    value = function(coordinate_x(static_cast<double>(ix)), coordinate_y(static_cast<double>(iy)));
+                    max_abs = std::max(max_abs, std::fabs(value));
+                }
+            }
+
+            // Probe the interpolation error at the bin centers along each axis
+            double floor = std::max(1e-9 * max_abs, std::numeric_limits<double>::min());
+            auto relative_error = [floor](double interpolated, double exact) {
+                return std::fabs(interpolated - exact) / std::max(std::fabs(exact), floor);
+            };
+
+            double error_x = 0;
+            double error_y = 0;
+            for(size_t ix = 0; ix < nodes_x_; ++ix) {
+                for(size_t iy = 0; iy < nodes_y_; ++iy) {
+                    const auto value = table_[ix * nodes_y_ + iy];
+                    if(ix + 1 < nodes_x_) {
+                        auto exact =
+                            function(coordinate_x(static_cast<double>(ix) + 0.5), coordinate_y(static_cast<double>(iy)));
+                        error_x = std::max(error_x, relative_error(0.5 * (value + table_[(ix + 1) * nodes_y_ + iy]), exact));
+                    }
+                    if(iy + 1 < nodes_y_) {
+                        auto exact =
+                            function(coordinate_x(static_cast<double>(ix)), coordinate_y(static_cast<double>(iy) + 0.5));
+                        error_y = std::max(error_y, relative_error(0.5 * (value + table_[ix * nodes_y_ + iy + 1]), exact));
+                    }
+                }
+            }
+            return {error_x, error_y};
+        }
+
+        TabulationAxis axis_x_;
+        TabulationAxis axis_y_;
+        std::vector<double> table_;
+        size_t nodes_x_{};
+        size_t nodes_y_{};
+        double inv_du_x_{};
+        double inv_du_y_{};
+        double error_{};
+    };
+} // namespace allpix
+
+#endif /* ALLPIX_TABULATED_FUNCTION_H */
@@ -9,11 +9,13 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cfloat>
 #include <chrono>
 #include <climits>
 #include <csignal>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -212,6 +214,14 @@ int main(int argc, char** argv) {
         const auto allow_decay = config.get<bool>("allow_coplanar_interpolation", false);
         const auto radius_step = config.get<double>("radius_step", 0.5);
         const auto volume_cut = config.get<double>("volume_cut", 10e-9);
+        const auto reuse_elements = config.get<bool>("reuse_elements", false);
+        const size_t element_cache_size = 8;
+
+        // Number of grid columns along x and y processed together by one task
+        const auto tile_size = config.get<unsigned int>("tile_size", 4);
+        if(tile_size == 0) {
+            throw allpix::InvalidValueError(config, "tile_size", "tile size must be larger than zero");
+        }
 
         // Swapping elements
         auto rot = config.getArray<std::string>("xyz", {"x", "y", "z"});
@@ -353,124 +363,176 @@ int main(int argc, char** argv) {
         unibn::Octree<Point> octree;
         octree.initialize(points);
 
-        unsigned int mesh_points_done = 0;
-        auto mesh_section = [&](double x, double y) {
-            Log::setReportingLevel(log_level);
+        // Coordinates of the new mesh points along each axis
+        auto grid_coordinates = [](double min, double step, unsigned int bins) {
+            std::vector<double> coordinates;
+            coordinates.reserve(bins);
+            double coordinate = min + step / 2.0;
+            for(unsigned int i = 0; i < bins; ++i) {
+                coordinates.push_back(coordinate);
+                coordinate += step;
+            }
+            return coordinates;
+        };
+        const auto xs = grid_coordinates(minx, xstep, divisions.x());
+        const auto ys = grid_coordinates(miny, ystep, divisions.y());
+        const auto zs = grid_coordinates(minz, zstep, divisions.z());
 
-            // New mesh slice
-            std::vector<Point> new_mesh;
+        // The output data is filled directly in the layout of the field file, with the z index running fastest
+        FieldQuantity quantity = (vector_field ? FieldQuantity::VECTOR : FieldQuantity::SCALAR);
+        const size_t components = (quantity == FieldQuantity::VECTOR ? 3 : 1);
+        auto data = std::make_shared<std::vector<double>>(static_cast<size_t>(mesh_points_total) * components);
+        auto store_point = [&](size_t index, const Point& point) {
+            auto* value = &(*data)[index * components];
+            if(quantity == FieldQuantity::VECTOR) {
+                // We need to convert to framework-internal units:
+                value[0] = Units::get(point.x, units);
+                value[1] = Units::get(point.y, units);
+                value[2] = Units::get(point.z, units);
+            } else {
+                // For a scalar field, we need to store only one value, but which one depends on the field rotation.
+                // We need the original x-position, as that is the only filled one in the parsed field
+                if(rot.at(1) == "-x" || rot.at(1) == "x") {
+                    value[0] = Units::get(point.y, units);
+                } else if(rot.at(2) == "-x" || rot.at(2) == "x") {
+                    value[0] = Units::get(point.z, units);
+                } else {
+                    value[0] = Units::get(point.x, units);
+                }
+            }
+        };
 
-            double z = minz + zstep / 2.0;
-            for(unsigned int k = 0; k < divisions.z(); ++k) {
-                // New mesh vertex and field
-                auto q = (dimension == 2 ? Point(y, z) : Point(x, y, z));
-                Point e;
+        // Search the closest enclosing mesh element of a point and interpolate the observable
+        auto interpolate_point = [&](const Point& q, std::deque<BarycentricElement>& elements) {
+            bool allow_zero_volume = false;
+            size_t prev_neighbours = 0;
+            double radius = initial_radius;
+
+            while(radius <= max_radius) {
+                LOG(DEBUG) << "Search radius: " << radius;
+                // Calling octree neighbours search and sorting the results list with the closest neighbours first
+                std::vector<unsigned int> results;
+                octree.radiusNeighbors<unibn::L2Distance<Point>>(q, radius, results);
+                LOG(DEBUG) << "Number of vertices found: " << results.size();
+
+                if(radius == initial_radius && results.size() > 100) {
+                    LOG(WARNING) << "Found " << results.size() << " mesh vertices within initial search radius of "
+                                 << initial_radius << "um." << std::endl
+                                 << "This might indicate that the output mesh granularity is too low and field features "
+                                    "might be missed."
+                                 << std::endl
+                                 << "Consider increasing output mesh granularity.";
+                }
 
-                // No interpolation requested, return nearest neighbor:
-                if(!interpolate) {
-                    auto idx = static_cast<size_t>(octree.findNeighbor<unibn::L2Distance<Point>>(q));
-                    new_mesh.push_back(field.at(idx));
-                    z += zstep;
+                // If after a radius step no new neighbours are found, go to the next radius step
+                if(results.size() <= prev_neighbours || results.empty()) {
+                    prev_neighbours = results.size();
+                    LOG(DEBUG) << "No (new) neighbour found with radius " << radius << ". Increasing search radius.";
+                    radius = radius + radius_step;
                     continue;
                 }
 
-                bool valid = false;
-                bool allow_zero_volume = false;
-                size_t prev_neighbours = 0;
-                double radius = initial_radius;
-
-                while(radius <= max_radius) {
-                    LOG(DEBUG) << "Search radius: " << radius;
-                    // Calling octree neighbours search and sorting the results list with the closest neighbours first
-                    std::vector<unsigned int> results;
-                    octree.radiusNeighbors<unibn::L2Distance<Point>>(q, radius, results);
-                    LOG(DEBUG) << "Number of vertices found: " << results.size();
-
-                    if(radius == initial_radius && results.size() > 100) {
-                        LOG(WARNING) << "Found " << results.size() << " mesh vertices within initial search radius of "
-                                     << initial_radius << "um." << std::endl
-                                     << "This might indicate that the output mesh granularity is too low and field features "
-                                        "might be missed."
-                                     << std::endl
-                                     << "Consider increasing output mesh granularity.";
-                    }
+                // If we have less than N close neighbors, no full mesh element can be formed. Increase radius.
+                if(results.size() < (dimension == 3 ? 4 : 3)) {
+                    LOG(DEBUG) << "Incomplete mesh element found for radius " << radius << ", increasing radius";
+                    radius = radius + radius_step;
+                    continue;
+                }
 
-                    // If after a radius step no new neighbours are found, go to the next radius step
-                    if(results.size() <= prev_neighbours || results.empty()) {
-                        prev_neighbours = results.size();
-                        LOG(DEBUG) << "No (new) neighbour found with radius " << radius << ". Increasing search radius.";
-                        radius = radius + radius_step;
-                        continue;
-                    }
+                // If we have too many neighbors, we could decay to using lower-dimension interpolation:
+                if(allow_decay && radius > initial_radius && results.size() > 100) {
+                    LOG_ONCE(WARNING) << "Large number of neighbors found, this hints to a quasi-co"
+                                      << (dimension == 3 ? "planar" : "linear") << " situation" << std::endl
+                                      << "Decaying to interpolation in " << (dimension == 3 ? "planar" : "linear")
+                                      << " space for affected points";
+                    allow_zero_volume = true;
+                }
 
-                    // If we have less than N close neighbors, no full mesh element can be formed. Increase radius.
-                    if(results.size() < (dimension == 3 ? 4 : 3)) {
-                        LOG(DEBUG) << "Incomplete mesh element found for radius " << radius << ", increasing radius";
-                        radius = radius + radius_step;
-                        continue;
+                // Sort by lowest distance first, this drastically reduces the number of permutations required to find a
+                // valid mesh element and also ensures that this is the one with the smallest volume.
+                std::sort(results.begin(), results.end(), [&](unsigned int a, unsigned int b) {
+                    return unibn::L2Distance<Point>::compute(points[a], q) < unibn::L2Distance<Point>::compute(points[b], q);
+                });
+
+                // Finding tetrahedrons by checking all combinations of N elements, starting with closest to reference point
+                auto res = for_each_combination(results.begin(),
+                                                results.begin() + (dimension == 3 ? 4 : 3),
+                                                results.end(),
+                                                Combination(&points, &field, q, allow_zero_volume ? 0 : volume_cut));
+                if(res.valid()) {
+                    // Keep the element to try it first for the following points
+                    if(reuse_elements && !allow_zero_volume) {
+                        elements.emplace_front(dimension, res.vertices(), res.field());
+                        if(elements.size() > element_cache_size) {
+                            elements.pop_back();
+                        }
                     }
+                    return res.result();
+                }
 
-                    // If we have too many neighbors, we could decay to using lower-dimension interpolation:
-                    if(allow_decay && radius > initial_radius && results.size() > 100) {
-                        LOG_ONCE(WARNING) << "Large number of neighbors found, this hints to a quasi-co"
-                                          << (dimension == 3 ? "planar" : "linear") << " situation" << std::endl
-                                          << "Decaying to interpolation in " << (dimension == 3 ? "planar" : "linear")
-                                          << " space for affected points";
-                        allow_zero_volume = true;
-                    }
+                radius = radius + radius_step;
+                LOG(DEBUG) << "All combinations tried. Increasing search radius to " << radius;
+            }
 
-                    // Sort by lowest distance first, this drastically reduces the number of permutations required to find a
-                    // valid mesh element and also ensures that this is the one with the smallest volume.
-                    std::sort(results.begin(), results.end(), [&](unsigned int a, unsigned int b) {
-                        return unibn::L2Distance<Point>::compute(points[a], q) <
-                               unibn::L2Distance<Point>::compute(points[b], q);
-                    });
-
-                    // Finding tetrahedrons by checking all combinations of N elements, starting with closest to reference
-                    // point
-                    auto res = for_each_combination(results.begin(),
-                                                    results.begin() + (dimension == 3 ? 4 : 3),
-                                                    results.end(),
-                                                    Combination(&points, &field, q, allow_zero_volume ? 0 : volume_cut));
-                    valid = res.valid();
-                    if(valid) {
-                        e = res.result();
-                        break;
-                    }
+            if(!allow_failed_interpolation) {
+                throw std::runtime_error(
+                    "Could not find valid volume element. Consider to increase max_radius to include "
+                    "more mesh points in the search or to allow failed interpolation with allow_failure "
+                    "to set the element to zero.");
+            }
 
-                    radius = radius + radius_step;
-                    LOG(DEBUG) << "All combinations tried. Increasing search radius to " << radius;
-                }
+            LOG(DEBUG) << "Failed to interpolate, setting element to zero";
+            return Point();
+        };
 
-                if(!valid) {
-                    if(!allow_failed_interpolation) {
-                        throw std::runtime_error(
-                            "Could not find valid volume element. Consider to increase max_radius to include "
-                            "more mesh points in the search or to allow failed interpolation with allow_failure "
-                            "to set the element to zero.");
+        std::atomic<unsigned int> mesh_points_done{0};
+        auto mesh_tile = [&](unsigned int i_begin, unsigned int j_begin) {
+            Log::setReportingLevel(log_level);
+
+            // Elements found for the latest points of this tile, most recent first
+            std::deque<BarycentricElement> elements;
+
+            auto i_end = std::min(i_begin + tile_size, divisions.x());
+            auto j_end = std::min(j_begin + tile_size, divisions.y());
+            for(unsigned int i = i_begin; i < i_end; ++i) {
+                for(unsigned int j = j_begin; j < j_end; ++j) {
+                    for(unsigned int k = 0; k < divisions.z(); ++k) {
+                        // New mesh vertex and field
+                        auto q = (dimension == 2 ? Point(ys[j], zs[k]) : Point(xs[i], ys[j], zs[k]));
+                        Point e;
+
+                        if(!interpolate) {
+                            // No interpolation requested, return nearest neighbor:
+                            auto idx = static_cast<size_t>(octree.findNeighbor<unibn::L2Distance<Point>>(q));
+                            e = field.at(idx);
+                        } else {
+                            // Try the elements of the previous points before searching for a new one
+                            auto element = std::find_if(elements.begin(), elements.end(), [&](const auto& candidate) {
+                                return candidate.interpolate(q, e) && e.isFinite();
+                            });
+                            if(element == elements.end()) {
+                                e = interpolate_point(q, elements);
+                            } else {
+                                LOG(DEBUG) << "Reusing mesh element of previous point at " << q;
+                            }
+                        }
+
+                        LOG(DEBUG) << "Values of data point (" << i << ", " << j << ", " << k << "): " << e;
+                        store_point((static_cast<size_t>(i) * divisions.y() + j) * divisions.z() + k, e);
                     }
 
-                    LOG(DEBUG) << "Failed to interpolate, setting element to zero";
-                    e = {};
+                    mesh_points_done += divisions.z();
+                    LOG_PROGRESS(STATUS, "m")
+                        << (interpolate ? "Interpolating" : "Generating") << " new mesh: " << mesh_points_done << " of "
+                        << mesh_points_total << ", " << (mesh_points_done / (mesh_points_total / 100)) << "%";
                 }
-
-                new_mesh.push_back(e);
-                z += zstep;
             }
-
-            mesh_points_done += divisions.z();
-            LOG_PROGRESS(STATUS, "m") << (interpolate ? "Interpolating" : "Generating") << " new mesh: " << mesh_points_done
-                                      << " of " << mesh_points_total << ", "
-                                      << (mesh_points_done / (mesh_points_total / 100)) << "%";
-
-            return new_mesh;
         };
 
         // Start the interpolation on many threads:
         auto num_threads = config.get<unsigned int>("workers", std::max(std::thread::hardware_concurrency(), 1u));
         ThreadPool::registerThreadCount(num_threads);
         LOG(STATUS) << "Starting regular grid interpolation with " << num_threads << " threads.";
-        std::vector<Point> e_field_new_mesh;
 
         // clang-format off
         auto init_function = [log_level = Log::getReportingLevel(), log_format = Log::getFormat()]() {
@@ -481,23 +543,17 @@ int main(int argc, char** argv) {
         };
 
         ThreadPool pool(num_threads, num_threads * 1024, init_function);
-        std::vector<std::shared_future<std::vector<Point>>> mesh_futures;
-        // Set starting point
-        double x = minx + xstep / 2.0;
-        // Loop over x coordinate, add tasks for each coordinate to the queue
-        for(unsigned int i = 0; i < divisions.x(); ++i) {
-            double y = miny + ystep / 2.0;
-            for(unsigned int j = 0; j < divisions.y(); ++j) {
-                mesh_futures.push_back(pool.submit(mesh_section, x, y));
-                y += ystep;
+        std::vector<std::shared_future<void>> mesh_futures;
+        // Add tasks for each tile of the x-y plane to the queue
+        for(unsigned int i = 0; i < divisions.x(); i += tile_size) {
+            for(unsigned int j = 0; j < divisions.y(); j += tile_size) {
+                mesh_futures.push_back(pool.submit(mesh_tile, i, j));
             }
-            x += xstep;
         }
 
-        // Merge the result vectors:
+        // Wait for all tiles to be completed
         for(auto& mesh_future : mesh_futures) {
-            auto mesh_slice = mesh_future.get();
-            e_field_new_mesh.insert(e_field_new_mesh.end(), mesh_slice.begin(), mesh_slice.end());
+            mesh_future.get();
         }
         pool.destroy();
 
@@ -513,36 +569,6 @@ int main(int argc, char** argv) {
         std::array<size_t, 3> gridsize{
             {static_cast<size_t>(divisions.x()), static_cast<size_t>(divisions.y()), static_cast<size_t>(divisions.z())}};
 
-        FieldQuantity quantity = (vector_field ? FieldQuantity::VECTOR : FieldQuantity::SCALAR);
-        // Prepare data:
-        LOG(INFO) << "Preparing data for storage...";
-        auto data = std::make_shared<std::vector<double>>();
-        for(unsigned int i = 0; i < divisions.x(); ++i) {
-            for(unsigned int j = 0; j < divisions.y(); ++j) {
-                for(unsigned int k = 0; k < divisions.z(); ++k) {
-                    auto& point = e_field_new_mesh[i * divisions.y() * divisions.z() + j * divisions.z() + k];
-                    LOG(DEBUG) << "Values of data point (" << i << ", " << j << ", " << k << "): " << point;
-                    // For a vector field, we push three values:
-                    if(quantity == FieldQuantity::VECTOR) {
-                        // We need to convert to framework-internal units:
-                        data->push_back(Units::get(point.x, units));
-                        data->push_back(Units::get(point.y, units));
-                        data->push_back(Units::get(point.z, units));
-                    } else {
-                        // For a scalar field, we need to push only one value, but which one depends on the field rotation.
-                        // We need the original x-position, as that is the only filled one in the parsed field
-                        if(rot.at(1) == "-x" || rot.at(1) == "x") {
-                            data->push_back(Units::get(point.y, units));
-                        } else if(rot.at(2) == "-x" || rot.at(2) == "x") {
-                            data->push_back(Units::get(point.z, units));
-                        } else {
-                            data->push_back(Units::get(point.x, units));
-                        }
-                    }
-                }
-            }
-        }
-
         allpix::FieldData<double> field_data(header, gridsize, size, data);
         std::string init_file_name = init_file_prefix + "_" + observable + (file_type == FileType::INIT ? ".init" : ".apf");
 
@@ -132,3 +132,46 @@ std::string MeshElement::print(Point& qp) const {
     stream << "Volume: " << volume_;
     return stream.str();
 }
+
+BarycentricElement::BarycentricElement(size_t dimension,
+                                       const std::array<Point, 4>& vertices,
+                                       const std::array<Point, 4>& field)
+    : dimension_(dimension), field_(field) {
+    // Columns hold the homogeneous vertex coordinates, for 2D elements the fourth column maps onto itself
+    Eigen::Matrix4d element_matrix = Eigen::Matrix4d::Identity();
+    for(size_t index = 0; index < dimension_ + 1; index++) {
+        auto column = static_cast<Eigen::Index>(index);
+        element_matrix(0, column) = 1;
+        if(dimension_ == 3) {
+            element_matrix(1, column) = vertices[index].x;
+            element_matrix(2, column) = vertices[index].y;
+            element_matrix(3, column) = vertices[index].z;
+        } else {
+            element_matrix(1, column) = vertices[index].y;
+            element_matrix(2, column) = vertices[index].z;
+        }
+    }
+    inverse_ = element_matrix.inverse();
+}
+
+bool BarycentricElement::interpolate(const Point& qp, Point& result) const {
+    Eigen::Vector4d position = (dimension_ == 3 ? Eigen::Vector4d(1, qp.x, qp.y, qp.z) : Eigen::Vector4d(1, qp.y, qp.z, 0));
+    Eigen::Vector4d weights = inverse_ * position;
+
+    // Barycentric coordinates are the sub volumes relative to the element volume and all positive inside the element. Allow
+    // for rounding errors of the precomputed inverse for points on the element faces
+    for(size_t index = 0; index < dimension_ + 1; index++) {
+        if(weights(static_cast<Eigen::Index>(index)) < -1e-12) {
+            return false;
+        }
+    }
+
+    result = Point();
+    for(size_t index = 0; index < dimension_ + 1; index++) {
+        auto weight = weights(static_cast<Eigen::Index>(index));
+        result.x += weight * field_[index].x;
+        result.y += weight * field_[index].y;
+        result.z += weight * field_[index].z;
+    }
+    return true;
+}
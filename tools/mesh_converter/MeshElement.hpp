@@ -178,6 +178,49 @@ namespace mesh_converter {
          * @return Interpolated result from valid mesh element
          */
         const Point& result() const { return result_; }
+
+        /**
+         * @brief Member to retrieve the vertices of the valid mesh element
+         * @return Mesh points of the element
+         */
+        const std::array<Point, 4>& vertices() const { return grid_elements; }
+
+        /**
+         * @brief Member to retrieve the field at the vertices of the valid mesh element
+         * @return Field values at the mesh points of the element
+         */
+        const std::array<Point, 4>& field() const { return field_elements; }
+    };
+
+    /**
+     * @brief Mesh element with precomputed barycentric transformation
+     *
+     * The inverse of the vertex matrix is calculated once, such that testing whether a point is enclosed and interpolating
+     * at this point only requires a single matrix-vector product. This allows to reuse elements for neighboring points of
+     * the output grid.
+     */
+    class BarycentricElement {
+    public:
+        /**
+         * @brief Constructor from the vertices of a valid mesh element
+         * @param dimension Dimension of the element
+         * @param vertices Mesh points of the element
+         * @param field Field values at the mesh points
+         */
+        BarycentricElement(size_t dimension, const std::array<Point, 4>& vertices, const std::array<Point, 4>& field);
+
+        /**
+         * @brief Interpolate the field at a point if it is enclosed by the element
+         * @param qp Point where the interpolation is being done
+         * @param result Interpolated field, only set if the point is enclosed
+         * @return True if the point is enclosed by the element, false otherwise
+         */
+        bool interpolate(const Point& qp, Point& result) const;
+
+    private:
+        size_t dimension_{3};
+        Eigen::Matrix4d inverse_;
+        std::array<Point, 4> field_{};
     };
 
 } // namespace mesh_converter
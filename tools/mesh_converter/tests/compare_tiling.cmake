@@ -0,0 +1,38 @@
+# SPDX-FileCopyrightText: 2023 CERN and the Allpix Squared authors
+# SPDX-License-Identifier: MIT
+
+# Convert a mesh once column by column and once in tiles, and require identical output files
+#
+# Expected variables:
+# MESH_CONVERTER: path to the mesh_converter executable
+# MESH: file prefix of the Silvaco grid (.grd) and data (.dat) files
+# DIVISIONS: divisions of the output grid
+# OUTPUT_DIR: directory for configuration and output files
+
+FOREACH(tile_size 1 3)
+    SET(prefix "${OUTPUT_DIR}/tile_${tile_size}")
+    FILE(
+        WRITE "${prefix}.conf"
+        "parser = \"silvaco\"\n"
+        "model = \"init\"\n"
+        "region = \"Silicon\"\n"
+        "observable = \"ElectricField\"\n"
+        "observable_units = \"V/cm\"\n"
+        "divisions = ${DIVISIONS}\n"
+        "allow_failure = true\n"
+        "workers = 2\n"
+        "tile_size = ${tile_size}\n")
+    EXECUTE_PROCESS(
+        COMMAND ${MESH_CONVERTER} -f ${MESH} -c ${prefix}.conf -o ${prefix}
+        RESULT_VARIABLE result
+        OUTPUT_QUIET)
+    IF(NOT result EQUAL 0)
+        MESSAGE(FATAL_ERROR "Conversion with tile size ${tile_size} failed")
+    ENDIF()
+ENDFOREACH()
+
+EXECUTE_PROCESS(COMMAND ${CMAKE_COMMAND} -E compare_files "${OUTPUT_DIR}/tile_1_ElectricField.init"
+                        "${OUTPUT_DIR}/tile_3_ElectricField.init" RESULT_VARIABLE result)
+IF(NOT result EQUAL 0)
+    MESSAGE(FATAL_ERROR "Tiled conversion differs from the conversion column by column")
+ENDIF()